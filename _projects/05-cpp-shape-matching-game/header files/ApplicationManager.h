@@ -11,10 +11,17 @@ private:
     Grid* pGrid;
     Operation* pOperation;
     bool gameRunning;
+    bool autoMatch;          // Match the selected shape after every transform
+
+    // Redraw state, only damaged regions are redrawn once the screen is valid
+    bool displayValid;
+    bool partialRedraw;
+    bool statusDirty;        // A status message was drawn since the last update
+    int shownScore, shownLives, shownLevel;
 
 public:
-    // Constructor
-    ApplicationManager();
+    // Constructor, the GUI draws through the given backend
+    ApplicationManager(RenderBackend* backend);
 
     // Destructor
     ~ApplicationManager();
@@ -29,6 +36,9 @@ public:
     // Game operations
     void ExecuteOperation(ToolbarItem item);
     void UpdateDisplay();
+    void InvalidateDisplay() { displayValid = false; }
+    void SetPartialRedraw(bool enabled) { partialRedraw = enabled; }
+    void SetAutoMatch(bool enabled) { autoMatch = enabled; }
     void HandleKeyPress(char key);
     void HandleMouseClick(Point p);
 
@@ -39,6 +49,7 @@ public:
 
 private:
     Operation* CreateOperation(ToolbarItem item);
+    void DrawScreen(const BoundingBox& region);
 };
 
 #endif
@@ -0,0 +1,37 @@
+#ifndef CMU_BACKEND_H
+#define CMU_BACKEND_H
+
+#include "RenderBackend.h"
+
+// Backend that draws into a CMU Graphics window
+class CMUBackend : public RenderBackend {
+private:
+    window* pWind;
+
+public:
+    // Constructor
+    CMUBackend(int width, int height);
+
+    // Destructor
+    virtual ~CMUBackend();
+
+    // Drawing state
+    virtual void SetPen(color c, int width) override;
+    virtual void SetBrush(color c) override;
+
+    // Primitives
+    virtual void DrawRectangle(int x1, int y1, int x2, int y2, DrawingMode mode) override;
+    virtual void DrawCircle(int x, int y, int radius, DrawingMode mode) override;
+    virtual void DrawTriangle(int x1, int y1, int x2, int y2, int x3, int y3, DrawingMode mode) override;
+    virtual void DrawString(int x, int y, const string& text, color c) override;
+
+    // Clipping, not supported by the window
+    virtual bool SetClip(const BoundingBox& box) override;
+    virtual void ResetClip() override;
+
+    // Input
+    virtual bool GetMouseClick(int& x, int& y) override;
+    virtual bool GetKeyPress(char& key) override;
+};
+
+#endif
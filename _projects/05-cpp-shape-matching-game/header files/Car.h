@@ -2,8 +2,6 @@
 #define CAR_H
 
 #include "CompositeShape.h"
-#include "Rectangle.h"
-#include "Circle.h"
 
 // Car shape: Rectangle body with circle wheels
 // Composite of 3 different basic shapes
@@ -14,13 +12,6 @@ public:
 
     // Destructor
     virtual ~Car();
-
-    // Override functions
-    virtual Shape* Clone() const override;
-    virtual int GetShapeType() const override { return 13; } // Car type = 13
-
-private:
-    void CreateSubShapes();
 };
 
 #endif
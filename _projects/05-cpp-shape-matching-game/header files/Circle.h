@@ -17,23 +17,35 @@ public:
 
     // Override virtual functions from Shape
     virtual void Draw(GUI* pGUI) const override;
-    virtual void Rotate() override; // Circle rotation doesn't change appearance
-    virtual void ResizeUp() override;
-    virtual void ResizeDown() override;
-    virtual void Flip() override; // Circle flip doesn't change appearance
     virtual bool Match(const Shape* other) const override;
     virtual Shape* Clone() const override;
+    virtual BoundingBox GetBounds() const override;
+    virtual bool IsPointInside(Point p) const override;
     virtual int GetShapeType() const override { return 1; } // Circle type = 1
 
+    // Geometry placed by a parent's transform, for parts of a composite.
+    // Drawing this way leaves the pen and brush colors to the caller
+    void Draw(GUI* pGUI, const Transform& parent) const;
+    BoundingBox GetBounds(const Transform& parent) const;
+    bool IsPointInside(const Transform& parent, Point p) const;
+
     // Save and load functions
     virtual void Save(ofstream& outFile) const override;
     virtual void Load(ifstream& inFile) override;
 
+protected:
+    virtual uint64_t ComputeSignature() const override;
+
+public:
     // Getters
     int GetRadius() const { return radius; }
 
     // Setters
-    void SetRadius(int r) { radius = r; }
+    void SetRadius(int r) { radius = r; UpdateSignature(); }
+
+private:
+    // Helper function to calculate the drawn center and radius
+    void CalculateCircle(const Transform& parent, Point& center, int& r) const;
 };
 
 #endif
@@ -0,0 +1,64 @@
+#ifndef COMMAND_BUFFER_H
+#define COMMAND_BUFFER_H
+
+#include "Graphics.h"
+#include <vector>
+#include <cstdint>
+
+// Retained list of primitives with the pen and brush each is drawn with.
+// Every command gets a layer above all earlier commands it overlaps, so
+// sorting by layer and then by state draws the same pixels as the
+// recorded order with fewer state changes.
+class CommandBuffer {
+public:
+    enum CommandType {
+        CMD_RECTANGLE,
+        CMD_CIRCLE,
+        CMD_TRIANGLE
+    };
+
+    // One recorded primitive
+    struct Command {
+        CommandType type;
+        Point p1, p2, p3;      // Corners, or the center of a circle in p1
+        int radius;
+        DrawingMode mode;
+        color pen, brush;
+        uint32_t penKey, brushKey;
+        BoundingBox bounds;    // Pixels the primitive can touch, outline included
+        int layer;
+        int order;             // Position in recording order
+    };
+
+private:
+    std::vector<Command> commands;
+    std::vector<int> cellLayers;  // Next free layer of each cell
+    int columns, rows;
+    int penWidth;
+
+    void Add(Command& command);
+
+public:
+    // Cell size of the overlap grid used to assign layers
+    static const int CELL_SIZE = 32;
+
+    // Constructor, layers are tracked over a window of the given size
+    CommandBuffer(int width, int height, int penWidth);
+
+    // Recording
+    void Clear();
+    void AddRectangle(Point p1, Point p2, DrawingMode mode, color pen, color brush);
+    void AddCircle(Point center, int radius, DrawingMode mode, color pen, color brush);
+    void AddTriangle(Point p1, Point p2, Point p3, DrawingMode mode, color pen, color brush);
+    void Finish();
+
+    // Access
+    const std::vector<Command>& GetCommands() const { return commands; }
+    int GetCommandCount() const { return (int)commands.size(); }
+    int GetLayerCount() const;
+
+    // Compare colors byte by byte, the color type has no operator== in either build
+    static uint32_t ColorKey(const color& c);
+};
+
+#endif
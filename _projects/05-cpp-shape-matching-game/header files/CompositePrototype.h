@@ -0,0 +1,47 @@
+#ifndef COMPOSITE_PROTOTYPE_H
+#define COMPOSITE_PROTOTYPE_H
+
+#include "Primitive.h"
+#include <vector>
+
+// Definition of one kind of composite shape: its type, default fill and the
+// basic shapes it is made of, at offsets from the reference point. The
+// prototypes are built once from a table in CompositePrototype.cpp and
+// never change, and every composite of a type shares its prototype, so a
+// new kind of composite only needs a row in that table.
+class CompositePrototype {
+public:
+    // Most parts any prototype has (Robot)
+    static const int MAX_PARTS = 5;
+
+private:
+    int shapeType;
+    ShapeColor defaultFill;
+    Primitive parts[MAX_PARTS];
+    int partCount;
+    uint64_t signature;
+
+    // Registry in table order, built on first use
+    static const std::vector<CompositePrototype>& Registry();
+
+public:
+    // Constructor, the registry fills in the parts
+    CompositePrototype(int type, ShapeColor fill);
+
+    // Registry lookup. Find returns null for a type without a prototype
+    static const CompositePrototype* Find(int shapeType);
+    static const CompositePrototype* Get(int index) { return &Registry()[index]; }
+    static int GetCount() { return (int)Registry().size(); }
+
+    // Getters
+    int GetShapeType() const { return shapeType; }
+    ShapeColor GetDefaultFill() const { return defaultFill; }
+    int GetPartCount() const { return partCount; }
+    const Primitive& GetPart(int index) const { return parts[index]; }
+    uint64_t GetSignature() const { return signature; }
+
+private:
+    void AddPart(const Primitive& part);
+};
+
+#endif
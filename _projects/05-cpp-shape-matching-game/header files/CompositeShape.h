@@ -2,41 +2,46 @@
 #define COMPOSITE_SHAPE_H
 
 #include "Shape.h"
-#include <vector>
+#include "CompositePrototype.h"
 
-// Base class for all composite shapes
+// A composite shape is its prototype, shared by every composite of the
+// same type, plus its own transform and colors. The prototype's parts are
+// offsets from the reference point, and the transform places them when
+// drawn, so rotating or resizing never touches them
 class CompositeShape : public Shape {
 protected:
-    std::vector<Shape*> subShapes;
+    const CompositePrototype* prototype;
 
 public:
-    // Constructor
-    CompositeShape(Point ref = Point(0, 0), ShapeColor fill = RED, ShapeColor outline = BLACK);
+    // Constructors, the first one uses the prototype's default fill
+    CompositeShape(const CompositePrototype* prototype, Point ref = Point(300, 300));
+    CompositeShape(const CompositePrototype* prototype, Point ref, ShapeColor fill, ShapeColor outline);
 
     // Virtual destructor
     virtual ~CompositeShape();
 
     // Override virtual functions from Shape
     virtual void Draw(GUI* pGUI) const override;
-    virtual void Rotate() override;
-    virtual void ResizeUp() override;
-    virtual void ResizeDown() override;
-    virtual void Flip() override;
     virtual bool Match(const Shape* other) const override;
+    virtual Shape* Clone() const override;
+    virtual int GetShapeType() const override { return prototype->GetShapeType(); }
+    virtual BoundingBox GetBounds() const override;
+    virtual bool IsPointInside(Point p) const override;
 
     // Save and load functions
     virtual void Save(ofstream& outFile) const override;
     virtual void Load(ifstream& inFile) override;
 
-    // Utility functions
-    void AddSubShape(Shape* shape);
-    void ClearSubShapes();
-    void UpdateSubShapeColors();
-    void RecalculateSubShapePositions();
+protected:
+    virtual uint64_t ComputeSignature() const override;
 
+public:
     // Getters
-    int GetSubShapeCount() const { return subShapes.size(); }
-    Shape* GetSubShape(int index) const { return (index >= 0 && index < subShapes.size()) ? subShapes[index] : nullptr; }
+    const CompositePrototype* GetPrototype() const { return prototype; }
+    int GetSubShapeCount() const { return prototype->GetPartCount(); }
+    const Shape* GetSubShape(int index) const {
+        return (index >= 0 && index < prototype->GetPartCount()) ? prototype->GetPart(index).Get() : nullptr;
+    }
 };
 
 #endif
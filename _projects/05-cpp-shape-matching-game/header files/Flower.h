@@ -2,9 +2,6 @@
 #define FLOWER_H
 
 #include "CompositeShape.h"
-#include "Rectangle.h"
-#include "Circle.h"
-#include "Triangle.h"
 
 // Flower shape: Circle center with triangle petals and rectangle stem
 // Composite of 4 basic shapes (3 different types)
@@ -15,13 +12,6 @@ public:
 
     // Destructor
     virtual ~Flower();
-
-    // Override functions
-    virtual Shape* Clone() const override;
-    virtual int GetShapeType() const override { return 14; } // Flower type = 14
-
-private:
-    void CreateSubShapes();
 };
 
 #endif
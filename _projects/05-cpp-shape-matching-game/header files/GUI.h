@@ -1,7 +1,9 @@
 #ifndef GUI_H
 #define GUI_H
 
-#include "CMUgraphics.h"
+#include "RenderBackend.h"
+#include "CommandBuffer.h"
+#include <string>
 
 // Toolbar items enumeration
 enum ToolbarItem {
@@ -42,11 +44,16 @@ enum GameArea {
 
 class GUI {
 private:
-    window* pWind;
+    RenderBackend* pBackend;
+    color penColor;
+
+    // While recording, shape drawing goes into the buffer with this state
+    CommandBuffer* pRecording;
+    color recordPen, recordBrush;
 
 public:
-    // Constructor
-    GUI();
+    // Constructor, the GUI takes ownership of the backend
+    GUI(RenderBackend* backend);
 
     // Destructor
     ~GUI();
@@ -66,9 +73,18 @@ public:
     void DrawTriangle(Point p1, Point p2, Point p3, DrawingMode mode = FRAME) const;
     void DrawString(Point p, string text) const;
 
+    // Command buffers, shape drawing between Begin and EndRecording is recorded
+    void BeginRecording(CommandBuffer* buffer);
+    void EndRecording();
+    void Submit(const CommandBuffer& buffer, const BoundingBox& region);
+
+    // Clipping, false when the backend can't clip
+    bool SetClip(const BoundingBox& box) const;
+    void ResetClip() const;
+
     // Input functions
-    void GetPointClicked(Point& p) const;
-    void GetKeyPressed(char& key) const;
+    bool GetPointClicked(Point& p) const;
+    bool GetKeyPressed(char& key) const;
     ToolbarItem GetUserClick() const;
 
     // Game state display
@@ -83,6 +99,12 @@ public:
     static const int WINDOW_HEIGHT = 700;
     static const int GRID_WIDTH = WINDOW_WIDTH;
     static const int GRID_HEIGHT = WINDOW_HEIGHT - TOOLBAR_HEIGHT - STATUS_HEIGHT;
+    static const int PEN_WIDTH = 2;  // Also how far an outline can reach past a shape's bounds
+
+    // Screen areas, as covered by their background rectangles
+    static BoundingBox WindowArea() { return BoundingBox(0, 0, WINDOW_WIDTH - 1, WINDOW_HEIGHT - 1); }
+    static BoundingBox ToolbarArea() { return BoundingBox(0, 0, WINDOW_WIDTH, TOOLBAR_HEIGHT); }
+    static BoundingBox StatusArea() { return BoundingBox(0, WINDOW_HEIGHT - STATUS_HEIGHT, WINDOW_WIDTH, WINDOW_HEIGHT); }
 };
 
 #endif
@@ -0,0 +1,99 @@
+#ifndef GRAPHICS_H
+#define GRAPHICS_H
+
+// Drawing types shared by the game and the rendering backends.
+// The CMU build takes them from the CMU Graphics library, the headless
+// build defines compatible ones here.
+#ifdef SHAPEHUNT_CMU
+
+#include "CMUgraphics.h"
+
+#else
+
+#include <string>
+
+using namespace std;
+
+// Screen position in pixels
+struct Point {
+    int x, y;
+
+    Point(int px = 0, int py = 0) : x(px), y(py) {}
+};
+
+// RGBA color, alpha 0 is transparent
+struct color {
+    unsigned char ucRed, ucGreen, ucBlue, ucAlpha;
+
+    color(unsigned char r = 0, unsigned char g = 0, unsigned char b = 0, unsigned char a = 255)
+        : ucRed(r), ucGreen(g), ucBlue(b), ucAlpha(a) {}
+};
+
+// Outline only, or filled with the brush and outlined with the pen
+enum DrawingMode {
+    FRAME,
+    FILLED
+};
+
+const color BLACK_COLOR(0, 0, 0);
+const color WHITE_COLOR(255, 255, 255);
+const color RED_COLOR(255, 0, 0);
+const color GREEN_COLOR(0, 128, 0);
+const color BLUE_COLOR(0, 0, 255);
+const color YELLOW_COLOR(255, 255, 0);
+const color ORANGE_COLOR(255, 165, 0);
+const color PURPLE_COLOR(128, 0, 128);
+const color MAGENTA_COLOR(255, 0, 255);
+const color LIGHTBLUE_COLOR(173, 216, 230);
+const color LIGHTGRAY_COLOR(211, 211, 211);
+const color DARKGRAY_COLOR(169, 169, 169);
+const color TRANSPARENT_COLOR(0, 0, 0, 0);
+
+#endif
+
+// Pixel rectangle with inclusive corners, empty when left > right
+struct BoundingBox {
+    int left, top, right, bottom;
+
+    BoundingBox() : left(0), top(0), right(-1), bottom(-1) {}
+    BoundingBox(int l, int t, int r, int b) : left(l), top(t), right(r), bottom(b) {}
+
+    bool IsEmpty() const { return left > right || top > bottom; }
+    bool Contains(Point p) const { return p.x >= left && p.x <= right && p.y >= top && p.y <= bottom; }
+    bool Intersects(const BoundingBox& other) const {
+        return !IsEmpty() && !other.IsEmpty() &&
+               left <= other.right && other.left <= right &&
+               top <= other.bottom && other.top <= bottom;
+    }
+    bool operator==(const BoundingBox& other) const {
+        return left == other.left && top == other.top && right == other.right && bottom == other.bottom;
+    }
+    bool operator!=(const BoundingBox& other) const { return !(*this == other); }
+
+    // Grow to cover another box
+    void Include(const BoundingBox& other) {
+        if(other.IsEmpty()) return;
+        if(IsEmpty()) {
+            *this = other;
+            return;
+        }
+        if(other.left < left) left = other.left;
+        if(other.top < top) top = other.top;
+        if(other.right > right) right = other.right;
+        if(other.bottom > bottom) bottom = other.bottom;
+    }
+
+    // Part of this box inside another
+    BoundingBox Clipped(const BoundingBox& other) const {
+        return BoundingBox(left > other.left ? left : other.left, top > other.top ? top : other.top,
+                           right < other.right ? right : other.right, bottom < other.bottom ? bottom : other.bottom);
+    }
+
+    // Box grown by margin pixels on every side
+    BoundingBox Padded(int margin) const {
+        if(IsEmpty()) return *this;
+        return BoundingBox(left - margin, top - margin, right + margin, bottom + margin);
+    }
+};
+
+#endif
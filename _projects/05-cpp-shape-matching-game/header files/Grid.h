@@ -3,10 +3,29 @@
 
 #include "Shape.h"
 #include "GUI.h"
+#include "SpatialHash.h"
+#include "ShapePool.h"
 #include <vector>
+#include <unordered_map>
 
 class Grid {
 private:
+    // What a shape looked like the last time damage was collected
+    struct DrawnShape {
+        const Shape* shape;
+        int type, rotations, resizes;
+        bool flipped;
+        ShapeColor fill, outline;
+        BoundingBox bounds;
+    };
+
+    // A random shape filed under its signature
+    struct Target {
+        Shape* shape;
+        long long rank;
+    };
+
+    ShapePool pool;                      // Storage for the random shapes
     std::vector<Shape*> randomShapes;    // Random shapes for the current level
     std::vector<Shape*> playerShapes;    // Shapes created by player
     Shape* selectedShape;                // Currently selected shape
@@ -15,6 +34,15 @@ private:
     int lives;
     int targetMatches;                   // Number of matches needed to advance
     int currentMatches;                  // Current matches made
+    std::vector<DrawnShape> drawnShapes; // Shapes as of the last CollectDamage
+    BoundingBox drawnHighlight;          // Selection box as of the last CollectDamage
+    mutable CommandBuffer commands;      // Shapes and highlight as recorded for drawing
+    mutable bool commandsStale;          // Set when anything drawn has changed
+    bool useCommands;
+    SpatialHash index;                   // Shapes by the cells their bounds cover
+    long long nextRank;                  // Pick order of the next shape added
+    bool useIndex;
+    std::unordered_map<uint64_t, std::vector<Target> > targets; // Random shapes by signature in grid order, emptied lists are kept
 
 public:
     // Constructor
@@ -30,20 +58,27 @@ public:
     void ClearRandomShapes();
     void ClearPlayerShapes();
     void ClearAllShapes();
+    void UpdateShape(Shape* shape);      // Call after transforming a shape
 
     // Game operations
     void GenerateRandomShapes();
     void SetLevel(int level);
     bool CheckMatch(Shape* playerShape);
+    Shape* FindMatch(const Shape* shape) const;
     void RefreshLevel();
 
     // Selection and interaction
     Shape* GetShapeAt(Point p);
+    void SetSpatialIndex(bool enabled) { useIndex = enabled; }
     void SetSelectedShape(Shape* shape);
     Shape* GetSelectedShape() const { return selectedShape; }
 
     // Drawing
     void Draw(GUI* pGUI) const;
+    void Draw(GUI* pGUI, const BoundingBox& region) const;
+    void CollectDamage(std::vector<BoundingBox>& damage);
+    void SetCommandBuffer(bool enabled) { useCommands = enabled; }
+    const CommandBuffer& GetCommands() const { return commands; }
 
     // Game state
     int GetScore() const { return score; }
@@ -61,8 +96,19 @@ public:
     void ApplyBlackFill(); // For level 3+
 
 private:
+    // Random shapes rank after every player shape, so picks keep preferring them
+    static const long long RANDOM_RANK = 1LL << 40;
+    static const int INDEX_CELL_SIZE = 32;
+
     void CalculateTargetMatches();
+    long long RemoveTarget(const Shape* shape);
+    void FileTarget(Shape* shape, long long rank);
+    void RefileTarget(Shape* shape);
+    DrawnShape Snapshot(const Shape* shape) const;
+    void DrawShapes(GUI* pGUI, const BoundingBox& region) const;
+    BoundingBox HighlightBounds() const;
     Shape* CreateRandomCompositeShape();
+    void DestroyShape(Shape* shape);
 };
 
 #endif
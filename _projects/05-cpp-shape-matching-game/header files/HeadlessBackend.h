@@ -0,0 +1,67 @@
+#ifndef HEADLESS_BACKEND_H
+#define HEADLESS_BACKEND_H
+
+#include "RenderBackend.h"
+#include "Rasterizer.h"
+#include <vector>
+#include <deque>
+#include <cstdint>
+
+// Backend that rasterizes into an in-memory RGBA framebuffer.
+// Input comes from queued clicks and key presses.
+class HeadlessBackend : public RenderBackend {
+private:
+    int width, height;
+    std::vector<uint32_t> pixels;  // One RGBA pixel per word, red in the low byte
+    Rasterizer rasterizer;
+    uint32_t penPixel;
+    int penWidth;
+    uint32_t brushPixel;
+    std::deque<Point> clicks;
+    std::deque<char> keys;
+    long long primitiveCount;
+    long long stateChangeCount;
+
+    bool PenVisible() const { return (penPixel >> 24) != 0; }
+
+public:
+    // Constructor
+    HeadlessBackend(int width, int height);
+
+    // Drawing state
+    virtual void SetPen(color c, int width) override;
+    virtual void SetBrush(color c) override;
+
+    // Primitives
+    virtual void DrawRectangle(int x1, int y1, int x2, int y2, DrawingMode mode) override;
+    virtual void DrawCircle(int x, int y, int radius, DrawingMode mode) override;
+    virtual void DrawTriangle(int x1, int y1, int x2, int y2, int x3, int y3, DrawingMode mode) override;
+    virtual void DrawString(int x, int y, const string& text, color c) override;
+
+    // Clipping
+    virtual bool SetClip(const BoundingBox& box) override;
+    virtual void ResetClip() override;
+
+    // Input
+    virtual bool GetMouseClick(int& x, int& y) override;
+    virtual bool GetKeyPress(char& key) override;
+    void PushClick(Point p) { clicks.push_back(p); }
+    void PushKey(char key) { keys.push_back(key); }
+
+    // Framebuffer access
+    int GetWidth() const { return width; }
+    int GetHeight() const { return height; }
+    const uint32_t* GetPixels() const { return pixels.data(); }
+    uint32_t GetPixel(int x, int y) const { return pixels[(size_t)y * width + x]; }
+    long long GetPrimitiveCount() const { return primitiveCount; }
+    long long GetStateChangeCount() const { return stateChangeCount; }
+    Rasterizer& GetRasterizer() { return rasterizer; }
+    void Clear(color c);
+    uint64_t Checksum() const;
+    bool SavePPM(const string& filename) const;
+
+    // Pack a color into a framebuffer pixel
+    static uint32_t PackColor(color c);
+};
+
+#endif
@@ -2,8 +2,6 @@
 #define HOME_H
 
 #include "CompositeShape.h"
-#include "Rectangle.h"
-#include "Triangle.h"
 
 // Home shape: Rectangle base with triangle roof
 // Composite of 2 different basic shapes
@@ -14,13 +12,6 @@ public:
 
     // Destructor
     virtual ~Home();
-
-    // Override functions
-    virtual Shape* Clone() const override;
-    virtual int GetShapeType() const override { return 11; } // Home type = 11
-
-private:
-    void CreateSubShapes();
 };
 
 #endif
@@ -2,8 +2,6 @@
 #define PERSON_H
 
 #include "CompositeShape.h"
-#include "Rectangle.h"
-#include "Circle.h"
 
 // Person shape: Circle head with rectangle body and legs
 // Composite of 3 different basic shapes
@@ -14,13 +12,6 @@ public:
 
     // Destructor
     virtual ~Person();
-
-    // Override functions
-    virtual Shape* Clone() const override;
-    virtual int GetShapeType() const override { return 12; } // Person type = 12
-
-private:
-    void CreateSubShapes();
 };
 
 #endif
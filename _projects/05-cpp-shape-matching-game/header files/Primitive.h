@@ -0,0 +1,61 @@
+#ifndef PRIMITIVE_H
+#define PRIMITIVE_H
+
+#include "Rectangle.h"
+#include "Circle.h"
+#include "Triangle.h"
+
+// A rectangle, circle or triangle stored by value. The tag says which one
+// is held, and every operation switches on it and calls the concrete shape
+// directly instead of going through a Shape pointer.
+class Primitive {
+public:
+    // Tags, equal to the GetShapeType of the stored shape
+    enum Type {
+        EMPTY = -1,
+        RECTANGLE = 0,
+        CIRCLE = 1,
+        TRIANGLE = 2
+    };
+
+private:
+    Type type;
+    union {
+        Rectangle rectangle;
+        Circle circle;
+        Triangle triangle;
+    };
+
+    void Reset();
+    void Assign(const Primitive& other);
+
+public:
+    // Constructors, a primitive starts out empty
+    Primitive();
+    Primitive(const Primitive& other);
+    Primitive& operator=(const Primitive& other);
+
+    // Destructor
+    ~Primitive();
+
+    // Store a copy of a shape, replacing what was held
+    void Set(const Rectangle& shape);
+    void Set(const Circle& shape);
+    void Set(const Triangle& shape);
+
+    // Access
+    Type GetType() const { return type; }
+    bool IsEmpty() const { return type == EMPTY; }
+    Shape* Get();
+    const Shape* Get() const;
+
+    // Shape operations, an empty primitive does nothing and matches nothing.
+    // The held shape is placed by the transform of the shape that owns it,
+    // and drawn in the colors the owner has set
+    void Draw(GUI* pGUI, const Transform& parent) const;
+    bool Match(const Primitive& other) const;
+    BoundingBox GetBounds(const Transform& parent) const;
+    bool IsPointInside(const Transform& parent, Point p) const;
+};
+
+#endif
@@ -0,0 +1,69 @@
+#ifndef RASTERIZER_H
+#define RASTERIZER_H
+
+#include <vector>
+#include <cstdint>
+
+// Span-based software rasterizer over a 32-bit framebuffer.
+// Pixels with alpha 0 are never written. Everything is clipped to the clip
+// rectangle, which is the whole buffer unless set.
+class Rasterizer {
+private:
+    uint32_t* pixels;
+    int width, height;
+    int clipLeft, clipTop, clipRight, clipBottom;
+    bool useSIMD;
+    bool hasAVX2;
+    std::vector<std::vector<int> > spanTables;  // Half width of each row, per radius
+    std::vector<int> lineEnter, lineLeave;      // Columns a line enters and leaves each row at
+
+    // Span of a thick line in each visible row, row top + i covers left[i]..right[i]
+    struct LineSpans {
+        int top, bottom;
+        std::vector<int> left, right;
+    };
+    LineSpans edgeSpans[3];                     // Triangle edge opposite each vertex
+
+    static int HalfWidth(int radius, int dy);
+    const int* SpanTable(int radius);
+    void VisibleRows(int y, int radius, int& first, int& last) const;
+    void TraceCentre(int x1, int y1, int x2, int y2);
+    void LineRowSpan(int y, int penWidth, int firstRow, int lastRow, int& left, int& right) const;
+    void TraceLine(int x1, int y1, int x2, int y2, int penWidth, LineSpans& spans);
+    void StoreLine(const LineSpans& spans, uint32_t pixel);
+    void FillTriangleSpans(int x1, int y1, int x2, int y2, int x3, int y3, uint32_t pixel,
+                           const LineSpans* outline);
+    void StoreSpan(uint32_t* begin, uint32_t* end, uint32_t pixel) const;
+    void FillSpanAVX2(uint32_t* begin, uint32_t* end, uint32_t pixel) const;
+
+public:
+    // Largest radius whose span table is kept
+    static const int MAX_CACHED_RADIUS = 2048;
+    // Shorter spans are stored one pixel at a time
+    static const int MIN_VECTOR_SPAN = 8;
+
+    // Constructor, the framebuffer stays owned by the caller
+    Rasterizer(uint32_t* pixels, int width, int height);
+
+    // Primitives
+    void FillSpan(int y, int x1, int x2, uint32_t pixel);
+    void FillBox(int x1, int y1, int x2, int y2, uint32_t pixel);
+    void FillCircle(int x, int y, int radius, uint32_t pixel);
+    void FillRing(int x, int y, int outer, int inner, uint32_t pixel);
+    void FillTriangle(int x1, int y1, int x2, int y2, int x3, int y3, uint32_t pixel);
+    void DrawLine(int x1, int y1, int x2, int y2, int penWidth, uint32_t pixel);
+    // Filled triangle with its three edges drawn as lines over it. The fill
+    // leaves out the pixels the edges cover
+    void DrawTriangle(int x1, int y1, int x2, int y2, int x3, int y3, int penWidth,
+                      uint32_t pen, uint32_t fill);
+
+    // Clip rectangle, inclusive and limited to the buffer
+    void SetClip(int x1, int y1, int x2, int y2);
+    void ResetClip();
+
+    // Vector paths can be turned off to compare against the scalar ones
+    void SetSIMD(bool enabled) { useSIMD = enabled; }
+    bool UsesAVX2() const { return useSIMD && hasAVX2; }
+};
+
+#endif
@@ -17,25 +17,37 @@ public:
 
     // Override virtual functions from Shape
     virtual void Draw(GUI* pGUI) const override;
-    virtual void Rotate() override;
-    virtual void ResizeUp() override;
-    virtual void ResizeDown() override;
-    virtual void Flip() override;
     virtual bool Match(const Shape* other) const override;
     virtual Shape* Clone() const override;
+    virtual BoundingBox GetBounds() const override;
+    virtual bool IsPointInside(Point p) const override;
     virtual int GetShapeType() const override { return 0; } // Rectangle type = 0
 
+    // Geometry placed by a parent's transform, for parts of a composite.
+    // Drawing this way leaves the pen and brush colors to the caller
+    void Draw(GUI* pGUI, const Transform& parent) const;
+    BoundingBox GetBounds(const Transform& parent) const;
+    bool IsPointInside(const Transform& parent, Point p) const;
+
     // Save and load functions
     virtual void Save(ofstream& outFile) const override;
     virtual void Load(ifstream& inFile) override;
 
+protected:
+    virtual uint64_t ComputeSignature() const override;
+
+public:
     // Getters
     int GetWidth() const { return width; }
     int GetHeight() const { return height; }
 
     // Setters
-    void SetWidth(int w) { width = w; }
-    void SetHeight(int h) { height = h; }
+    void SetWidth(int w) { width = w; UpdateSignature(); }
+    void SetHeight(int h) { height = h; UpdateSignature(); }
+
+private:
+    // Helper function to calculate the drawn corners
+    void CalculateCorners(const Transform& parent, Point& topLeft, Point& bottomRight) const;
 };
 
 #endif
@@ -0,0 +1,32 @@
+#ifndef RENDER_BACKEND_H
+#define RENDER_BACKEND_H
+
+#include "Graphics.h"
+#include <string>
+
+// Interface between the GUI and whatever draws the pixels
+class RenderBackend {
+public:
+    // Virtual destructor
+    virtual ~RenderBackend() {}
+
+    // Drawing state
+    virtual void SetPen(color c, int width) = 0;
+    virtual void SetBrush(color c) = 0;
+
+    // Primitives, coordinates are window pixels
+    virtual void DrawRectangle(int x1, int y1, int x2, int y2, DrawingMode mode) = 0;
+    virtual void DrawCircle(int x, int y, int radius, DrawingMode mode) = 0;
+    virtual void DrawTriangle(int x1, int y1, int x2, int y2, int x3, int y3, DrawingMode mode) = 0;
+    virtual void DrawString(int x, int y, const string& text, color c) = 0;
+
+    // Limit drawing to a box, false when the backend can only draw to the whole window
+    virtual bool SetClip(const BoundingBox& box) = 0;
+    virtual void ResetClip() = 0;
+
+    // Input, returns false when nothing is waiting
+    virtual bool GetMouseClick(int& x, int& y) = 0;
+    virtual bool GetKeyPress(char& key) = 0;
+};
+
+#endif
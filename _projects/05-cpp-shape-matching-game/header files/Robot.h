@@ -2,9 +2,6 @@
 #define ROBOT_H
 
 #include "CompositeShape.h"
-#include "Rectangle.h"
-#include "Circle.h"
-#include "Triangle.h"
 
 // Robot shape: Rectangle body, circle head, rectangle arms, triangle antenna
 // Composite of 4 basic shapes (3 different types)
@@ -15,13 +12,6 @@ public:
 
     // Destructor
     virtual ~Robot();
-
-    // Override functions
-    virtual Shape* Clone() const override;
-    virtual int GetShapeType() const override { return 15; } // Robot type = 15
-
-private:
-    void CreateSubShapes();
 };
 
 #endif
@@ -1,9 +1,13 @@
 #ifndef SHAPE_H
 #define SHAPE_H
 
-#include "CMUgraphics.h"
+#include "Graphics.h"
+#include "Transform.h"
 #include <iostream>
 #include <fstream>
+#include <cstdint>
+
+class GUI;
 
 // Color constants
 enum ShapeColor {
@@ -19,13 +23,39 @@ enum ShapeColor {
 
 // Base class for all shapes
 class Shape {
+private:
+    // Where the spatial index and the grid's target table have filed this
+    // shape, so neither needs a lookup table of its own. A copy starts out
+    // unfiled, so a clone is never taken for the shape it was made from
+    struct Filing {
+        int indexPosition;      // In the index's shape list, -1 when not indexed
+        long long indexRank;
+        BoundingBox indexCells;
+        bool targeted;
+        uint64_t targetKey;     // Signature it is filed under as a target
+
+        Filing() : indexPosition(-1), indexRank(0), targeted(false), targetKey(0) {}
+        Filing(const Filing&) : Filing() {}
+        Filing& operator=(const Filing&) { return *this; }
+    };
+    mutable Filing filing;
+    friend class SpatialHash;
+    friend class Grid;
+
 protected:
-    Point refPoint;        // Reference point for the shape
+    Transform transform;   // Reference point, orientation and scale in the parent
     ShapeColor fillColor;  // Fill color
     ShapeColor outlineColor; // Outline color
-    int rotationCount;     // Number of 90-degree rotations
-    int resizeCount;       // Number of resize operations (positive = up, negative = down)
-    bool isFlipped;        // Vertical flip status
+    uint64_t signature;    // Equal for shapes that Match, see ComputeSignature
+
+    // Hash of everything Match compares, kept current by the functions that
+    // change it. Derived constructors call UpdateSignature once built
+    virtual uint64_t ComputeSignature() const = 0;
+    void UpdateSignature() { signature = ComputeSignature(); }
+
+    // Map a point given relative to a center of this shape: orient it about
+    // the center, then place it with the parent's transform
+    Point PlacePoint(const Transform& parent, Point center, Point offset) const;
 
 public:
     // Constructor
@@ -34,36 +64,41 @@ public:
     // Virtual destructor
     virtual ~Shape();
 
+    // Transforms, each composes into the shape's transform in constant time
+    virtual void Rotate();
+    virtual void ResizeUp();
+    virtual void ResizeDown();
+    virtual void Flip();
+
     // Pure virtual functions - must be implemented by derived classes
     virtual void Draw(GUI* pGUI) const = 0;
-    virtual void Rotate() = 0;
-    virtual void ResizeUp() = 0;
-    virtual void ResizeDown() = 0;
-    virtual void Flip() = 0;
     virtual bool Match(const Shape* other) const = 0;
     virtual Shape* Clone() const = 0;
     virtual int GetShapeType() const = 0;
+    virtual BoundingBox GetBounds() const = 0; // Box around the geometry, the pen can reach a little past it
 
     // Save and load functions
     virtual void Save(ofstream& outFile) const;
     virtual void Load(ifstream& inFile);
 
     // Getters and setters
-    Point GetRefPoint() const { return refPoint; }
-    void SetRefPoint(Point p) { refPoint = p; }
+    Point GetRefPoint() const { return transform.origin; }
+    void SetRefPoint(Point p) { transform.origin = p; }
+    const Transform& GetTransform() const { return transform; }
     ShapeColor GetFillColor() const { return fillColor; }
-    void SetFillColor(ShapeColor color) { fillColor = color; }
+    void SetFillColor(ShapeColor color) { fillColor = color; UpdateSignature(); }
     ShapeColor GetOutlineColor() const { return outlineColor; }
-    void SetOutlineColor(ShapeColor color) { outlineColor = color; }
-    int GetRotationCount() const { return rotationCount; }
-    int GetResizeCount() const { return resizeCount; }
-    bool GetFlipStatus() const { return isFlipped; }
+    void SetOutlineColor(ShapeColor color) { outlineColor = color; UpdateSignature(); }
+    int GetRotationCount() const { return transform.GetQuarterTurns(); }
+    int GetResizeCount() const { return transform.scale; }
+    bool GetFlipStatus() const { return transform.IsMirrored(); }
+    uint64_t GetSignature() const { return signature; }
 
     // Utility functions
     color GetColorValue(ShapeColor c) const;
-    Point RotatePoint(Point p, Point center, int rotations) const;
     void Move(int dx, int dy);
-    bool IsPointInside(Point p) const;
+    virtual bool IsPointInside(Point p) const;
+    static uint64_t MixSignature(uint64_t seed, uint64_t value);
 };
 
 #endif
@@ -0,0 +1,43 @@
+#ifndef SHAPE_POOL_H
+#define SHAPE_POOL_H
+
+#include "CompositeShape.h"
+#include <vector>
+#include <type_traits>
+
+// Storage for composite shapes in blocks of fixed-size slots. A composite
+// only holds its prototype, transform and colors, so any of them fits a
+// slot. Freed slots are reused and blocks are only returned when the pool
+// is destroyed, so a level can be regenerated without allocating.
+class ShapePool {
+public:
+    static const int SLOTS_PER_BLOCK = 64;
+
+private:
+    typedef std::aligned_storage<sizeof(CompositeShape), alignof(CompositeShape)>::type Slot;
+
+    std::vector<Slot*> blocks;
+    std::vector<Slot*> freeSlots;
+
+    // Not copyable, shapes live in the blocks
+    ShapePool(const ShapePool&);
+    ShapePool& operator=(const ShapePool&);
+
+public:
+    // Constructor
+    ShapePool() {}
+
+    // Destructor, every shape must have been released
+    ~ShapePool();
+
+    // Memory for one composite, construct it with placement new
+    void* Allocate();
+
+    // Destroy a shape from this pool and free its slot
+    void Release(Shape* shape);
+
+    // Whether a shape lives in this pool
+    bool Owns(const Shape* shape) const;
+};
+
+#endif
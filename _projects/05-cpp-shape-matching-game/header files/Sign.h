@@ -2,7 +2,6 @@
 #define SIGN_H
 
 #include "CompositeShape.h"
-#include "Rectangle.h"
 
 // Sign shape: Two rectangles forming a plus sign
 // Composite of 2 basic shapes (rectangles)
@@ -13,13 +12,6 @@ public:
 
     // Destructor
     virtual ~Sign();
-
-    // Override functions
-    virtual Shape* Clone() const override;
-    virtual int GetShapeType() const override { return 10; } // Sign type = 10
-
-private:
-    void CreateSubShapes();
 };
 
 #endif
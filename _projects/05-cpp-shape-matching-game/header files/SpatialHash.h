@@ -0,0 +1,52 @@
+#ifndef SPATIAL_HASH_H
+#define SPATIAL_HASH_H
+
+#include "Shape.h"
+#include <vector>
+
+// Uniform grid of cells over the window. Each cell lists the shapes whose
+// bounding boxes reach into it, ordered by rank, so a point lookup only
+// has to test the shapes of one cell. A shape keeps the cells and rank it
+// was placed with, and every table keeps its capacity when emptied, so
+// refilling the index allocates nothing once it has held as many shapes.
+class SpatialHash {
+public:
+    // A shape stored in a cell, lower ranks are preferred by the caller
+    struct Entry {
+        Shape* shape;
+        long long rank;
+    };
+
+private:
+    // Room each cell starts with, more than a level puts in most cells
+    static const int CELL_RESERVE = 4;
+
+    int width, height, cellSize;
+    int columns, rows;
+    std::vector<std::vector<Entry> > cells;
+    std::vector<const Shape*> shapes;   // Every indexed shape, each keeps its position and cells
+
+    bool Holds(const Shape* shape) const;
+    BoundingBox CellRange(const Shape* shape) const;
+    void Place(Shape* shape, long long rank);
+    void Unplace(const Shape* shape);
+
+public:
+    // Constructor
+    SpatialHash(int width, int height, int cellSize);
+
+    // Shape management, Update must be called after a shape is transformed
+    void Insert(Shape* shape, long long rank);
+    void Remove(const Shape* shape);
+    void Update(Shape* shape);
+    void Clear();
+
+    // Lookup, only points inside the window are indexed
+    bool Covers(Point p) const { return p.x >= 0 && p.y >= 0 && p.x < width && p.y < height; }
+    const std::vector<Entry>& Candidates(Point p) const {
+        return cells[(size_t)(p.y / cellSize) * columns + p.x / cellSize];
+    }
+    int GetShapeCount() const { return (int)shapes.size(); }
+};
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef TRANSFORM_H
+#define TRANSFORM_H
+
+#include "Graphics.h"
+
+// Placement of a shape in its parent: a translation, an orientation from
+// the dihedral group D4 and a power-of-two scale. The orientation is a
+// vertical mirror, when bit 2 is set, followed by the quarter turns
+// clockwise in bits 0-1. Every operation composes in constant time and
+// points are mapped through lookup tables, so there is no trigonometry.
+struct Transform {
+    static const int MIRROR = 4;
+    static const int MIN_SCALE = -2;    // A quarter of the original size
+    static const int MAX_SCALE = 4;     // Sixteen times the original size
+
+    Point origin;                       // Where the local origin lands in the parent
+    unsigned char orientation;
+    signed char scale;
+
+    // Constructor, the identity at a point
+    Transform(Point o = Point(0, 0)) : origin(o), orientation(0), scale(0) {}
+
+    // Operations, about the origin and in the parent's frame. Resizing stops
+    // at the scale limits and returns false there
+    void Rotate();
+    void Flip();
+    bool ResizeUp();
+    bool ResizeDown();
+
+    // Mapping from local to parent coordinates
+    Point Orient(Point v) const;        // Orientation only
+    int ScaleLength(int length) const;  // Scale only
+    Point Apply(Point local) const;     // Scale, orient, then translate
+
+    // Getters
+    int GetQuarterTurns() const { return orientation & 3; }
+    bool IsMirrored() const { return (orientation & MIRROR) != 0; }
+};
+
+#endif
@@ -4,12 +4,51 @@
 
 using namespace std;
 
+// Above this many separate regions they are merged into one
+static const int MAX_DAMAGE_REGIONS = 8;
+
+// Clip damage to the window and merge overlapping boxes
+static void MergeDamage(vector<BoundingBox>& damage) {
+    vector<BoundingBox> merged;
+    for(const BoundingBox& box : damage) {
+        BoundingBox clipped = box.Clipped(GUI::WindowArea());
+        if(!clipped.IsEmpty()) merged.push_back(clipped);
+    }
+
+    bool changed = true;
+    while(changed) {
+        changed = false;
+        for(size_t i = 0; i < merged.size() && !changed; i++) {
+            for(size_t j = i + 1; j < merged.size(); j++) {
+                if(merged[i].Intersects(merged[j])) {
+                    merged[i].Include(merged[j]);
+                    merged.erase(merged.begin() + j);
+                    changed = true;
+                    break;
+                }
+            }
+        }
+    }
+
+    if((int)merged.size() > MAX_DAMAGE_REGIONS) {
+        BoundingBox all;
+        for(const BoundingBox& box : merged) all.Include(box);
+        merged.assign(1, all);
+    }
+    damage.swap(merged);
+}
+
 // Constructor
-ApplicationManager::ApplicationManager() {
-    pGUI = new GUI();
+ApplicationManager::ApplicationManager(RenderBackend* backend) {
+    pGUI = new GUI(backend);
     pGrid = new Grid();
     pOperation = nullptr;
     gameRunning = true;
+    autoMatch = true;
+    displayValid = false;
+    partialRedraw = true;
+    statusDirty = false;
+    shownScore = shownLives = shownLevel = -1;
 }
 
 // Destructor
@@ -31,22 +70,9 @@ void ApplicationManager::Run() {
             UpdateDisplay();
         }
 
-        // Handle spacebar for matching
         char key;
         if(pGUI->GetKeyPressed(key)) {
-            if(key == ' ') {
-                // Space bar pressed - check for match
-                Shape* selected = pGrid->GetSelectedShape();
-                if(selected) {
-                    bool matched = pGrid->CheckMatch(selected);
-                    if(matched) {
-                        pGUI->UpdateStatusBar("Shape matched successfully! +2 points");
-                    } else {
-                        pGUI->UpdateStatusBar("No match found. -1 point");
-                    }
-                    UpdateDisplay();
-                }
-            }
+            HandleKeyPress(key);
         }
     }
 }
@@ -79,25 +105,83 @@ void ApplicationManager::ExecuteOperation(ToolbarItem item) {
             default: message += "Unknown operation"; break;
         }
         pGUI->UpdateStatusBar(message);
+        statusDirty = true;
+
+        // A transform that makes the selected shape match a target scores at once
+        bool transform = item == ITM_ROTATE || item == ITM_RESIZE_UP ||
+                         item == ITM_RESIZE_DOWN || item == ITM_FLIP;
+        Shape* selected = pGrid->GetSelectedShape();
+        if(autoMatch && transform && pGrid->FindMatch(selected)) {
+            pGrid->CheckMatch(selected);
+            pGUI->UpdateStatusBar("Shape matched successfully! +2 points");
+        }
     }
 }
 
-// Update display
+// Update display. The first frame is drawn in full, after that only the
+// regions where shapes or the status bar changed are redrawn
 void ApplicationManager::UpdateDisplay() {
+    vector<BoundingBox> damage;
+    pGrid->CollectDamage(damage);
+    if(statusDirty || shownScore != pGrid->GetScore() ||
+       shownLives != pGrid->GetLives() || shownLevel != pGrid->GetLevel()) {
+        damage.push_back(GUI::StatusArea());
+    }
+    statusDirty = false;
+    shownScore = pGrid->GetScore();
+    shownLives = pGrid->GetLives();
+    shownLevel = pGrid->GetLevel();
+
+    if(!displayValid || !partialRedraw) {
+        DrawScreen(GUI::WindowArea());
+        displayValid = true;
+        return;
+    }
+
+    MergeDamage(damage);
+    for(const BoundingBox& region : damage) {
+        if(!pGUI->SetClip(region)) {
+            DrawScreen(GUI::WindowArea());
+            return;
+        }
+        DrawScreen(region);
+    }
+    pGUI->ResetClip();
+}
+
+// Draw everything that reaches into a region, in full-screen order.
+// The caller clips to the region
+void ApplicationManager::DrawScreen(const BoundingBox& region) {
     pGUI->ClearGridArea();
-    pGUI->DrawToolbar();
-    pGUI->DrawStatusBar();
-    pGrid->Draw(pGUI);
+    if(region.Intersects(GUI::ToolbarArea())) pGUI->DrawToolbar();
+    bool status = region.Intersects(GUI::StatusArea());
+    if(status) pGUI->DrawStatusBar();
+    pGrid->Draw(pGUI, region);
 
     // Display game status
-    pGUI->DisplayScore(pGrid->GetScore());
-    pGUI->DisplayLives(pGrid->GetLives());
-    pGUI->DisplayLevel(pGrid->GetLevel());
+    if(status) {
+        pGUI->DisplayScore(pGrid->GetScore());
+        pGUI->DisplayLives(pGrid->GetLives());
+        pGUI->DisplayLevel(pGrid->GetLevel());
+    }
 }
 
 // Handle key press
 void ApplicationManager::HandleKeyPress(char key) {
-    // Implementation can be expanded for more key handling
+    if(key == ' ') {
+        // Space bar pressed - check for match
+        Shape* selected = pGrid->GetSelectedShape();
+        if(selected) {
+            bool matched = pGrid->CheckMatch(selected);
+            if(matched) {
+                pGUI->UpdateStatusBar("Shape matched successfully! +2 points");
+            } else {
+                pGUI->UpdateStatusBar("No match found. -1 point");
+            }
+            statusDirty = true;
+            UpdateDisplay();
+        }
+    }
 }
 
 // Handle mouse click
@@ -0,0 +1,58 @@
+#include "CMUBackend.h"
+
+// Constructor
+CMUBackend::CMUBackend(int width, int height) {
+    pWind = CreateWind(width, height, 0, 0);
+    pWind->SetPen(BLACK_COLOR, 2);
+    pWind->SetBrush(WHITE_COLOR);
+}
+
+// Destructor
+CMUBackend::~CMUBackend() {
+    delete pWind;
+}
+
+// Set pen color and width
+void CMUBackend::SetPen(color c, int width) {
+    pWind->SetPen(c, width);
+}
+
+// Set brush color
+void CMUBackend::SetBrush(color c) {
+    pWind->SetBrush(c);
+}
+
+// Drawing functions
+void CMUBackend::DrawRectangle(int x1, int y1, int x2, int y2, DrawingMode mode) {
+    pWind->DrawRectangle(x1, y1, x2, y2, mode);
+}
+
+void CMUBackend::DrawCircle(int x, int y, int radius, DrawingMode mode) {
+    pWind->DrawCircle(x, y, radius, mode);
+}
+
+void CMUBackend::DrawTriangle(int x1, int y1, int x2, int y2, int x3, int y3, DrawingMode mode) {
+    pWind->DrawTriangle(x1, y1, x2, y2, x3, y3, mode);
+}
+
+void CMUBackend::DrawString(int x, int y, const string& text, color c) {
+    pWind->DrawString(x, y, text, c);
+}
+
+// The window has no clip rectangle, callers redraw everything instead
+bool CMUBackend::SetClip(const BoundingBox&) {
+    return false;
+}
+
+void CMUBackend::ResetClip() {
+}
+
+// Poll for a mouse click
+bool CMUBackend::GetMouseClick(int& x, int& y) {
+    return pWind->GetMouseClick(x, y) != NO_CLICK;
+}
+
+// Poll for a key press
+bool CMUBackend::GetKeyPress(char& key) {
+    return pWind->GetKeyPress(key) != NO_KEYPRESS;
+}
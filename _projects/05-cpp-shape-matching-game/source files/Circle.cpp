@@ -1,4 +1,5 @@
 #include "Circle.h"
+#include "GUI.h"
 #include <algorithm>
 
 using namespace std;
@@ -6,67 +7,83 @@ using namespace std;
 // Constructor
 Circle::Circle(Point ref, int r, ShapeColor fill, ShapeColor outline)
     : Shape(ref, fill, outline), radius(r) {
+    UpdateSignature();
 }
 
 // Destructor
 Circle::~Circle() {
 }
 
+// Center and radius in the parent's frame
+void Circle::CalculateCircle(const Transform& parent, Point& center, int& r) const {
+    center = parent.Apply(transform.origin);
+    r = parent.ScaleLength(transform.ScaleLength(radius));
+}
+
 // Draw circle
 void Circle::Draw(GUI* pGUI) const {
     pGUI->SetPenColor(GetColorValue(outlineColor));
     pGUI->SetBrushColor(GetColorValue(fillColor));
+    Draw(pGUI, Transform());
+}
 
-    // Calculate circle bounds
-    Point topLeft = Point(refPoint.x - radius, refPoint.y - radius);
-    Point bottomRight = Point(refPoint.x + radius, refPoint.y + radius);
+// Geometry only, the composite sets its own colors first
+void Circle::Draw(GUI* pGUI, const Transform& parent) const {
+    Point center;
+    int r;
+    CalculateCircle(parent, center, r);
 
     // Draw filled circle
-    pGUI->DrawCircle(refPoint, radius, FILLED);
+    pGUI->DrawCircle(center, r, FILLED);
 }
 
-// Rotate circle (no visual effect for circle)
-void Circle::Rotate() {
-    rotationCount = (rotationCount + 1) % 4;
-    // Circle appearance doesn't change with rotation
+// Box around the circle
+BoundingBox Circle::GetBounds() const {
+    return GetBounds(Transform());
 }
 
-// Resize up (double radius)
-void Circle::ResizeUp() {
-    radius *= 2;
-    resizeCount++;
+BoundingBox Circle::GetBounds(const Transform& parent) const {
+    Point center;
+    int r;
+    CalculateCircle(parent, center, r);
+    return BoundingBox(center.x - r, center.y - r, center.x + r, center.y + r);
 }
 
-// Resize down (half radius)
-void Circle::ResizeDown() {
-    radius = max(3, radius / 2); // Minimum radius of 3
-    resizeCount--;
+// Point within the radius of the center
+bool Circle::IsPointInside(Point p) const {
+    return IsPointInside(Transform(), p);
 }
 
-// Flip circle (no visual effect for circle)
-void Circle::Flip() {
-    isFlipped = !isFlipped;
-    // Circle appearance doesn't change with flip
+bool Circle::IsPointInside(const Transform& parent, Point p) const {
+    Point center;
+    int r;
+    CalculateCircle(parent, center, r);
+    long long dx = p.x - center.x;
+    long long dy = p.y - center.y;
+    return dx * dx + dy * dy <= (long long)r * r;
 }
 
 // Check if this circle matches another shape
 bool Circle::Match(const Shape* other) const {
-    const Circle* otherCircle = dynamic_cast<const Circle*>(other);
-    if(!otherCircle) return false;
+    if(!other || other->GetShapeType() != GetShapeType()) return false;
+    const Circle* otherCircle = static_cast<const Circle*>(other);
 
     // Match if same radius and colors
-    return radius == otherCircle->radius && 
+    return transform.ScaleLength(radius) == otherCircle->transform.ScaleLength(otherCircle->radius) && 
            fillColor == otherCircle->fillColor && 
            outlineColor == otherCircle->outlineColor;
 }
 
+// Radius and colors
+uint64_t Circle::ComputeSignature() const {
+    uint64_t sig = MixSignature(GetShapeType(), transform.ScaleLength(radius));
+    sig = MixSignature(sig, fillColor);
+    return MixSignature(sig, outlineColor);
+}
+
 // Clone this circle
 Shape* Circle::Clone() const {
-    Circle* clone = new Circle(refPoint, radius, fillColor, outlineColor);
-    clone->rotationCount = rotationCount;
-    clone->resizeCount = resizeCount;
-    clone->isFlipped = isFlipped;
-    return clone;
+    return new Circle(*this);
 }
 
 // Save circle data
@@ -80,4 +97,5 @@ void Circle::Save(ofstream& outFile) const {
 void Circle::Load(ifstream& inFile) {
     Shape::Load(inFile);
     inFile >> radius;
+    UpdateSignature();
 }
@@ -0,0 +1,115 @@
+#include "CommandBuffer.h"
+#include <algorithm>
+#include <cstring>
+
+using namespace std;
+
+static_assert(sizeof(color) <= sizeof(uint32_t), "ColorKey packs a color into 32 bits");
+
+// Constructor
+CommandBuffer::CommandBuffer(int width, int height, int pen)
+    : columns((width + CELL_SIZE - 1) / CELL_SIZE), rows((height + CELL_SIZE - 1) / CELL_SIZE),
+      penWidth(pen) {
+    cellLayers.assign((size_t)columns * rows, 0);
+}
+
+// Pack the bytes of a color into a sortable key
+uint32_t CommandBuffer::ColorKey(const color& c) {
+    uint32_t key = 0;
+    memcpy(&key, &c, sizeof(color));
+    return key;
+}
+
+// Drop all commands
+void CommandBuffer::Clear() {
+    commands.clear();
+    fill(cellLayers.begin(), cellLayers.end(), 0);
+}
+
+// Put a command above everything it overlaps in the cells it touches
+void CommandBuffer::Add(Command& command) {
+    command.penKey = ColorKey(command.pen);
+    command.brushKey = ColorKey(command.brush);
+    command.bounds = command.bounds.Padded(penWidth);
+    command.order = (int)commands.size();
+    command.layer = 0;
+
+    BoundingBox window(0, 0, columns * CELL_SIZE - 1, rows * CELL_SIZE - 1);
+    BoundingBox visible = command.bounds.Clipped(window);
+    if(!visible.IsEmpty()) {
+        int left = visible.left / CELL_SIZE, right = visible.right / CELL_SIZE;
+        int top = visible.top / CELL_SIZE, bottom = visible.bottom / CELL_SIZE;
+        for(int y = top; y <= bottom; y++) {
+            for(int x = left; x <= right; x++) {
+                command.layer = max(command.layer, cellLayers[(size_t)y * columns + x]);
+            }
+        }
+        for(int y = top; y <= bottom; y++) {
+            for(int x = left; x <= right; x++) {
+                cellLayers[(size_t)y * columns + x] = command.layer + 1;
+            }
+        }
+    }
+    commands.push_back(command);
+}
+
+// Recording
+void CommandBuffer::AddRectangle(Point p1, Point p2, DrawingMode mode, color pen, color brush) {
+    Command command;
+    command.type = CMD_RECTANGLE;
+    command.p1 = p1;
+    command.p2 = p2;
+    command.radius = 0;
+    command.mode = mode;
+    command.pen = pen;
+    command.brush = brush;
+    command.bounds = BoundingBox(min(p1.x, p2.x), min(p1.y, p2.y), max(p1.x, p2.x), max(p1.y, p2.y));
+    Add(command);
+}
+
+void CommandBuffer::AddCircle(Point center, int radius, DrawingMode mode, color pen, color brush) {
+    Command command;
+    command.type = CMD_CIRCLE;
+    command.p1 = center;
+    command.radius = radius;
+    command.mode = mode;
+    command.pen = pen;
+    command.brush = brush;
+    command.bounds = BoundingBox(center.x - radius, center.y - radius, center.x + radius, center.y + radius);
+    Add(command);
+}
+
+void CommandBuffer::AddTriangle(Point p1, Point p2, Point p3, DrawingMode mode, color pen, color brush) {
+    Command command;
+    command.type = CMD_TRIANGLE;
+    command.p1 = p1;
+    command.p2 = p2;
+    command.p3 = p3;
+    command.radius = 0;
+    command.mode = mode;
+    command.pen = pen;
+    command.brush = brush;
+    command.bounds = BoundingBox(min(p1.x, min(p2.x, p3.x)), min(p1.y, min(p2.y, p3.y)),
+                                 max(p1.x, max(p2.x, p3.x)), max(p1.y, max(p2.y, p3.y)));
+    Add(command);
+}
+
+// Sort by layer, then pen, then brush. Commands in one layer never overlap,
+// so their order within it doesn't change the result
+void CommandBuffer::Finish() {
+    sort(commands.begin(), commands.end(), [](const Command& a, const Command& b) {
+        if(a.layer != b.layer) return a.layer < b.layer;
+        if(a.penKey != b.penKey) return a.penKey < b.penKey;
+        if(a.brushKey != b.brushKey) return a.brushKey < b.brushKey;
+        return a.order < b.order;
+    });
+}
+
+// Number of layers in use
+int CommandBuffer::GetLayerCount() const {
+    int layers = 0;
+    for(const Command& command : commands) {
+        layers = max(layers, command.layer + 1);
+    }
+    return layers;
+}
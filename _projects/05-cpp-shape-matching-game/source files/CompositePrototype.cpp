@@ -0,0 +1,99 @@
+#include "CompositePrototype.h"
+
+using namespace std;
+
+// One basic shape of a prototype, placed at (x, y) from the composite's
+// reference point and turned clockwise by quarter turns. A rectangle is
+// size by size2, a circle has radius size and a triangle has side size
+struct PartData {
+    int type;
+    int x, y;
+    int size, size2;
+    int quarterTurns;
+};
+
+// One row per kind of composite
+struct PrototypeData {
+    int shapeType;
+    ShapeColor fill;
+    int partCount;
+    PartData parts[CompositePrototype::MAX_PARTS];
+};
+
+static const int R = Primitive::RECTANGLE;
+static const int C = Primitive::CIRCLE;
+static const int T = Primitive::TRIANGLE;
+
+static constexpr PrototypeData PROTOTYPE_TABLE[] = {
+    // Sign: horizontal and vertical rectangles forming a plus
+    {10, YELLOW, 2, {{R, -30, -10, 60, 20, 0}, {R, -10, -30, 20, 60, 0}}},
+    // Home: rectangle base under a triangle roof
+    {11, RED, 2, {{R, -25, -20, 50, 40, 0}, {T, -30, -20, 60, 0, 0}}},
+    // Person: circle head, rectangle body and legs
+    {12, BLUE, 3, {{C, 0, -30, 15, 0, 0}, {R, -10, -10, 20, 30, 0}, {R, -12, 20, 24, 15, 0}}},
+    // Car: rectangle body on two circle wheels
+    {13, GREEN, 3, {{R, -35, -15, 70, 25, 0}, {C, -20, 15, 10, 0, 0}, {C, 20, 15, 10, 0, 0}}},
+    // Flower: rectangle stem, circle center, a top petal and a right petal
+    {14, PURPLE, 4, {{R, -3, 10, 6, 30, 0}, {C, 0, 0, 12, 0, 0}, {T, -8, -20, 16, 0, 0},
+                     {T, 12, -8, 16, 0, 1}}},
+    // Robot: rectangle body, circle head, rectangle arms and a triangle antenna
+    {15, ORANGE, 5, {{R, -15, -10, 30, 35, 0}, {C, 0, -30, 12, 0, 0}, {R, -25, -5, 8, 20, 0},
+                     {R, 17, -5, 8, 20, 0}, {T, -5, -45, 10, 0, 0}}}
+};
+static const int PROTOTYPE_COUNT = sizeof(PROTOTYPE_TABLE) / sizeof(PROTOTYPE_TABLE[0]);
+
+// Constructor
+CompositePrototype::CompositePrototype(int type, ShapeColor fill)
+    : shapeType(type), defaultFill(fill), partCount(0), signature(0) {
+}
+
+// Add a copy of a part, ignored once the array is full
+void CompositePrototype::AddPart(const Primitive& part) {
+    if(partCount < MAX_PARTS) {
+        parts[partCount++] = part;
+    }
+}
+
+// Build every prototype from the table the first time one is asked for
+const vector<CompositePrototype>& CompositePrototype::Registry() {
+    static const vector<CompositePrototype> registry = [] {
+        vector<CompositePrototype> prototypes;
+        prototypes.reserve(PROTOTYPE_COUNT);
+        for(const PrototypeData& data : PROTOTYPE_TABLE) {
+            CompositePrototype prototype(data.shapeType, data.fill);
+            for(int i = 0; i < data.partCount && i < MAX_PARTS; i++) {
+                const PartData& p = data.parts[i];
+                Primitive part;
+                switch(p.type) {
+                    case Primitive::RECTANGLE: part.Set(Rectangle(Point(p.x, p.y), p.size, p.size2, data.fill)); break;
+                    case Primitive::CIRCLE: part.Set(Circle(Point(p.x, p.y), p.size, data.fill)); break;
+                    case Primitive::TRIANGLE: part.Set(Triangle(Point(p.x, p.y), p.size, data.fill)); break;
+                    default: continue;
+                }
+                for(int r = 0; r < p.quarterTurns; r++) {
+                    part.Get()->Rotate();
+                }
+                prototype.AddPart(part);
+            }
+
+            // Type and the part signatures in order
+            prototype.signature = Shape::MixSignature(prototype.shapeType, prototype.partCount);
+            for(int i = 0; i < prototype.partCount; i++) {
+                prototype.signature = Shape::MixSignature(prototype.signature, prototype.parts[i].Get()->GetSignature());
+            }
+            prototypes.push_back(prototype);
+        }
+        return prototypes;
+    }();
+    return registry;
+}
+
+// Prototype of a composite type
+const CompositePrototype* CompositePrototype::Find(int shapeType) {
+    for(const CompositePrototype& prototype : Registry()) {
+        if(prototype.shapeType == shapeType) {
+            return &prototype;
+        }
+    }
+    return nullptr;
+}
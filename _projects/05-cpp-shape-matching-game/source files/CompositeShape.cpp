@@ -1,154 +1,80 @@
 #include "CompositeShape.h"
+#include "GUI.h"
 
 using namespace std;
 
-// Constructor
-CompositeShape::CompositeShape(Point ref, ShapeColor fill, ShapeColor outline)
-    : Shape(ref, fill, outline) {
+// Constructors
+CompositeShape::CompositeShape(const CompositePrototype* proto, Point ref)
+    : Shape(ref, proto->GetDefaultFill(), BLACK), prototype(proto) {
+    UpdateSignature();
+}
+
+CompositeShape::CompositeShape(const CompositePrototype* proto, Point ref, ShapeColor fill, ShapeColor outline)
+    : Shape(ref, fill, outline), prototype(proto) {
+    UpdateSignature();
 }
 
 // Destructor
 CompositeShape::~CompositeShape() {
-    ClearSubShapes();
 }
 
-// Draw all sub-shapes
+// Draw the prototype's parts in this composite's colors, placed by its
+// transform
 void CompositeShape::Draw(GUI* pGUI) const {
-    for(const Shape* shape : subShapes) {
-        if(shape) {
-            shape->Draw(pGUI);
-        }
-    }
-}
-
-// Rotate all sub-shapes and recalculate positions
-void CompositeShape::Rotate() {
-    rotationCount = (rotationCount + 1) % 4;
+    pGUI->SetPenColor(GetColorValue(outlineColor));
+    pGUI->SetBrushColor(GetColorValue(fillColor));
 
-    // Rotate each sub-shape around its own center first
-    for(Shape* shape : subShapes) {
-        if(shape) {
-            shape->Rotate();
-        }
+    for(int i = 0; i < prototype->GetPartCount(); i++) {
+        prototype->GetPart(i).Draw(pGUI, transform);
     }
-
-    // Recalculate relative positions
-    RecalculateSubShapePositions();
 }
 
-// Resize up all sub-shapes
-void CompositeShape::ResizeUp() {
-    resizeCount++;
-
-    for(Shape* shape : subShapes) {
-        if(shape) {
-            shape->ResizeUp();
-        }
+// Box around all parts
+BoundingBox CompositeShape::GetBounds() const {
+    BoundingBox bounds;
+    for(int i = 0; i < prototype->GetPartCount(); i++) {
+        bounds.Include(prototype->GetPart(i).GetBounds(transform));
     }
-
-    RecalculateSubShapePositions();
+    return bounds;
 }
 
-// Resize down all sub-shapes
-void CompositeShape::ResizeDown() {
-    resizeCount--;
-
-    for(Shape* shape : subShapes) {
-        if(shape) {
-            shape->ResizeDown();
-        }
-    }
-
-    RecalculateSubShapePositions();
-}
-
-// Flip all sub-shapes
-void CompositeShape::Flip() {
-    isFlipped = !isFlipped;
-
-    for(Shape* shape : subShapes) {
-        if(shape) {
-            shape->Flip();
+// Point inside any part
+bool CompositeShape::IsPointInside(Point p) const {
+    for(int i = 0; i < prototype->GetPartCount(); i++) {
+        if(prototype->GetPart(i).IsPointInside(transform, p)) {
+            return true;
         }
     }
-
-    RecalculateSubShapePositions();
+    return false;
 }
 
-// Check if this composite shape matches another
+// Composites match when they share a prototype and a size. Colors are only
+// for display, so a black target still matches a colored player shape
 bool CompositeShape::Match(const Shape* other) const {
-    const CompositeShape* otherComposite = dynamic_cast<const CompositeShape*>(other);
-    if(!otherComposite) return false;
+    if(!other || GetShapeType() != other->GetShapeType()) return false;
+    const CompositeShape* otherComposite = static_cast<const CompositeShape*>(other);
 
-    // Must have same number of sub-shapes
-    if(subShapes.size() != otherComposite->subShapes.size()) return false;
-
-    // Must have same shape type
-    if(GetShapeType() != otherComposite->GetShapeType()) return false;
+    return prototype == otherComposite->prototype && transform.scale == otherComposite->transform.scale;
+}
 
-    // Check if all sub-shapes match (order matters)
-    for(size_t i = 0; i < subShapes.size(); i++) {
-        if(!subShapes[i]->Match(otherComposite->subShapes[i])) {
-            return false;
-        }
-    }
+// Prototype signature and the scale. Rotating and flipping leave it as it was
+uint64_t CompositeShape::ComputeSignature() const {
+    return MixSignature(prototype->GetSignature(), transform.scale);
+}
 
-    return true;
+// Clone this composite, sharing its prototype
+Shape* CompositeShape::Clone() const {
+    return new CompositeShape(*this);
 }
 
-// Save composite shape data
+// Save composite shape data, the type names the prototype
 void CompositeShape::Save(ofstream& outFile) const {
     outFile << GetShapeType() << " ";
     Shape::Save(outFile);
-    outFile << subShapes.size() << "\n";
-
-    // Save each sub-shape
-    for(const Shape* shape : subShapes) {
-        if(shape) {
-            shape->Save(outFile);
-        }
-    }
+    outFile << "\n";
 }
 
-// Load composite shape data
+// Load composite shape data, the caller picks the prototype from the type
 void CompositeShape::Load(ifstream& inFile) {
     Shape::Load(inFile);
-
-    int numSubShapes;
-    inFile >> numSubShapes;
-
-    // Note: Sub-shapes should be loaded by the derived class
-    // as it knows which types to create
-}
-
-// Add a sub-shape
-void CompositeShape::AddSubShape(Shape* shape) {
-    if(shape) {
-        subShapes.push_back(shape);
-        UpdateSubShapeColors();
-    }
-}
-
-// Clear all sub-shapes
-void CompositeShape::ClearSubShapes() {
-    for(Shape* shape : subShapes) {
-        delete shape;
-    }
-    subShapes.clear();
-}
-
-// Update all sub-shapes to have the same colors as the composite
-void CompositeShape::UpdateSubShapeColors() {
-    for(Shape* shape : subShapes) {
-        if(shape) {
-            shape->SetFillColor(fillColor);
-            shape->SetOutlineColor(outlineColor);
-        }
-    }
-}
-
-// Recalculate sub-shape positions relative to reference point
-void CompositeShape::RecalculateSubShapePositions() {
-    // This is a virtual method that should be overridden by derived classes
-    // to properly position their sub-shapes relative to the reference point
 }
@@ -2,22 +2,26 @@
 #include <sstream>
 
 // Constructor
-GUI::GUI() {
-    pWind = CreateWind(WINDOW_WIDTH, WINDOW_HEIGHT, 0, 0);
-    pWind->SetPen(BLACK_COLOR, 2);
-    pWind->SetBrush(WHITE_COLOR);
+GUI::GUI(RenderBackend* backend) {
+    pBackend = backend;
+    penColor = BLACK_COLOR;
+    pRecording = nullptr;
+    pBackend->SetPen(penColor, PEN_WIDTH);
+    pBackend->SetBrush(WHITE_COLOR);
 }
 
 // Destructor
 GUI::~GUI() {
-    delete pWind;
+    delete pBackend;
 }
 
 // Draw the toolbar
 void GUI::DrawToolbar() const {
-    // Clear toolbar area
-    pWind->SetBrush(LIGHTGRAY_COLOR);
-    pWind->DrawRectangle(0, 0, WINDOW_WIDTH, TOOLBAR_HEIGHT, FILLED);
+    // Clear toolbar area. Panels are always outlined in black and the
+    // shape pen is put back afterwards
+    pBackend->SetPen(BLACK_COLOR, PEN_WIDTH);
+    pBackend->SetBrush(LIGHTGRAY_COLOR);
+    pBackend->DrawRectangle(0, 0, WINDOW_WIDTH, TOOLBAR_HEIGHT, FILLED);
 
     // Draw toolbar items
     int itemWidth = WINDOW_WIDTH / 18; // 18 items total
@@ -25,149 +29,225 @@ void GUI::DrawToolbar() const {
     int y = 10;
 
     // Shape icons
-    pWind->SetBrush(YELLOW_COLOR);
-    pWind->DrawRectangle(x, y, x + itemWidth - 5, y + TOOLBAR_HEIGHT - 20, FILLED);
-    pWind->DrawString(x + 5, y + 25, "Sign", BLACK_COLOR);
+    pBackend->SetBrush(YELLOW_COLOR);
+    pBackend->DrawRectangle(x, y, x + itemWidth - 5, y + TOOLBAR_HEIGHT - 20, FILLED);
+    pBackend->DrawString(x + 5, y + 25, "Sign", BLACK_COLOR);
     x += itemWidth;
 
-    pWind->SetBrush(RED_COLOR);
-    pWind->DrawRectangle(x, y, x + itemWidth - 5, y + TOOLBAR_HEIGHT - 20, FILLED);
-    pWind->DrawString(x + 5, y + 25, "Home", BLACK_COLOR);
+    pBackend->SetBrush(RED_COLOR);
+    pBackend->DrawRectangle(x, y, x + itemWidth - 5, y + TOOLBAR_HEIGHT - 20, FILLED);
+    pBackend->DrawString(x + 5, y + 25, "Home", BLACK_COLOR);
     x += itemWidth;
 
-    pWind->SetBrush(BLUE_COLOR);
-    pWind->DrawRectangle(x, y, x + itemWidth - 5, y + TOOLBAR_HEIGHT - 20, FILLED);
-    pWind->DrawString(x + 5, y + 25, "Person", BLACK_COLOR);
+    pBackend->SetBrush(BLUE_COLOR);
+    pBackend->DrawRectangle(x, y, x + itemWidth - 5, y + TOOLBAR_HEIGHT - 20, FILLED);
+    pBackend->DrawString(x + 5, y + 25, "Person", BLACK_COLOR);
     x += itemWidth;
 
-    pWind->SetBrush(GREEN_COLOR);
-    pWind->DrawRectangle(x, y, x + itemWidth - 5, y + TOOLBAR_HEIGHT - 20, FILLED);
-    pWind->DrawString(x + 5, y + 25, "Car", BLACK_COLOR);
+    pBackend->SetBrush(GREEN_COLOR);
+    pBackend->DrawRectangle(x, y, x + itemWidth - 5, y + TOOLBAR_HEIGHT - 20, FILLED);
+    pBackend->DrawString(x + 5, y + 25, "Car", BLACK_COLOR);
     x += itemWidth;
 
-    pWind->SetBrush(PURPLE_COLOR);
-    pWind->DrawRectangle(x, y, x + itemWidth - 5, y + TOOLBAR_HEIGHT - 20, FILLED);
-    pWind->DrawString(x + 5, y + 25, "Flower", BLACK_COLOR);
+    pBackend->SetBrush(PURPLE_COLOR);
+    pBackend->DrawRectangle(x, y, x + itemWidth - 5, y + TOOLBAR_HEIGHT - 20, FILLED);
+    pBackend->DrawString(x + 5, y + 25, "Flower", BLACK_COLOR);
     x += itemWidth;
 
-    pWind->SetBrush(ORANGE_COLOR);
-    pWind->DrawRectangle(x, y, x + itemWidth - 5, y + TOOLBAR_HEIGHT - 20, FILLED);
-    pWind->DrawString(x + 5, y + 25, "Robot", BLACK_COLOR);
+    pBackend->SetBrush(ORANGE_COLOR);
+    pBackend->DrawRectangle(x, y, x + itemWidth - 5, y + TOOLBAR_HEIGHT - 20, FILLED);
+    pBackend->DrawString(x + 5, y + 25, "Robot", BLACK_COLOR);
     x += itemWidth;
 
     // Operation icons
-    pWind->SetBrush(LIGHTBLUE_COLOR);
-    pWind->DrawRectangle(x, y, x + itemWidth - 5, y + TOOLBAR_HEIGHT - 20, FILLED);
-    pWind->DrawString(x + 5, y + 25, "Rotate", BLACK_COLOR);
+    pBackend->SetBrush(LIGHTBLUE_COLOR);
+    pBackend->DrawRectangle(x, y, x + itemWidth - 5, y + TOOLBAR_HEIGHT - 20, FILLED);
+    pBackend->DrawString(x + 5, y + 25, "Rotate", BLACK_COLOR);
     x += itemWidth;
 
-    pWind->DrawRectangle(x, y, x + itemWidth - 5, y + TOOLBAR_HEIGHT - 20, FILLED);
-    pWind->DrawString(x + 5, y + 25, "Size+", BLACK_COLOR);
+    pBackend->DrawRectangle(x, y, x + itemWidth - 5, y + TOOLBAR_HEIGHT - 20, FILLED);
+    pBackend->DrawString(x + 5, y + 25, "Size+", BLACK_COLOR);
     x += itemWidth;
 
-    pWind->DrawRectangle(x, y, x + itemWidth - 5, y + TOOLBAR_HEIGHT - 20, FILLED);
-    pWind->DrawString(x + 5, y + 25, "Size-", BLACK_COLOR);
+    pBackend->DrawRectangle(x, y, x + itemWidth - 5, y + TOOLBAR_HEIGHT - 20, FILLED);
+    pBackend->DrawString(x + 5, y + 25, "Size-", BLACK_COLOR);
     x += itemWidth;
 
-    pWind->DrawRectangle(x, y, x + itemWidth - 5, y + TOOLBAR_HEIGHT - 20, FILLED);
-    pWind->DrawString(x + 5, y + 25, "Flip", BLACK_COLOR);
+    pBackend->DrawRectangle(x, y, x + itemWidth - 5, y + TOOLBAR_HEIGHT - 20, FILLED);
+    pBackend->DrawString(x + 5, y + 25, "Flip", BLACK_COLOR);
     x += itemWidth;
 
-    pWind->DrawRectangle(x, y, x + itemWidth - 5, y + TOOLBAR_HEIGHT - 20, FILLED);
-    pWind->DrawString(x + 5, y + 25, "Delete", BLACK_COLOR);
+    pBackend->DrawRectangle(x, y, x + itemWidth - 5, y + TOOLBAR_HEIGHT - 20, FILLED);
+    pBackend->DrawString(x + 5, y + 25, "Delete", BLACK_COLOR);
     x += itemWidth;
 
-    pWind->DrawRectangle(x, y, x + itemWidth - 5, y + TOOLBAR_HEIGHT - 20, FILLED);
-    pWind->DrawString(x + 5, y + 25, "Refresh", BLACK_COLOR);
+    pBackend->DrawRectangle(x, y, x + itemWidth - 5, y + TOOLBAR_HEIGHT - 20, FILLED);
+    pBackend->DrawString(x + 5, y + 25, "Refresh", BLACK_COLOR);
     x += itemWidth;
 
-    pWind->DrawRectangle(x, y, x + itemWidth - 5, y + TOOLBAR_HEIGHT - 20, FILLED);
-    pWind->DrawString(x + 5, y + 25, "Save", BLACK_COLOR);
+    pBackend->DrawRectangle(x, y, x + itemWidth - 5, y + TOOLBAR_HEIGHT - 20, FILLED);
+    pBackend->DrawString(x + 5, y + 25, "Save", BLACK_COLOR);
     x += itemWidth;
 
-    pWind->DrawRectangle(x, y, x + itemWidth - 5, y + TOOLBAR_HEIGHT - 20, FILLED);
-    pWind->DrawString(x + 5, y + 25, "Load", BLACK_COLOR);
+    pBackend->DrawRectangle(x, y, x + itemWidth - 5, y + TOOLBAR_HEIGHT - 20, FILLED);
+    pBackend->DrawString(x + 5, y + 25, "Load", BLACK_COLOR);
     x += itemWidth;
 
-    pWind->DrawRectangle(x, y, x + itemWidth - 5, y + TOOLBAR_HEIGHT - 20, FILLED);
-    pWind->DrawString(x + 5, y + 25, "Exit", BLACK_COLOR);
+    pBackend->DrawRectangle(x, y, x + itemWidth - 5, y + TOOLBAR_HEIGHT - 20, FILLED);
+    pBackend->DrawString(x + 5, y + 25, "Exit", BLACK_COLOR);
+    pBackend->SetPen(penColor, PEN_WIDTH);
 }
 
 // Draw the grid area
 void GUI::DrawGrid() const {
     // Clear grid area
-    pWind->SetBrush(WHITE_COLOR);
-    pWind->DrawRectangle(0, TOOLBAR_HEIGHT, WINDOW_WIDTH, 
+    pBackend->SetPen(BLACK_COLOR, PEN_WIDTH);
+    pBackend->SetBrush(WHITE_COLOR);
+    pBackend->DrawRectangle(0, TOOLBAR_HEIGHT, WINDOW_WIDTH, 
                         WINDOW_HEIGHT - STATUS_HEIGHT, FILLED);
+    pBackend->SetPen(penColor, PEN_WIDTH);
 }
 
 // Draw status bar
 void GUI::DrawStatusBar() const {
-    pWind->SetBrush(DARKGRAY_COLOR);
-    pWind->DrawRectangle(0, WINDOW_HEIGHT - STATUS_HEIGHT, 
+    pBackend->SetPen(BLACK_COLOR, PEN_WIDTH);
+    pBackend->SetBrush(DARKGRAY_COLOR);
+    pBackend->DrawRectangle(0, WINDOW_HEIGHT - STATUS_HEIGHT, 
                         WINDOW_WIDTH, WINDOW_HEIGHT, FILLED);
+    pBackend->SetPen(penColor, PEN_WIDTH);
 }
 
 // Clear grid area only
 void GUI::ClearGridArea() const {
-    pWind->SetBrush(WHITE_COLOR);
-    pWind->DrawRectangle(0, TOOLBAR_HEIGHT, WINDOW_WIDTH, 
+    pBackend->SetPen(BLACK_COLOR, PEN_WIDTH);
+    pBackend->SetBrush(WHITE_COLOR);
+    pBackend->DrawRectangle(0, TOOLBAR_HEIGHT, WINDOW_WIDTH, 
                         WINDOW_HEIGHT - STATUS_HEIGHT, FILLED);
+    pBackend->SetPen(penColor, PEN_WIDTH);
 }
 
 // Update status bar with message
 void GUI::UpdateStatusBar(string message) const {
     // Clear status bar
-    pWind->SetBrush(DARKGRAY_COLOR);
-    pWind->DrawRectangle(0, WINDOW_HEIGHT - STATUS_HEIGHT, 
+    pBackend->SetPen(BLACK_COLOR, PEN_WIDTH);
+    pBackend->SetBrush(DARKGRAY_COLOR);
+    pBackend->DrawRectangle(0, WINDOW_HEIGHT - STATUS_HEIGHT, 
                         WINDOW_WIDTH, WINDOW_HEIGHT, FILLED);
 
     // Draw message
-    pWind->DrawString(10, WINDOW_HEIGHT - STATUS_HEIGHT + 15, 
+    pBackend->DrawString(10, WINDOW_HEIGHT - STATUS_HEIGHT + 15, 
                      message, WHITE_COLOR);
+    pBackend->SetPen(penColor, PEN_WIDTH);
+}
+
+// Limit drawing to a box
+bool GUI::SetClip(const BoundingBox& box) const {
+    return pBackend->SetClip(box);
+}
+
+void GUI::ResetClip() const {
+    pBackend->ResetClip();
+}
+
+// Start recording shape drawing into a buffer
+void GUI::BeginRecording(CommandBuffer* buffer) {
+    pRecording = buffer;
+    recordPen = penColor;
+    recordBrush = WHITE_COLOR;
+}
+
+void GUI::EndRecording() {
+    pRecording = nullptr;
+}
+
+// Draw the commands that reach into a region, setting the pen and brush
+// only when they differ from the previous command's
+void GUI::Submit(const CommandBuffer& buffer, const BoundingBox& region) {
+    bool first = true;
+    uint32_t penKey = 0, brushKey = 0;
+    for(const CommandBuffer::Command& command : buffer.GetCommands()) {
+        if(!command.bounds.Intersects(region)) continue;
+
+        if(first || command.penKey != penKey) {
+            SetPenColor(command.pen);
+            penKey = command.penKey;
+        }
+        if(first || command.brushKey != brushKey) {
+            SetBrushColor(command.brush);
+            brushKey = command.brushKey;
+        }
+        first = false;
+
+        switch(command.type) {
+            case CommandBuffer::CMD_RECTANGLE: DrawRectangle(command.p1, command.p2, command.mode); break;
+            case CommandBuffer::CMD_CIRCLE: DrawCircle(command.p1, command.radius, command.mode); break;
+            case CommandBuffer::CMD_TRIANGLE: DrawTriangle(command.p1, command.p2, command.p3, command.mode); break;
+        }
+    }
 }
 
 // Set pen color
 void GUI::SetPenColor(color c) {
-    pWind->SetPen(c, 2);
+    if(pRecording) {
+        recordPen = c;
+        return;
+    }
+    penColor = c;
+    pBackend->SetPen(c, PEN_WIDTH);
 }
 
 // Set brush color
 void GUI::SetBrushColor(color c) {
-    pWind->SetBrush(c);
+    if(pRecording) {
+        recordBrush = c;
+        return;
+    }
+    pBackend->SetBrush(c);
 }
 
-// Drawing functions
+// Drawing functions, recorded instead of drawn while a buffer is recording
 void GUI::DrawRectangle(Point p1, Point p2, DrawingMode mode) const {
-    pWind->DrawRectangle(p1.x, p1.y, p2.x, p2.y, mode);
+    if(pRecording) {
+        pRecording->AddRectangle(p1, p2, mode, recordPen, recordBrush);
+        return;
+    }
+    pBackend->DrawRectangle(p1.x, p1.y, p2.x, p2.y, mode);
 }
 
 void GUI::DrawCircle(Point center, int radius, DrawingMode mode) const {
-    pWind->DrawCircle(center.x, center.y, radius, mode);
+    if(pRecording) {
+        pRecording->AddCircle(center, radius, mode, recordPen, recordBrush);
+        return;
+    }
+    pBackend->DrawCircle(center.x, center.y, radius, mode);
 }
 
 void GUI::DrawTriangle(Point p1, Point p2, Point p3, DrawingMode mode) const {
-    pWind->DrawTriangle(p1.x, p1.y, p2.x, p2.y, p3.x, p3.y, mode);
+    if(pRecording) {
+        pRecording->AddTriangle(p1, p2, p3, mode, recordPen, recordBrush);
+        return;
+    }
+    pBackend->DrawTriangle(p1.x, p1.y, p2.x, p2.y, p3.x, p3.y, mode);
 }
 
 void GUI::DrawString(Point p, string text) const {
-    pWind->DrawString(p.x, p.y, text);
+    pBackend->DrawString(p.x, p.y, text, penColor);
 }
 
-// Get point clicked
-void GUI::GetPointClicked(Point& p) const {
-    pWind->GetMouseClick(p.x, p.y);
+// Get point clicked, false if there was no click
+bool GUI::GetPointClicked(Point& p) const {
+    return pBackend->GetMouseClick(p.x, p.y);
 }
 
-// Get key pressed
-void GUI::GetKeyPressed(char& key) const {
-    pWind->GetKeyPress(key);
+// Get key pressed, false if no key is waiting
+bool GUI::GetKeyPressed(char& key) const {
+    return pBackend->GetKeyPress(key);
 }
 
 // Get user click and determine toolbar item
 ToolbarItem GUI::GetUserClick() const {
     Point p;
-    pWind->GetMouseClick(p.x, p.y);
+    if(!pBackend->GetMouseClick(p.x, p.y)) return ITM_INVALID;
 
     if(p.y <= TOOLBAR_HEIGHT) {
         int itemWidth = WINDOW_WIDTH / 18;
@@ -200,20 +280,20 @@ ToolbarItem GUI::GetUserClick() const {
 void GUI::DisplayScore(int score) const {
     ostringstream oss;
     oss << "Score: " << score;
-    pWind->DrawString(WINDOW_WIDTH - 200, WINDOW_HEIGHT - 35, 
+    pBackend->DrawString(WINDOW_WIDTH - 200, WINDOW_HEIGHT - 35, 
                      oss.str(), WHITE_COLOR);
 }
 
 void GUI::DisplayLives(int lives) const {
     ostringstream oss;
     oss << "Lives: " << lives;
-    pWind->DrawString(WINDOW_WIDTH - 300, WINDOW_HEIGHT - 35, 
+    pBackend->DrawString(WINDOW_WIDTH - 300, WINDOW_HEIGHT - 35, 
                      oss.str(), WHITE_COLOR);
 }
 
 void GUI::DisplayLevel(int level) const {
     ostringstream oss;
     oss << "Level: " << level;
-    pWind->DrawString(WINDOW_WIDTH - 400, WINDOW_HEIGHT - 35, 
+    pBackend->DrawString(WINDOW_WIDTH - 400, WINDOW_HEIGHT - 35, 
                      oss.str(), WHITE_COLOR);
 }
@@ -1,18 +1,19 @@
 #include "Grid.h"
-#include "Sign.h"
-#include "Home.h"
-#include "Person.h"
-#include "Car.h"
-#include "Flower.h"
-#include "Robot.h"
 #include <cstdlib>
 #include <ctime>
 #include <algorithm>
+#include <unordered_map>
+#include <new>
 
 using namespace std;
 
 // Constructor
-Grid::Grid() {
+Grid::Grid() : commands(GUI::WINDOW_WIDTH, GUI::WINDOW_HEIGHT, GUI::PEN_WIDTH),
+               index(GUI::WINDOW_WIDTH, GUI::WINDOW_HEIGHT, INDEX_CELL_SIZE) {
+    commandsStale = true;
+    useCommands = true;
+    nextRank = 0;
+    useIndex = true;
     selectedShape = nullptr;
     currentLevel = 1;
     score = 0;
@@ -31,7 +32,11 @@ Grid::~Grid() {
 // Add random shape to the grid
 void Grid::AddRandomShape(Shape* shape) {
     if(shape) {
+        long long rank = RANDOM_RANK + nextRank++;
         randomShapes.push_back(shape);
+        index.Insert(shape, rank);
+        FileTarget(shape, rank);
+        commandsStale = true;
     }
 }
 
@@ -39,18 +44,23 @@ void Grid::AddRandomShape(Shape* shape) {
 void Grid::AddPlayerShape(Shape* shape) {
     if(shape) {
         playerShapes.push_back(shape);
+        index.Insert(shape, nextRank++);
+        commandsStale = true;
     }
 }
 
 // Delete a shape from the grid
 void Grid::DeleteShape(Shape* shape) {
     if(!shape) return;
+    commandsStale = true;
+    index.Remove(shape);
+    RemoveTarget(shape);
 
     // Remove from random shapes
     auto it = find(randomShapes.begin(), randomShapes.end(), shape);
     if(it != randomShapes.end()) {
         randomShapes.erase(it);
-        delete shape;
+        DestroyShape(shape);
         return;
     }
 
@@ -58,7 +68,7 @@ void Grid::DeleteShape(Shape* shape) {
     it = find(playerShapes.begin(), playerShapes.end(), shape);
     if(it != playerShapes.end()) {
         playerShapes.erase(it);
-        delete shape;
+        DestroyShape(shape);
         return;
     }
 }
@@ -66,17 +76,26 @@ void Grid::DeleteShape(Shape* shape) {
 // Clear all random shapes
 void Grid::ClearRandomShapes() {
     for(Shape* shape : randomShapes) {
-        delete shape;
+        if(shape == selectedShape) selectedShape = nullptr;
+        index.Remove(shape);
+        DestroyShape(shape);
     }
     randomShapes.clear();
+    for(auto& filed : targets) {
+        filed.second.clear();
+    }
+    commandsStale = true;
 }
 
 // Clear all player shapes
 void Grid::ClearPlayerShapes() {
     for(Shape* shape : playerShapes) {
-        delete shape;
+        if(shape == selectedShape) selectedShape = nullptr;
+        index.Remove(shape);
+        DestroyShape(shape);
     }
     playerShapes.clear();
+    commandsStale = true;
 }
 
 // Clear all shapes
@@ -86,6 +105,48 @@ void Grid::ClearAllShapes() {
     selectedShape = nullptr;
 }
 
+// Move a transformed shape to the index cells its new bounds cover
+void Grid::UpdateShape(Shape* shape) {
+    if(!shape) return;
+    index.Update(shape);
+    RefileTarget(shape);
+}
+
+// File a random shape under its signature, keeping each list in grid order
+void Grid::FileTarget(Shape* shape, long long rank) {
+    Target target = {shape, rank};
+    vector<Target>& filed = targets[shape->GetSignature()];
+    auto it = upper_bound(filed.begin(), filed.end(), target,
+                          [](const Target& a, const Target& b) { return a.rank < b.rank; });
+    filed.insert(it, target);
+    shape->filing.targeted = true;
+    shape->filing.targetKey = shape->GetSignature();
+}
+
+// Take a random shape out of the signature table, returning its rank. An
+// emptied list stays in the table, so filing under it again allocates nothing
+long long Grid::RemoveTarget(const Shape* shape) {
+    if(!shape->filing.targeted) return -1;
+
+    long long rank = -1;
+    vector<Target>& filed = targets[shape->filing.targetKey];
+    for(auto it = filed.begin(); it != filed.end(); ++it) {
+        if(it->shape == shape) {
+            rank = it->rank;
+            filed.erase(it);
+            break;
+        }
+    }
+    shape->filing.targeted = false;
+    return rank;
+}
+
+// File a random shape again once its signature has changed
+void Grid::RefileTarget(Shape* shape) {
+    if(!shape->filing.targeted || shape->filing.targetKey == shape->GetSignature()) return;
+    FileTarget(shape, RemoveTarget(shape));
+}
+
 // Generate random shapes for current level
 void Grid::GenerateRandomShapes() {
     ClearRandomShapes();
@@ -137,23 +198,25 @@ void Grid::SetLevel(int level) {
 bool Grid::CheckMatch(Shape* playerShape) {
     if(!playerShape) return false;
 
-    for(auto it = randomShapes.begin(); it != randomShapes.end(); ++it) {
-        if(playerShape->Match(*it)) {
-            // Found a match
-            delete *it;
-            randomShapes.erase(it);
-            currentMatches++;
-
-            // Update score
-            score += 2;
-
-            // Check if level completed
-            if(currentMatches >= targetMatches) {
-                NextLevel();
-            }
-
-            return true;
+    Shape* target = FindMatch(playerShape);
+    if(target) {
+        // Found a match
+        index.Remove(target);
+        RemoveTarget(target);
+        randomShapes.erase(find(randomShapes.begin(), randomShapes.end(), target));
+        DestroyShape(target);
+        commandsStale = true;
+        currentMatches++;
+
+        // Update score
+        score += 2;
+
+        // Check if level completed
+        if(currentMatches >= targetMatches) {
+            NextLevel();
         }
+
+        return true;
     }
 
     // No match found - lose points
@@ -161,6 +224,22 @@ bool Grid::CheckMatch(Shape* playerShape) {
     return false;
 }
 
+// First random shape, in grid order, that a shape matches. Only the targets
+// filed under the shape's signature need the exact Match, and unless two
+// signatures collide the first one does. A shape never matches itself
+Shape* Grid::FindMatch(const Shape* shape) const {
+    if(!shape) return nullptr;
+
+    auto filed = targets.find(shape->GetSignature());
+    if(filed == targets.end()) return nullptr;
+    for(const Target& target : filed->second) {
+        if(target.shape != shape && shape->Match(target.shape)) {
+            return target.shape;
+        }
+    }
+    return nullptr;
+}
+
 // Refresh the current level
 void Grid::RefreshLevel() {
     if(lives > 0) {
@@ -170,8 +249,18 @@ void Grid::RefreshLevel() {
     }
 }
 
-// Get shape at specified point
+// Get shape at specified point. The index gives the shapes whose bounds
+// cover the point's cell in pick order, only those get the exact test
 Shape* Grid::GetShapeAt(Point p) {
+    if(useIndex && index.Covers(p)) {
+        for(const SpatialHash::Entry& entry : index.Candidates(p)) {
+            if(entry.shape->IsPointInside(p)) {
+                return entry.shape;
+            }
+        }
+        return nullptr;
+    }
+
     // Check player shapes first
     for(Shape* shape : playerShapes) {
         if(shape && shape->IsPointInside(p)) {
@@ -191,27 +280,52 @@ Shape* Grid::GetShapeAt(Point p) {
 
 // Set selected shape
 void Grid::SetSelectedShape(Shape* shape) {
+    if(shape != selectedShape) commandsStale = true;
     selectedShape = shape;
 }
 
 // Draw all shapes in the grid
 void Grid::Draw(GUI* pGUI) const {
+    Draw(pGUI, GUI::WindowArea());
+}
+
+// Draw the shapes that reach into a region. The command buffer is
+// recorded again only when something drawn has changed
+void Grid::Draw(GUI* pGUI, const BoundingBox& region) const {
+    if(!useCommands) {
+        DrawShapes(pGUI, region);
+        return;
+    }
+
+    if(commandsStale) {
+        commands.Clear();
+        pGUI->BeginRecording(&commands);
+        DrawShapes(pGUI, GUI::WindowArea());
+        pGUI->EndRecording();
+        commands.Finish();
+        commandsStale = false;
+    }
+    pGUI->Submit(commands, region);
+}
+
+// Draw the shapes that reach into a region, one at a time in grid order
+void Grid::DrawShapes(GUI* pGUI, const BoundingBox& region) const {
     // Draw random shapes
     for(const Shape* shape : randomShapes) {
-        if(shape) {
+        if(shape && shape->GetBounds().Padded(GUI::PEN_WIDTH).Intersects(region)) {
             shape->Draw(pGUI);
         }
     }
 
     // Draw player shapes
     for(const Shape* shape : playerShapes) {
-        if(shape) {
+        if(shape && shape->GetBounds().Padded(GUI::PEN_WIDTH).Intersects(region)) {
             shape->Draw(pGUI);
         }
     }
 
     // Highlight selected shape
-    if(selectedShape) {
+    if(selectedShape && HighlightBounds().Padded(GUI::PEN_WIDTH).Intersects(region)) {
         pGUI->SetPenColor(YELLOW_COLOR);
         pGUI->SetBrushColor(TRANSPARENT_COLOR);
         Point ref = selectedShape->GetRefPoint();
@@ -220,6 +334,76 @@ void Grid::Draw(GUI* pGUI) const {
     }
 }
 
+// Box of the selection highlight, empty when nothing is selected
+BoundingBox Grid::HighlightBounds() const {
+    if(!selectedShape) return BoundingBox();
+    Point ref = selectedShape->GetRefPoint();
+    return BoundingBox(ref.x - 5, ref.y - 5, ref.x + 55, ref.y + 55);
+}
+
+// Everything about a shape that changes how it is drawn
+Grid::DrawnShape Grid::Snapshot(const Shape* shape) const {
+    DrawnShape drawn;
+    drawn.shape = shape;
+    drawn.type = shape->GetShapeType();
+    drawn.rotations = shape->GetRotationCount();
+    drawn.resizes = shape->GetResizeCount();
+    drawn.flipped = shape->GetFlipStatus();
+    drawn.fill = shape->GetFillColor();
+    drawn.outline = shape->GetOutlineColor();
+    drawn.bounds = shape->GetBounds();
+    return drawn;
+}
+
+// Add the old and new boxes of every shape that was added, removed or
+// changed since the last call, padded for the outline
+void Grid::CollectDamage(vector<BoundingBox>& damage) {
+    size_t previousDamage = damage.size();
+    vector<DrawnShape> current;
+    current.reserve(randomShapes.size() + playerShapes.size());
+    for(const Shape* shape : randomShapes) {
+        if(shape) current.push_back(Snapshot(shape));
+    }
+    for(const Shape* shape : playerShapes) {
+        if(shape) current.push_back(Snapshot(shape));
+    }
+
+    unordered_map<const Shape*, size_t> previous;
+    for(size_t i = 0; i < drawnShapes.size(); i++) {
+        previous[drawnShapes[i].shape] = i;
+    }
+
+    vector<bool> kept(drawnShapes.size(), false);
+    for(const DrawnShape& now : current) {
+        auto it = previous.find(now.shape);
+        if(it != previous.end()) {
+            const DrawnShape& before = drawnShapes[it->second];
+            kept[it->second] = true;
+            if(before.type == now.type && before.rotations == now.rotations &&
+               before.resizes == now.resizes && before.flipped == now.flipped &&
+               before.fill == now.fill && before.outline == now.outline &&
+               before.bounds == now.bounds) {
+                continue;
+            }
+            damage.push_back(before.bounds.Padded(GUI::PEN_WIDTH));
+        }
+        damage.push_back(now.bounds.Padded(GUI::PEN_WIDTH));
+    }
+    for(size_t i = 0; i < drawnShapes.size(); i++) {
+        if(!kept[i]) damage.push_back(drawnShapes[i].bounds.Padded(GUI::PEN_WIDTH));
+    }
+
+    BoundingBox highlight = HighlightBounds();
+    if(highlight != drawnHighlight) {
+        damage.push_back(drawnHighlight.Padded(GUI::PEN_WIDTH));
+        damage.push_back(highlight.Padded(GUI::PEN_WIDTH));
+    }
+
+    if(damage.size() > previousDamage) commandsStale = true;
+    drawnShapes.swap(current);
+    drawnHighlight = highlight;
+}
+
 // Go to next level
 void Grid::NextLevel() {
     currentLevel++;
@@ -244,10 +428,12 @@ bool Grid::IsPositionValid(Point p, Shape* shape) const {
 
 // Apply black fill for level 3+
 void Grid::ApplyBlackFill() {
+    commandsStale = true;
     for(Shape* shape : randomShapes) {
         if(shape) {
             shape->SetFillColor(BLACK);
             shape->SetOutlineColor(BLACK);
+            RefileTarget(shape);
         }
     }
 }
@@ -257,18 +443,17 @@ void Grid::CalculateTargetMatches() {
     targetMatches = randomShapes.size();
 }
 
-// Create random composite shape
+// Create a composite of a random prototype in a pool slot
 Shape* Grid::CreateRandomCompositeShape() {
-    int shapeType = rand() % 6; // 0-5 for 6 different composite shapes
-    Point defaultPos(300, 300);
-
-    switch(shapeType) {
-        case 0: return new Sign(defaultPos);
-        case 1: return new Home(defaultPos);
-        case 2: return new Person(defaultPos);
-        case 3: return new Car(defaultPos);
-        case 4: return new Flower(defaultPos);
-        case 5: return new Robot(defaultPos);
-        default: return new Sign(defaultPos);
+    const CompositePrototype* prototype = CompositePrototype::Get(rand() % CompositePrototype::GetCount());
+    return new (pool.Allocate()) CompositeShape(prototype);
+}
+
+// Free a shape from the pool or the heap, wherever it was made
+void Grid::DestroyShape(Shape* shape) {
+    if(pool.Owns(shape)) {
+        pool.Release(shape);
+    } else {
+        delete shape;
     }
 }
@@ -0,0 +1,142 @@
+#include "HeadlessBackend.h"
+#include <algorithm>
+#include <fstream>
+
+using namespace std;
+
+// Glyph cell used in place of a font
+static const int GLYPH_WIDTH = 6;
+static const int GLYPH_HEIGHT = 9;
+static const int GLYPH_ADVANCE = 8;
+
+// Constructor
+HeadlessBackend::HeadlessBackend(int w, int h)
+    : width(w), height(h), pixels((size_t)w * h, PackColor(WHITE_COLOR)),
+      rasterizer(pixels.data(), w, h) {
+    penPixel = PackColor(BLACK_COLOR);
+    penWidth = 2;
+    brushPixel = PackColor(WHITE_COLOR);
+    primitiveCount = 0;
+    stateChangeCount = 0;
+}
+
+// Pack a color into a framebuffer pixel
+uint32_t HeadlessBackend::PackColor(color c) {
+    return (uint32_t)c.ucRed | ((uint32_t)c.ucGreen << 8) |
+           ((uint32_t)c.ucBlue << 16) | ((uint32_t)c.ucAlpha << 24);
+}
+
+// Set pen color and width
+void HeadlessBackend::SetPen(color c, int w) {
+    stateChangeCount++;
+    penPixel = PackColor(c);
+    penWidth = max(1, w);
+}
+
+// Set brush color
+void HeadlessBackend::SetBrush(color c) {
+    stateChangeCount++;
+    brushPixel = PackColor(c);
+}
+
+// Fill the whole framebuffer
+void HeadlessBackend::Clear(color c) {
+    rasterizer.FillBox(0, 0, width - 1, height - 1, PackColor(c));
+}
+
+// Drawing functions, the fill pass goes first and the outline is drawn over it.
+// When the pen is visible, the fill skips the pixels the outline covers
+void HeadlessBackend::DrawRectangle(int x1, int y1, int x2, int y2, DrawingMode mode) {
+    primitiveCount++;
+    if(x1 > x2) swap(x1, x2);
+    if(y1 > y2) swap(y1, y2);
+    if(mode == FILLED) {
+        int inset = PenVisible() ? penWidth : 0;
+        if(x2 - x1 >= 2 * inset && y2 - y1 >= 2 * inset) {
+            rasterizer.FillBox(x1 + inset, y1 + inset, x2 - inset, y2 - inset, brushPixel);
+        }
+    }
+
+    int w = penWidth - 1;
+    rasterizer.FillBox(x1, y1, x2, y1 + w, penPixel);
+    rasterizer.FillBox(x1, y2 - w, x2, y2, penPixel);
+    rasterizer.FillBox(x1, y1, x1 + w, y2, penPixel);
+    rasterizer.FillBox(x2 - w, y1, x2, y2, penPixel);
+}
+
+void HeadlessBackend::DrawCircle(int x, int y, int radius, DrawingMode mode) {
+    primitiveCount++;
+    if(mode == FILLED) rasterizer.FillCircle(x, y, PenVisible() ? radius - penWidth : radius, brushPixel);
+    rasterizer.FillRing(x, y, radius, radius - penWidth, penPixel);
+}
+
+void HeadlessBackend::DrawTriangle(int x1, int y1, int x2, int y2, int x3, int y3, DrawingMode mode) {
+    primitiveCount++;
+    rasterizer.DrawTriangle(x1, y1, x2, y2, x3, y3, penWidth, penPixel, mode == FILLED ? brushPixel : 0);
+}
+
+// Text is drawn as one solid cell per visible character
+void HeadlessBackend::DrawString(int x, int y, const string& text, color c) {
+    primitiveCount++;
+    uint32_t pixel = PackColor(c);
+    for(size_t i = 0; i < text.size(); i++) {
+        if(text[i] == ' ') continue;
+        int left = x + (int)i * GLYPH_ADVANCE;
+        rasterizer.FillBox(left, y, left + GLYPH_WIDTH - 1, y + GLYPH_HEIGHT - 1, pixel);
+    }
+}
+
+// Limit drawing to a box
+bool HeadlessBackend::SetClip(const BoundingBox& box) {
+    rasterizer.SetClip(box.left, box.top, box.right, box.bottom);
+    return true;
+}
+
+void HeadlessBackend::ResetClip() {
+    rasterizer.ResetClip();
+}
+
+// Take the next queued click
+bool HeadlessBackend::GetMouseClick(int& x, int& y) {
+    if(clicks.empty()) return false;
+    x = clicks.front().x;
+    y = clicks.front().y;
+    clicks.pop_front();
+    return true;
+}
+
+// Take the next queued key press
+bool HeadlessBackend::GetKeyPress(char& key) {
+    if(keys.empty()) return false;
+    key = keys.front();
+    keys.pop_front();
+    return true;
+}
+
+// FNV-1a hash of the framebuffer
+uint64_t HeadlessBackend::Checksum() const {
+    uint64_t hash = 14695981039346656037ULL;
+    for(uint32_t pixel : pixels) {
+        hash = (hash ^ pixel) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+// Write the framebuffer as a binary PPM, dropping alpha
+bool HeadlessBackend::SavePPM(const string& filename) const {
+    ofstream outFile(filename, ios::binary);
+    if(!outFile.is_open()) return false;
+
+    outFile << "P6\n" << width << " " << height << "\n255\n";
+    vector<unsigned char> row((size_t)width * 3);
+    for(int y = 0; y < height; y++) {
+        for(int x = 0; x < width; x++) {
+            uint32_t pixel = GetPixel(x, y);
+            row[x * 3] = pixel & 0xFF;
+            row[x * 3 + 1] = (pixel >> 8) & 0xFF;
+            row[x * 3 + 2] = (pixel >> 16) & 0xFF;
+        }
+        outFile.write((const char*)row.data(), row.size());
+    }
+    return outFile.good();
+}
@@ -0,0 +1,423 @@
+#include "ApplicationManager.h"
+#include "HeadlessBackend.h"
+#include "Rectangle.h"
+#include "Circle.h"
+#include "Triangle.h"
+#include "Sign.h"
+#include "Home.h"
+#include "Person.h"
+#include "Car.h"
+#include "Flower.h"
+#include "Robot.h"
+#include "ShapePool.h"
+#include <iostream>
+#include <string>
+#include <cstdlib>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+
+using namespace std;
+
+// Scripted moves the headless driver cycles through
+static const ToolbarItem SCRIPT[] = {
+    ITM_SIGN, ITM_ROTATE, ITM_RESIZE_UP, ITM_FLIP,
+    ITM_HOME, ITM_ROTATE, ITM_RESIZE_DOWN,
+    ITM_PERSON, ITM_FLIP, ITM_ROTATE,
+    ITM_CAR, ITM_RESIZE_UP, ITM_RESIZE_DOWN,
+    ITM_FLOWER, ITM_ROTATE, ITM_FLIP,
+    ITM_ROBOT, ITM_RESIZE_UP, ITM_DELETE
+};
+static const int SCRIPT_LENGTH = sizeof(SCRIPT) / sizeof(SCRIPT[0]);
+
+// Frame time the shape benchmark is measured against
+static const double FRAME_BUDGET_MS = 16.0;
+
+// One shape of the fill benchmark
+struct BenchShape {
+    int type;  // 0 rectangle, 1 circle, 2 triangle
+    Point p1, p2, p3;
+    int radius;
+    color fill, outline;
+};
+
+// Random color with full alpha
+color RandomColor() {
+    return color(rand() % 256, rand() % 256, rand() % 256);
+}
+
+// Mixed rectangles, circles and triangles 10 to 60 pixels across
+vector<BenchShape> MakeBenchShapes(int count, int width, int height) {
+    vector<BenchShape> shapes(count);
+    for(BenchShape& shape : shapes) {
+        shape.type = rand() % 3;
+        int size = 10 + rand() % 51;
+        int x = rand() % (width - size), y = rand() % (height - size);
+        shape.p1 = Point(x, y);
+        shape.p2 = Point(x + size, y + 10 + rand() % 51);
+        shape.p3 = Point(x + rand() % (size + 1), y + size);
+        shape.radius = size / 2;
+        shape.fill = RandomColor();
+        shape.outline = RandomColor();
+    }
+    return shapes;
+}
+
+// Draw every shape through the GUI, filled and outlined
+void DrawBenchShapes(GUI& gui, const vector<BenchShape>& shapes) {
+    for(const BenchShape& shape : shapes) {
+        gui.SetBrushColor(shape.fill);
+        gui.SetPenColor(shape.outline);
+        if(shape.type == 0) {
+            gui.DrawRectangle(shape.p1, shape.p2, FILLED);
+        } else if(shape.type == 1) {
+            gui.DrawCircle(Point(shape.p1.x + shape.radius, shape.p1.y + shape.radius), shape.radius, FILLED);
+        } else {
+            gui.DrawTriangle(shape.p1, shape.p2, shape.p3, FILLED);
+        }
+    }
+}
+
+// Time the shape fill with and without the vector paths
+int RunShapeBenchmark(int count, int frames, unsigned seed, const string& outputFile) {
+    srand(seed);
+    vector<BenchShape> shapes = MakeBenchShapes(count, GUI::WINDOW_WIDTH, GUI::WINDOW_HEIGHT);
+    uint64_t checksums[2];
+
+    for(int pass = 0; pass < 2; pass++) {
+        HeadlessBackend* backend = new HeadlessBackend(GUI::WINDOW_WIDTH, GUI::WINDOW_HEIGHT);
+        GUI gui(backend);
+        backend->GetRasterizer().SetSIMD(pass == 0);
+
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        for(int frame = 0; frame < frames; frame++) {
+            backend->Clear(WHITE_COLOR);
+            DrawBenchShapes(gui, shapes);
+        }
+        double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count() / max(frames, 1);
+        checksums[pass] = backend->Checksum();
+
+        cout << (pass == 0 ? (backend->GetRasterizer().UsesAVX2() ? "AVX2  " : "SSE2  ") : "Scalar")
+             << ": " << count << " shapes, " << ms << " ms/frame ("
+             << ms / FRAME_BUDGET_MS * 100.0 << "% of a " << FRAME_BUDGET_MS << " ms frame), checksum "
+             << hex << checksums[pass] << dec << endl;
+
+        if(pass == 0 && !outputFile.empty() && !backend->SavePPM(outputFile)) {
+            cerr << "Error writing " << outputFile << endl;
+            return 1;
+        }
+    }
+
+    if(checksums[0] != checksums[1]) {
+        cerr << "Vector and scalar framebuffers differ" << endl;
+        return 1;
+    }
+    return 0;
+}
+
+// Random composite or basic shape at a point, rotated and resized at random
+Shape* MakePickShape(Point p) {
+    Shape* shape;
+    switch(rand() % 9) {
+        case 0: shape = new Sign(p); break;
+        case 1: shape = new Home(p); break;
+        case 2: shape = new Person(p); break;
+        case 3: shape = new Car(p); break;
+        case 4: shape = new Flower(p); break;
+        case 5: shape = new Robot(p); break;
+        case 6: shape = new Rectangle(p); break;
+        case 7: shape = new Circle(p); break;
+        default: shape = new Triangle(p); break;
+    }
+    int rotations = rand() % 4;
+    for(int r = 0; r < rotations; r++) {
+        shape->Rotate();
+    }
+    int resizes = (rand() % 3) - 1;
+    if(resizes > 0) shape->ResizeUp();
+    else if(resizes < 0) shape->ResizeDown();
+    if(rand() % 2) shape->Flip();
+    return shape;
+}
+
+// Time GetShapeAt over a crowded grid with and without the spatial index.
+// The linear scan is slow enough that it only runs the first few picks,
+// which also have to agree with the indexed picks
+int RunPickBenchmark(int count, int picks, unsigned seed) {
+    Grid grid;
+    grid.ClearAllShapes();
+    srand(seed);
+    for(int i = 0; i < count; i++) {
+        Point p(rand() % GUI::GRID_WIDTH, GUI::TOOLBAR_HEIGHT + rand() % GUI::GRID_HEIGHT);
+        if(i % 10 == 0) grid.AddPlayerShape(MakePickShape(p));
+        else grid.AddRandomShape(MakePickShape(p));
+    }
+
+    vector<Point> points(picks);
+    for(Point& p : points) {
+        p = Point(rand() % GUI::GRID_WIDTH, GUI::TOOLBAR_HEIGHT + rand() % GUI::GRID_HEIGHT);
+    }
+    int linearPicks = min(picks, max(1, 10000000 / max(count, 1)));
+
+    vector<Shape*> found[2];
+    double rates[2];
+    for(int pass = 0; pass < 2; pass++) {
+        int n = pass == 0 ? picks : linearPicks;
+        grid.SetSpatialIndex(pass == 0);
+        found[pass].resize(n);
+
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        for(int i = 0; i < n; i++) {
+            found[pass][i] = grid.GetShapeAt(points[i]);
+        }
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        rates[pass] = n / max(seconds, 1e-9);
+
+        int hits = (int)(n - count_if(found[pass].begin(), found[pass].end(), [](Shape* s) { return !s; }));
+        cout << (pass == 0 ? "Indexed" : "Linear ") << ": " << count << " shapes, " << n << " picks, "
+             << hits << " hits, " << rates[pass] << " picks/s" << endl;
+    }
+    cout << "Speedup " << rates[0] / rates[1] << "x" << endl;
+
+    for(int i = 0; i < linearPicks; i++) {
+        if(found[0][i] != found[1][i]) {
+            cerr << "Indexed and linear picks differ at (" << points[i].x << ", " << points[i].y << ")" << endl;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Random shape for the match benchmark, recolored so basic targets spread
+// over more signatures
+Shape* MakeMatchShape() {
+    static const ShapeColor COLORS[] = {RED, BLUE, GREEN, YELLOW, ORANGE, PURPLE};
+    Shape* shape = MakePickShape(Point(0, 0));
+    shape->SetFillColor(COLORS[rand() % 6]);
+    return shape;
+}
+
+// Time Grid::FindMatch against trying Match on every target in order, the
+// way CheckMatch used to. Both have to pick the same target
+int RunMatchBenchmark(int count, int probes, unsigned seed) {
+    Grid grid;
+    grid.ClearAllShapes();
+    srand(seed);
+    vector<Shape*> shapes(count);
+    for(Shape*& shape : shapes) {
+        shape = MakeMatchShape();
+        grid.AddRandomShape(shape);
+    }
+    vector<Shape*> players(min(probes, 1000));
+    for(Shape*& player : players) {
+        player = MakeMatchShape();
+    }
+
+    vector<const Shape*> found[2];
+    double rates[2];
+    for(int pass = 0; pass < 2; pass++) {
+        found[pass].resize(probes);
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        for(int i = 0; i < probes; i++) {
+            const Shape* player = players[i % players.size()];
+            if(pass == 0) {
+                found[pass][i] = grid.FindMatch(player);
+            } else {
+                found[pass][i] = nullptr;
+                for(const Shape* shape : shapes) {
+                    if(player->Match(shape)) {
+                        found[pass][i] = shape;
+                        break;
+                    }
+                }
+            }
+        }
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        rates[pass] = probes / max(seconds, 1e-9);
+
+        int hits = (int)(probes - count_if(found[pass].begin(), found[pass].end(), [](const Shape* s) { return !s; }));
+        cout << (pass == 0 ? "Hashed" : "Linear") << ": " << count << " targets, " << probes << " checks, "
+             << hits << " matches, " << rates[pass] << " checks/s" << endl;
+    }
+    cout << "Speedup " << rates[0] / rates[1] << "x" << endl;
+
+    for(Shape* player : players) {
+        delete player;
+    }
+    if(found[0] != found[1]) {
+        cerr << "Hashed and linear matches differ" << endl;
+        return 1;
+    }
+    return 0;
+}
+
+// Time building count composites from their prototypes in a ShapePool,
+// then Grid::SetLevel for a level of about as many random shapes, which
+// also indexes every shape and files it as a target. Each is repeated
+// rounds times, dropping the previous shapes each time
+int RunLevelBenchmark(int count, int rounds, unsigned seed) {
+    Grid grid;
+    grid.ClearAllShapes();
+    srand(seed);
+
+    ShapePool pool;
+    vector<Shape*> shapes(count);
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for(int i = 0; i < rounds; i++) {
+        for(Shape*& shape : shapes) {
+            const CompositePrototype* prototype = CompositePrototype::Get(rand() % CompositePrototype::GetCount());
+            shape = new (pool.Allocate()) CompositeShape(prototype, Point(rand() % GUI::GRID_WIDTH, rand() % GUI::GRID_HEIGHT));
+            shape->Rotate();
+        }
+        for(Shape* shape : shapes) {
+            pool.Release(shape);
+        }
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cout << "Shapes: " << count << " composites, " << rounds << " builds, "
+         << seconds * 1e6 / max(rounds, 1) << " us/build ("
+         << seconds * 1e9 / max(rounds * count, 1) << " ns/shape)" << endl;
+
+    int level = max(1, (count + 1) / 2);
+    start = chrono::steady_clock::now();
+    for(int i = 0; i < rounds; i++) {
+        grid.SetLevel(level);
+    }
+    seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    int placed = grid.GetRemainingShapes();
+    cout << "Level " << level << ": " << placed << " shapes, " << rounds << " builds, "
+         << seconds * 1e6 / max(rounds, 1) << " us/level ("
+         << seconds * 1e9 / max(rounds * placed, 1) << " ns/shape)" << endl;
+    return 0;
+}
+
+// Print command line usage
+void PrintUsage() {
+    cerr << "Usage: ShapeHuntHeadless [--frames N] [--seed S] [--level L] [--output frame.ppm]" << endl;
+    cerr << "                         [--full-redraw] [--check-redraw] [--immediate] [--manual-match]" << endl;
+    cerr << "       ShapeHuntHeadless --bench-shapes N [--frames F] [--seed S] [--output frame.ppm]" << endl;
+    cerr << "       ShapeHuntHeadless --bench-picks N [--picks P] [--seed S]" << endl;
+    cerr << "       ShapeHuntHeadless --bench-matches N [--picks P] [--seed S]" << endl;
+    cerr << "       ShapeHuntHeadless --bench-levels N [--frames F] [--seed S]" << endl;
+}
+
+int main(int argc, char* argv[]) {
+    int frames = 1000;
+    int benchShapes = 0;
+    int benchPicks = 0;
+    int benchMatches = 0;
+    int benchLevels = 0;
+    int picks = 100000;
+    bool fullRedraw = false;
+    bool checkRedraw = false;
+    bool immediate = false;
+    bool manualMatch = false;
+    unsigned seed = 1;
+    int level = 1;
+    string outputFile;
+
+    for(int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if(arg == "--frames" && i + 1 < argc) {
+            frames = atoi(argv[++i]);
+        } else if(arg == "--seed" && i + 1 < argc) {
+            seed = strtoul(argv[++i], nullptr, 10);
+        } else if(arg == "--level" && i + 1 < argc) {
+            level = atoi(argv[++i]);
+        } else if(arg == "--bench-shapes" && i + 1 < argc) {
+            benchShapes = atoi(argv[++i]);
+        } else if(arg == "--bench-picks" && i + 1 < argc) {
+            benchPicks = atoi(argv[++i]);
+        } else if(arg == "--bench-matches" && i + 1 < argc) {
+            benchMatches = atoi(argv[++i]);
+        } else if(arg == "--bench-levels" && i + 1 < argc) {
+            benchLevels = atoi(argv[++i]);
+        } else if(arg == "--picks" && i + 1 < argc) {
+            picks = max(1, atoi(argv[++i]));
+        } else if(arg == "--full-redraw") {
+            fullRedraw = true;
+        } else if(arg == "--check-redraw") {
+            checkRedraw = true;
+        } else if(arg == "--immediate") {
+            immediate = true;
+        } else if(arg == "--manual-match") {
+            manualMatch = true;
+        } else if(arg == "--output" && i + 1 < argc) {
+            outputFile = argv[++i];
+        } else {
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    if(benchShapes > 0) {
+        return RunShapeBenchmark(benchShapes, frames, seed, outputFile);
+    }
+    if(benchPicks > 0) {
+        return RunPickBenchmark(benchPicks, picks, seed);
+    }
+    if(benchMatches > 0) {
+        return RunMatchBenchmark(benchMatches, picks, seed);
+    }
+    if(benchLevels > 0) {
+        return RunLevelBenchmark(benchLevels, frames, seed);
+    }
+
+    HeadlessBackend* backend = new HeadlessBackend(GUI::WINDOW_WIDTH, GUI::WINDOW_HEIGHT);
+    ApplicationManager app(backend);
+    app.SetPartialRedraw(!fullRedraw);
+    app.GetGrid()->SetCommandBuffer(!immediate);
+    app.SetAutoMatch(!manualMatch);
+    srand(seed);
+    app.GetGrid()->SetLevel(level);
+    app.UpdateDisplay();
+
+    // Each frame runs one scripted move, selects the newest shape,
+    // tries a match every few moves and redraws the screen. The redraw
+    // check compares every frame against a full redraw, outside the timing
+    int mismatches = 0;
+    double seconds = 0;
+    for(int frame = 0; frame < frames; frame++) {
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        app.ExecuteOperation(SCRIPT[frame % SCRIPT_LENGTH]);
+        app.HandleMouseClick(Point(300, 300));
+        if(frame % 5 == 4) {
+            app.HandleKeyPress(' ');
+        }
+        app.UpdateDisplay();
+        seconds += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        if(checkRedraw) {
+            uint64_t partial = backend->Checksum();
+            app.InvalidateDisplay();
+            app.UpdateDisplay();
+            if(backend->Checksum() != partial) mismatches++;
+        }
+    }
+
+    cout << frames << " frames in " << seconds * 1000.0 << " ms";
+    if(frames > 0) {
+        cout << " (" << seconds * 1e6 / frames << " us/frame)";
+    }
+    cout << endl;
+    cout << backend->GetPrimitiveCount() << " primitives drawn, "
+         << backend->GetStateChangeCount() << " pen and brush changes" << endl;
+    if(!immediate) {
+        const CommandBuffer& commands = app.GetGrid()->GetCommands();
+        cout << commands.GetCommandCount() << " commands in " << commands.GetLayerCount()
+             << " layers on the last frame" << endl;
+    }
+    cout << "Level " << app.GetGrid()->GetLevel() << ", score " << app.GetGrid()->GetScore()
+         << ", lives " << app.GetGrid()->GetLives() << endl;
+    cout << "Framebuffer checksum " << hex << backend->Checksum() << dec << endl;
+    if(checkRedraw) {
+        cout << mismatches << " of " << frames << " frames differ from a full redraw" << endl;
+    }
+
+    if(!outputFile.empty() && !backend->SavePPM(outputFile)) {
+        cerr << "Error writing " << outputFile << endl;
+        return 1;
+    }
+    return mismatches == 0 ? 0 : 1;
+}
@@ -61,6 +61,7 @@ void OperRotate::Act() {
     Shape* selected = appManager->GetGrid()->GetSelectedShape();
     if(selected) {
         selected->Rotate();
+        appManager->GetGrid()->UpdateShape(selected);
     }
 }
 
@@ -71,6 +72,7 @@ void OperResizeUp::Act() {
     Shape* selected = appManager->GetGrid()->GetSelectedShape();
     if(selected) {
         selected->ResizeUp();
+        appManager->GetGrid()->UpdateShape(selected);
     }
 }
 
@@ -81,6 +83,7 @@ void OperResizeDown::Act() {
     Shape* selected = appManager->GetGrid()->GetSelectedShape();
     if(selected) {
         selected->ResizeDown();
+        appManager->GetGrid()->UpdateShape(selected);
     }
 }
 
@@ -91,6 +94,7 @@ void OperFlip::Act() {
     Shape* selected = appManager->GetGrid()->GetSelectedShape();
     if(selected) {
         selected->Flip();
+        appManager->GetGrid()->UpdateShape(selected);
     }
 }
 
@@ -0,0 +1,124 @@
+#include "Primitive.h"
+#include <new>
+
+using namespace std;
+
+// Constructors
+Primitive::Primitive() : type(EMPTY) {
+}
+
+Primitive::Primitive(const Primitive& other) : type(EMPTY) {
+    Assign(other);
+}
+
+Primitive& Primitive::operator=(const Primitive& other) {
+    if(this != &other) {
+        Reset();
+        Assign(other);
+    }
+    return *this;
+}
+
+// Destructor
+Primitive::~Primitive() {
+    Reset();
+}
+
+// Destroy the held shape
+void Primitive::Reset() {
+    switch(type) {
+        case RECTANGLE: rectangle.~Rectangle(); break;
+        case CIRCLE: circle.~Circle(); break;
+        case TRIANGLE: triangle.~Triangle(); break;
+        default: break;
+    }
+    type = EMPTY;
+}
+
+// Copy the shape another primitive holds, this one has to be empty
+void Primitive::Assign(const Primitive& other) {
+    switch(other.type) {
+        case RECTANGLE: Set(other.rectangle); break;
+        case CIRCLE: Set(other.circle); break;
+        case TRIANGLE: Set(other.triangle); break;
+        default: break;
+    }
+}
+
+// Store a copy of a shape
+void Primitive::Set(const Rectangle& shape) {
+    Reset();
+    new (&rectangle) Rectangle(shape);
+    type = RECTANGLE;
+}
+
+void Primitive::Set(const Circle& shape) {
+    Reset();
+    new (&circle) Circle(shape);
+    type = CIRCLE;
+}
+
+void Primitive::Set(const Triangle& shape) {
+    Reset();
+    new (&triangle) Triangle(shape);
+    type = TRIANGLE;
+}
+
+// The held shape, null when empty
+Shape* Primitive::Get() {
+    switch(type) {
+        case RECTANGLE: return &rectangle;
+        case CIRCLE: return &circle;
+        case TRIANGLE: return &triangle;
+        default: return nullptr;
+    }
+}
+
+const Shape* Primitive::Get() const {
+    switch(type) {
+        case RECTANGLE: return &rectangle;
+        case CIRCLE: return &circle;
+        case TRIANGLE: return &triangle;
+        default: return nullptr;
+    }
+}
+
+// Draw the held shape, placed by the parent's transform in the current colors
+void Primitive::Draw(GUI* pGUI, const Transform& parent) const {
+    switch(type) {
+        case RECTANGLE: rectangle.Draw(pGUI, parent); break;
+        case CIRCLE: circle.Draw(pGUI, parent); break;
+        case TRIANGLE: triangle.Draw(pGUI, parent); break;
+        default: break;
+    }
+}
+
+// Match only a primitive holding the same kind of shape
+bool Primitive::Match(const Primitive& other) const {
+    if(type != other.type) return false;
+    switch(type) {
+        case RECTANGLE: return rectangle.Match(&other.rectangle);
+        case CIRCLE: return circle.Match(&other.circle);
+        case TRIANGLE: return triangle.Match(&other.triangle);
+        default: return false;
+    }
+}
+
+// Geometry in the parent's frame
+BoundingBox Primitive::GetBounds(const Transform& parent) const {
+    switch(type) {
+        case RECTANGLE: return rectangle.GetBounds(parent);
+        case CIRCLE: return circle.GetBounds(parent);
+        case TRIANGLE: return triangle.GetBounds(parent);
+        default: return BoundingBox();
+    }
+}
+
+bool Primitive::IsPointInside(const Transform& parent, Point p) const {
+    switch(type) {
+        case RECTANGLE: return rectangle.IsPointInside(parent, p);
+        case CIRCLE: return circle.IsPointInside(parent, p);
+        case TRIANGLE: return triangle.IsPointInside(parent, p);
+        default: return false;
+    }
+}
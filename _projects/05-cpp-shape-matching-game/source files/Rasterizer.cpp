@@ -0,0 +1,390 @@
+#include "Rasterizer.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cmath>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define RASTER_X86 1
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+// Constructor
+Rasterizer::Rasterizer(uint32_t* p, int w, int h) : pixels(p), width(w), height(h) {
+    ResetClip();
+    useSIMD = true;
+#ifdef RASTER_X86
+    hasAVX2 = __builtin_cpu_supports("avx2");
+#else
+    hasAVX2 = false;
+#endif
+}
+
+// Set the clip rectangle, an empty one hides everything
+void Rasterizer::SetClip(int x1, int y1, int x2, int y2) {
+    clipLeft = max(x1, 0);
+    clipTop = max(y1, 0);
+    clipRight = min(x2, width - 1);
+    clipBottom = min(y2, height - 1);
+}
+
+// Clip to the whole buffer
+void Rasterizer::ResetClip() {
+    SetClip(0, 0, width - 1, height - 1);
+}
+
+#ifdef RASTER_X86
+// Store one pixel value over [begin, end), 8 pixels per store. The span is
+// at least 8 long, so the last store ends at end and overlaps the one before
+// it instead of leaving a tail to write one pixel at a time
+__attribute__((target("avx2")))
+void Rasterizer::FillSpanAVX2(uint32_t* begin, uint32_t* end, uint32_t pixel) const {
+    __m256i value = _mm256_set1_epi32((int)pixel);
+    for(; end - begin > 8; begin += 8) {
+        _mm256_storeu_si256((__m256i*)begin, value);
+    }
+    _mm256_storeu_si256((__m256i*)(end - 8), value);
+}
+#else
+void Rasterizer::FillSpanAVX2(uint32_t* begin, uint32_t* end, uint32_t pixel) const {
+    fill(begin, end, pixel);
+}
+#endif
+
+// Store pixel over [begin, end), which is already clipped
+inline void Rasterizer::StoreSpan(uint32_t* begin, uint32_t* end, uint32_t pixel) const {
+    if(end - begin < MIN_VECTOR_SPAN) {
+        while(begin < end) *begin++ = pixel;
+        return;
+    }
+    if(UsesAVX2()) {
+        FillSpanAVX2(begin, end, pixel);
+        return;
+    }
+#ifdef RASTER_X86
+    if(useSIMD) {
+        __m128i value = _mm_set1_epi32((int)pixel);
+        for(; end - begin > 4; begin += 4) {
+            _mm_storeu_si128((__m128i*)begin, value);
+        }
+        _mm_storeu_si128((__m128i*)(end - 4), value);
+        return;
+    }
+#endif
+    while(begin < end) *begin++ = pixel;
+}
+
+// Fill pixels x1..x2 of row y
+void Rasterizer::FillSpan(int y, int x1, int x2, uint32_t pixel) {
+    if((pixel >> 24) == 0 || y < clipTop || y > clipBottom) return;
+    x1 = max(x1, clipLeft);
+    x2 = min(x2, clipRight);
+    if(x1 > x2) return;
+
+    uint32_t* begin = pixels + (size_t)y * width + x1;
+    StoreSpan(begin, begin + (x2 - x1 + 1), pixel);
+}
+
+// Fill the box between two corners, inclusive, clipped once for all rows
+void Rasterizer::FillBox(int x1, int y1, int x2, int y2, uint32_t pixel) {
+    if(x1 > x2) swap(x1, x2);
+    if(y1 > y2) swap(y1, y2);
+    x1 = max(x1, clipLeft);
+    x2 = min(x2, clipRight);
+    y1 = max(y1, clipTop);
+    y2 = min(y2, clipBottom);
+    if((pixel >> 24) == 0 || x1 > x2 || y1 > y2) return;
+
+    uint32_t* begin = pixels + (size_t)y1 * width + x1;
+    for(int y = y1; y <= y2; y++, begin += width) {
+        StoreSpan(begin, begin + (x2 - x1 + 1), pixel);
+    }
+}
+
+// Half width of row dy of a disc, the row covers -h..h with h*h + dy*dy <= r*r
+int Rasterizer::HalfWidth(int radius, int dy) {
+    if(dy > radius) return -1;
+    int64_t limit = (int64_t)radius * radius - (int64_t)dy * dy;
+    int64_t half = (int64_t)sqrt((double)limit);
+    while(half * half > limit) half--;
+    while((half + 1) * (half + 1) <= limit) half++;
+    return (int)half;
+}
+
+// Span table of a radius, built on first use
+const int* Rasterizer::SpanTable(int radius) {
+    if(radius > MAX_CACHED_RADIUS) return nullptr;
+    if((int)spanTables.size() <= radius) spanTables.resize(radius + 1);
+
+    vector<int>& table = spanTables[radius];
+    if(table.empty()) {
+        table.resize(radius + 1);
+        for(int dy = 0; dy <= radius; dy++) {
+            table[dy] = HalfWidth(radius, dy);
+        }
+    }
+    return table.data();
+}
+
+// Rows dy of a disc at y that can land in the clip rectangle
+void Rasterizer::VisibleRows(int y, int radius, int& first, int& last) const {
+    first = max(0, max(clipTop - y, y - clipBottom));
+    last = min(radius, max(y - clipTop, clipBottom - y));
+}
+
+// Fill the disc of pixels within radius of the center
+void Rasterizer::FillCircle(int x, int y, int radius, uint32_t pixel) {
+    if(radius < 0) return;
+    const int* spans = SpanTable(radius);
+    int first, last;
+    VisibleRows(y, radius, first, last);
+    for(int dy = first; dy <= last; dy++) {
+        int half = spans ? spans[dy] : HalfWidth(radius, dy);
+        FillSpan(y - dy, x - half, x + half, pixel);
+        if(dy > 0) FillSpan(y + dy, x - half, x + half, pixel);
+    }
+}
+
+// Fill the pixels between two radii
+void Rasterizer::FillRing(int x, int y, int outer, int inner, uint32_t pixel) {
+    if(inner < 0) {
+        FillCircle(x, y, outer, pixel);
+        return;
+    }
+
+    // The outer table first, so building the inner one can't move it
+    const int* outerSpans = SpanTable(outer);
+    const int* innerSpans = SpanTable(inner);
+    int first, last;
+    VisibleRows(y, outer, first, last);
+    for(int dy = first; dy <= last; dy++) {
+        int outerHalf = outerSpans ? outerSpans[dy] : HalfWidth(outer, dy);
+        int innerHalf = (dy > inner) ? -1 : innerSpans ? innerSpans[dy] : HalfWidth(inner, dy);
+        for(int side = 0; side < (dy > 0 ? 2 : 1); side++) {
+            int row = side ? y + dy : y - dy;
+            if(innerHalf < 0) {
+                FillSpan(row, x - outerHalf, x + outerHalf, pixel);
+            } else {
+                FillSpan(row, x - outerHalf, x - innerHalf - 1, pixel);
+                FillSpan(row, x + innerHalf + 1, x + outerHalf, pixel);
+            }
+        }
+    }
+}
+
+// Largest q with q * b <= a, for b > 0
+static int64_t FloorDivide(int64_t a, int64_t b) {
+    int64_t q = a / b;
+    return (q * b > a) ? q - 1 : q;
+}
+
+// Column an edge crosses each row at, x + part / divisor with 0 <= part <
+// divisor. The edge divides once and the remainder is carried down the rows
+struct EdgeWalk {
+    int64_t x, part, xStep, partStep, divisor;
+
+    // Edge from (ax, ay) down to (bx, by), with ay < by, starting at row y
+    EdgeWalk(int ax, int ay, int bx, int by, int y) {
+        divisor = by - ay;
+        int64_t offset = (int64_t)(bx - ax) * (y - ay);
+        x = FloorDivide(offset, divisor);
+        part = offset - x * divisor;
+        x += ax;
+        xStep = FloorDivide(bx - ax, divisor);
+        partStep = (bx - ax) - xStep * divisor;
+    }
+
+    void Down() {
+        part += partStep;
+        int64_t carry = (part >= divisor);
+        part -= carry * divisor;
+        x += xStep + carry;
+    }
+};
+
+// Fill every pixel on or inside the three edges, one span per row. The rows
+// above the middle vertex lie between the long edge and the upper short edge,
+// the rest between the long edge and the lower one. With an outline, each end
+// of a span moves in past the line drawn over the edge it lies on. The lines
+// are stored after the fill, so what the outline of the other edges would
+// cover near a vertex is simply drawn twice
+void Rasterizer::FillTriangleSpans(int x1, int y1, int x2, int y2, int x3, int y3, uint32_t pixel,
+                                   const LineSpans* outline) {
+    if((pixel >> 24) == 0) return;
+
+    // Sort the vertices down the rows, remembering where each was given.
+    // outline[k] is the edge opposite the vertex given k-th
+    int order[3] = {0, 1, 2};
+    if(y2 < y1) { swap(x1, x2); swap(y1, y2); swap(order[0], order[1]); }
+    if(y3 < y2) { swap(x2, x3); swap(y2, y3); swap(order[1], order[2]); }
+    if(y2 < y1) { swap(x1, x2); swap(y1, y2); swap(order[0], order[1]); }
+
+    // The middle vertex is left of the long edge when this is positive
+    int64_t side = (int64_t)(x3 - x1) * (y2 - y1) - (int64_t)(y3 - y1) * (x2 - x1);
+    if(side == 0) return;
+
+    int left = max(min(x1, min(x2, x3)), clipLeft);
+    int right = min(max(x1, max(x2, x3)), clipRight);
+    int top = max(y1, clipTop);
+    int bottom = min(y3, clipBottom);
+    if(left > right || top > bottom) return;
+
+    // A flat bottom edge leaves the last row to the upper short edge, which
+    // ends there
+    EdgeWalk longEdge(x1, y1, x3, y3, top);
+    for(int band = 0; band < 2; band++) {
+        int bandTop = band ? max(y2, top) : top;
+        int bandBottom = band ? bottom : min(y2 - 1, bottom);
+        if(bandTop > bandBottom) continue;
+        bool lower = band && y2 < y3;
+        EdgeWalk shortEdge = lower ? EdgeWalk(x2, y2, x3, y3, bandTop) : EdgeWalk(x1, y1, x2, y2, bandTop);
+        EdgeWalk& leftEdge = (side > 0) ? shortEdge : longEdge;
+        EdgeWalk& rightEdge = (side > 0) ? longEdge : shortEdge;
+
+        // Left and right columns of the lines over the band's left and right
+        // edges, from the band's first row. A line covers every row of its
+        // edge, so they are indexed without a row check
+        const int* leftLine[2] = {nullptr, nullptr};
+        const int* rightLine[2] = {nullptr, nullptr};
+        if(outline) {
+            const LineSpans& shortLine = outline[lower ? order[0] : order[2]];
+            const LineSpans& longLine = outline[order[1]];
+            const LineSpans& leftSpans = (side > 0) ? shortLine : longLine;
+            const LineSpans& rightSpans = (side > 0) ? longLine : shortLine;
+            leftLine[0] = leftSpans.left.data() + (bandTop - leftSpans.top);
+            leftLine[1] = leftSpans.right.data() + (bandTop - leftSpans.top);
+            rightLine[0] = rightSpans.left.data() + (bandTop - rightSpans.top);
+            rightLine[1] = rightSpans.right.data() + (bandTop - rightSpans.top);
+        }
+
+        uint32_t* row = pixels + (size_t)bandTop * width;
+        for(int i = 0; i <= bandBottom - bandTop; i++, row += width) {
+            int64_t first = max((int64_t)left, leftEdge.x + (leftEdge.part != 0));
+            int64_t last = min((int64_t)right, rightEdge.x);
+            leftEdge.Down();
+            rightEdge.Down();
+
+            if(outline) {
+                if(leftLine[0][i] <= first) first = max(first, (int64_t)leftLine[1][i] + 1);
+                if(rightLine[1][i] >= last) last = min(last, (int64_t)rightLine[0][i] - 1);
+            }
+            if(first <= last) StoreSpan(row + first, row + last + 1, pixel);
+        }
+    }
+}
+
+void Rasterizer::FillTriangle(int x1, int y1, int x2, int y2, int x3, int y3, uint32_t pixel) {
+    FillTriangleSpans(x1, y1, x2, y2, x3, y3, pixel, nullptr);
+}
+
+// Bresenham centre line, recording the column it enters and leaves each row
+// at from the upper end's row down. Bresenham visits every row between the
+// ends, so both are set before they are read. The tables only grow
+void Rasterizer::TraceCentre(int x1, int y1, int x2, int y2) {
+    int firstRow = min(y1, y2);
+    size_t rows = (size_t)(max(y1, y2) - firstRow) + 1;
+    if(lineEnter.size() < rows) {
+        lineEnter.resize(rows);
+        lineLeave.resize(rows);
+    }
+
+    int dx = abs(x2 - x1), dy = -abs(y2 - y1);
+    int sx = (x1 < x2) ? 1 : -1, sy = (y1 < y2) ? 1 : -1;
+    int error = dx + dy;
+    lineEnter[y1 - firstRow] = x1;
+    for(int steps = max(dx, -dy); ; steps--) {
+        lineLeave[y1 - firstRow] = x1;
+        if(steps == 0) break;
+        int e2 = 2 * error;
+        if(e2 >= dy) { error += dy; x1 += sx; }
+        if(e2 <= dx) {
+            error += dx;
+            y1 += sy;
+            lineEnter[y1 - firstRow] = x1;
+        }
+    }
+}
+
+// Row y of a thick line is stamped by centre rows y + half - penWidth + 1 to
+// y + half. The centre line moves one way along x, so their pixels span from
+// where it enters the first of them to where it leaves the last
+inline void Rasterizer::LineRowSpan(int y, int penWidth, int firstRow, int lastRow, int& left, int& right) const {
+    int half = penWidth / 2;
+    int first = max(y + half - penWidth + 1, firstRow) - firstRow;
+    int last = min(y + half, lastRow) - firstRow;
+    left = min(min(lineEnter[first], lineLeave[first]), min(lineEnter[last], lineLeave[last])) - half;
+    right = max(max(lineEnter[first], lineLeave[first]), max(lineEnter[last], lineLeave[last])) - half + penWidth - 1;
+}
+
+// Bresenham line stamped with a square of the pen width, one span per row
+void Rasterizer::DrawLine(int x1, int y1, int x2, int y2, int penWidth, uint32_t pixel) {
+    int half = penWidth / 2;
+    int firstRow = min(y1, y2), lastRow = max(y1, y2);
+    int top = max(firstRow - half, clipTop);
+    int bottom = min(lastRow - half + penWidth - 1, clipBottom);
+    if((pixel >> 24) == 0 || top > bottom) return;
+
+    // The rows are already clipped, so only the columns are
+    TraceCentre(x1, y1, x2, y2);
+    uint32_t* row = pixels + (size_t)top * width;
+    for(int y = top; y <= bottom; y++, row += width) {
+        int left, right;
+        LineRowSpan(y, penWidth, firstRow, lastRow, left, right);
+        left = max(left, clipLeft);
+        right = min(right, clipRight);
+        if(left <= right) StoreSpan(row + left, row + right + 1, pixel);
+    }
+}
+
+// The spans DrawLine would store, kept so a fill can stop short of them
+void Rasterizer::TraceLine(int x1, int y1, int x2, int y2, int penWidth, LineSpans& spans) {
+    int half = penWidth / 2;
+    int firstRow = min(y1, y2), lastRow = max(y1, y2);
+    spans.top = max(firstRow - half, clipTop);
+    spans.bottom = min(lastRow - half + penWidth - 1, clipBottom);
+    if(spans.top > spans.bottom) return;
+
+    TraceCentre(x1, y1, x2, y2);
+    int rows = spans.bottom - spans.top + 1;
+    if(spans.left.size() < (size_t)rows) {
+        spans.left.resize(rows);
+        spans.right.resize(rows);
+    }
+    int* left = spans.left.data();
+    int* right = spans.right.data();
+    for(int i = 0, y = spans.top; i < rows; i++, y++) {
+        LineRowSpan(y, penWidth, firstRow, lastRow, left[i], right[i]);
+    }
+}
+
+// Fill the rows of a traced line, the rows are already clipped so only the columns are
+void Rasterizer::StoreLine(const LineSpans& spans, uint32_t pixel) {
+    const int* left = spans.left.data();
+    const int* right = spans.right.data();
+    int rows = spans.bottom - spans.top + 1, minLeft = clipLeft, maxRight = clipRight;
+    uint32_t* row = pixels + (size_t)spans.top * width;
+    for(int i = 0; i < rows; i++, row += width) {
+        int first = max(left[i], minLeft), last = min(right[i], maxRight);
+        if(first <= last) StoreSpan(row + first, row + last + 1, pixel);
+    }
+}
+
+// The edges are traced first so the fill knows where they will land. Each
+// is kept opposite its vertex and stored in the order DrawLine would draw it.
+// Only a line at least a pixel wide covers every row of its edge
+void Rasterizer::DrawTriangle(int x1, int y1, int x2, int y2, int x3, int y3, int penWidth,
+                              uint32_t pen, uint32_t fill) {
+    bool outlined = (pen >> 24) != 0;
+    if(outlined) {
+        TraceLine(x1, y1, x2, y2, penWidth, edgeSpans[2]);
+        TraceLine(x2, y2, x3, y3, penWidth, edgeSpans[0]);
+        TraceLine(x3, y3, x1, y1, penWidth, edgeSpans[1]);
+    }
+    FillTriangleSpans(x1, y1, x2, y2, x3, y3, fill, (outlined && penWidth > 0) ? edgeSpans : nullptr);
+    if(outlined) {
+        StoreLine(edgeSpans[2], pen);
+        StoreLine(edgeSpans[0], pen);
+        StoreLine(edgeSpans[1], pen);
+    }
+}
@@ -1,4 +1,5 @@
 #include "Rectangle.h"
+#include "GUI.h"
 #include <algorithm>
 
 using namespace std;
@@ -6,91 +7,89 @@ using namespace std;
 // Constructor
 Rectangle::Rectangle(Point ref, int w, int h, ShapeColor fill, ShapeColor outline)
     : Shape(ref, fill, outline), width(w), height(h) {
+    UpdateSignature();
 }
 
 // Destructor
 Rectangle::~Rectangle() {
 }
 
+// Drawn corners in the parent's frame. The rectangle turns and mirrors
+// about its center, which keeps it axis-aligned
+void Rectangle::CalculateCorners(const Transform& parent, Point& topLeft, Point& bottomRight) const {
+    int w = transform.ScaleLength(width);
+    int h = transform.ScaleLength(height);
+    Point center(transform.origin.x + w / 2, transform.origin.y + h / 2);
+    Point a = PlacePoint(parent, center, Point(-(w / 2), -(h / 2)));
+    Point b = PlacePoint(parent, center, Point(w - w / 2, h - h / 2));
+    topLeft = Point(min(a.x, b.x), min(a.y, b.y));
+    bottomRight = Point(max(a.x, b.x), max(a.y, b.y));
+}
+
 // Draw rectangle
 void Rectangle::Draw(GUI* pGUI) const {
     pGUI->SetPenColor(GetColorValue(outlineColor));
     pGUI->SetBrushColor(GetColorValue(fillColor));
+    Draw(pGUI, Transform());
+}
 
-    // Calculate actual corner positions considering rotation and flip
-    Point topLeft = refPoint;
-    Point topRight = Point(refPoint.x + width, refPoint.y);
-    Point bottomRight = Point(refPoint.x + width, refPoint.y + height);
-    Point bottomLeft = Point(refPoint.x, refPoint.y + height);
-
-    // Apply flip if necessary
-    if(isFlipped) {
-        topLeft.y = refPoint.y + height;
-        topRight.y = refPoint.y + height;
-        bottomLeft.y = refPoint.y;
-        bottomRight.y = refPoint.y;
-    }
-
-    // Apply rotation
-    Point center = Point(refPoint.x + width/2, refPoint.y + height/2);
-    topLeft = RotatePoint(topLeft, center, rotationCount);
-    topRight = RotatePoint(topRight, center, rotationCount);
-    bottomRight = RotatePoint(bottomRight, center, rotationCount);
-    bottomLeft = RotatePoint(bottomLeft, center, rotationCount);
+// Geometry only, the composite sets its own colors first
+void Rectangle::Draw(GUI* pGUI, const Transform& parent) const {
+    Point topLeft, bottomRight;
+    CalculateCorners(parent, topLeft, bottomRight);
 
     // Draw filled rectangle
     pGUI->DrawRectangle(topLeft, bottomRight, FILLED);
 }
 
-// Rotate rectangle by 90 degrees clockwise
-void Rectangle::Rotate() {
-    rotationCount = (rotationCount + 1) % 4;
-    // For rectangle, also swap width and height for odd rotations
-    if(rotationCount % 2 == 1) {
-        swap(width, height);
-    }
+// Box between the drawn corners
+BoundingBox Rectangle::GetBounds() const {
+    return GetBounds(Transform());
 }
 
-// Resize up (double size)
-void Rectangle::ResizeUp() {
-    width *= 2;
-    height *= 2;
-    resizeCount++;
+BoundingBox Rectangle::GetBounds(const Transform& parent) const {
+    Point topLeft, bottomRight;
+    CalculateCorners(parent, topLeft, bottomRight);
+    return BoundingBox(topLeft.x, topLeft.y, bottomRight.x, bottomRight.y);
 }
 
-// Resize down (half size)
-void Rectangle::ResizeDown() {
-    width = max(5, width / 2); // Minimum size of 5
-    height = max(5, height / 2);
-    resizeCount--;
+// Point between the drawn corners, edges included
+bool Rectangle::IsPointInside(Point p) const {
+    return GetBounds().Contains(p);
 }
 
-// Vertical flip
-void Rectangle::Flip() {
-    isFlipped = !isFlipped;
+bool Rectangle::IsPointInside(const Transform& parent, Point p) const {
+    return GetBounds(parent).Contains(p);
 }
 
 // Check if this rectangle matches another shape
 bool Rectangle::Match(const Shape* other) const {
-    const Rectangle* otherRect = dynamic_cast<const Rectangle*>(other);
-    if(!otherRect) return false;
+    if(!other || other->GetShapeType() != GetShapeType()) return false;
+    const Rectangle* otherRect = static_cast<const Rectangle*>(other);
 
     // Match if same dimensions (considering rotation) and colors
-    bool sizeMatch = (width == otherRect->width && height == otherRect->height) ||
-                     (width == otherRect->height && height == otherRect->width);
+    int w = transform.ScaleLength(width), h = transform.ScaleLength(height);
+    int otherW = otherRect->transform.ScaleLength(otherRect->width);
+    int otherH = otherRect->transform.ScaleLength(otherRect->height);
+    bool sizeMatch = (w == otherW && h == otherH) || (w == otherH && h == otherW);
 
     return sizeMatch && 
            fillColor == otherRect->fillColor && 
            outlineColor == otherRect->outlineColor;
 }
 
+// Width and height in either order, so rotating keeps the signature
+uint64_t Rectangle::ComputeSignature() const {
+    int w = transform.ScaleLength(width), h = transform.ScaleLength(height);
+    uint64_t sig = MixSignature(GetShapeType(), min(w, h));
+    sig = MixSignature(sig, max(w, h));
+    sig = MixSignature(sig, fillColor);
+    return MixSignature(sig, outlineColor);
+}
+
 // Clone this rectangle
 Shape* Rectangle::Clone() const {
-    Rectangle* clone = new Rectangle(refPoint, width, height, fillColor, outlineColor);
-    clone->rotationCount = rotationCount;
-    clone->resizeCount = resizeCount;
-    clone->isFlipped = isFlipped;
-    return clone;
+    return new Rectangle(*this);
 }
 
 // Save rectangle data
@@ -104,4 +103,5 @@ void Rectangle::Save(ofstream& outFile) const {
 void Rectangle::Load(ifstream& inFile) {
     Shape::Load(inFile);
     inFile >> width >> height;
+    UpdateSignature();
 }
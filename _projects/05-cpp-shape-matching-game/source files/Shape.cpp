@@ -1,12 +1,12 @@
 #include "Shape.h"
 #include <cmath>
+#include <algorithm>
 
 using namespace std;
 
 // Constructor
 Shape::Shape(Point ref, ShapeColor fill, ShapeColor outline) 
-    : refPoint(ref), fillColor(fill), outlineColor(outline), 
-      rotationCount(0), resizeCount(0), isFlipped(false) {
+    : transform(ref), fillColor(fill), outlineColor(outline), signature(0) {
 }
 
 // Destructor
@@ -15,18 +15,29 @@ Shape::~Shape() {
 
 // Save function - saves common shape data
 void Shape::Save(ofstream& outFile) const {
-    outFile << refPoint.x << " " << refPoint.y << " " 
-            << rotationCount << " " << resizeCount << " " 
+    outFile << transform.origin.x << " " << transform.origin.y << " " 
+            << (int)transform.orientation << " " << (int)transform.scale << " " 
             << (int)fillColor << " " << (int)outlineColor << " ";
 }
 
 // Load function - loads common shape data
 void Shape::Load(ifstream& inFile) {
-    int fillCol, outlineCol;
-    inFile >> refPoint.x >> refPoint.y >> rotationCount >> resizeCount 
+    int orientation, scale, fillCol, outlineCol;
+    inFile >> transform.origin.x >> transform.origin.y >> orientation >> scale 
            >> fillCol >> outlineCol;
+    transform.orientation = orientation & 7;
+    transform.scale = max((int)Transform::MIN_SCALE, min((int)Transform::MAX_SCALE, scale));
     fillColor = (ShapeColor)fillCol;
     outlineColor = (ShapeColor)outlineCol;
+    UpdateSignature();
+}
+
+// Fold a value into a signature (splitmix64 finalizer)
+uint64_t Shape::MixSignature(uint64_t seed, uint64_t value) {
+    uint64_t h = seed ^ (value + 0x9E3779B97F4A7C15ULL + (seed << 6) + (seed >> 2));
+    h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    h = (h ^ (h >> 27)) * 0x94D049BB133111EBULL;
+    return h ^ (h >> 31);
 }
 
 // Convert ShapeColor enum to CMU graphics color
@@ -44,31 +55,40 @@ color Shape::GetColorValue(ShapeColor c) const {
     }
 }
 
-// Rotate point around center by specified number of 90-degree increments
-Point Shape::RotatePoint(Point p, Point center, int rotations) const {
-    Point result = p;
-    rotations = rotations % 4; // Normalize to 0-3
+// Rotate by 90 degrees clockwise
+void Shape::Rotate() {
+    transform.Rotate();
+}
 
-    for(int i = 0; i < rotations; i++) {
-        int newX = center.x - (result.y - center.y);
-        int newY = center.y + (result.x - center.x);
-        result.x = newX;
-        result.y = newY;
-    }
+// Double the size, up to the largest scale
+void Shape::ResizeUp() {
+    if(transform.ResizeUp()) UpdateSignature();
+}
+
+// Halve the size, down to the smallest scale
+void Shape::ResizeDown() {
+    if(transform.ResizeDown()) UpdateSignature();
+}
+
+// Vertical flip
+void Shape::Flip() {
+    transform.Flip();
+}
 
-    return result;
+// Orient an offset about a center, then map it into the parent
+Point Shape::PlacePoint(const Transform& parent, Point center, Point offset) const {
+    Point v = transform.Orient(offset);
+    return parent.Apply(Point(center.x + v.x, center.y + v.y));
 }
 
 // Move shape by dx, dy
 void Shape::Move(int dx, int dy) {
-    refPoint.x += dx;
-    refPoint.y += dy;
+    transform.origin.x += dx;
+    transform.origin.y += dy;
 }
 
 // Check if point is inside shape (basic implementation)
 bool Shape::IsPointInside(Point p) const {
-    // Basic distance check - can be overridden in derived classes
-    int dx = p.x - refPoint.x;
-    int dy = p.y - refPoint.y;
-    return (dx*dx + dy*dy) <= 2500; // 50 pixel radius
+    // Bounding box check - derived classes test their exact geometry
+    return GetBounds().Contains(p);
 }
@@ -0,0 +1,43 @@
+#include "ShapePool.h"
+
+using namespace std;
+
+// Destructor
+ShapePool::~ShapePool() {
+    for(Slot* block : blocks) {
+        delete[] block;
+    }
+}
+
+// Take a free slot, adding a block when there is none
+void* ShapePool::Allocate() {
+    if(freeSlots.empty()) {
+        Slot* block = new Slot[SLOTS_PER_BLOCK];
+        blocks.push_back(block);
+        freeSlots.reserve(blocks.size() * SLOTS_PER_BLOCK);
+        for(int i = SLOTS_PER_BLOCK - 1; i >= 0; i--) {
+            freeSlots.push_back(block + i);
+        }
+    }
+    Slot* slot = freeSlots.back();
+    freeSlots.pop_back();
+    return slot;
+}
+
+// Destroy a shape and put its slot back
+void ShapePool::Release(Shape* shape) {
+    if(!shape) return;
+    shape->~Shape();
+    freeSlots.push_back(reinterpret_cast<Slot*>(shape));
+}
+
+// Check the address against every block
+bool ShapePool::Owns(const Shape* shape) const {
+    const Slot* slot = reinterpret_cast<const Slot*>(shape);
+    for(const Slot* block : blocks) {
+        if(slot >= block && slot < block + SLOTS_PER_BLOCK) {
+            return true;
+        }
+    }
+    return false;
+}
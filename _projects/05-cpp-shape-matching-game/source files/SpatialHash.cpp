@@ -0,0 +1,101 @@
+#include "SpatialHash.h"
+#include <algorithm>
+
+using namespace std;
+
+// Constructor
+SpatialHash::SpatialHash(int w, int h, int size)
+    : width(w), height(h), cellSize(size),
+      columns((w + size - 1) / size), rows((h + size - 1) / size) {
+    cells.resize((size_t)columns * rows);
+    for(vector<Entry>& cell : cells) {
+        cell.reserve(CELL_RESERVE);
+    }
+}
+
+// Cells covered by a shape's bounds, empty when it is outside the window
+BoundingBox SpatialHash::CellRange(const Shape* shape) const {
+    BoundingBox box = shape->GetBounds().Clipped(BoundingBox(0, 0, width - 1, height - 1));
+    if(box.IsEmpty()) return box;
+    return BoundingBox(box.left / cellSize, box.top / cellSize, box.right / cellSize, box.bottom / cellSize);
+}
+
+// Whether a shape is in this index, its position is only kept by the index holding it
+bool SpatialHash::Holds(const Shape* shape) const {
+    int position = shape->filing.indexPosition;
+    return position >= 0 && position < (int)shapes.size() && shapes[position] == shape;
+}
+
+// Add a shape to every cell it covers, keeping each cell sorted by rank
+void SpatialHash::Place(Shape* shape, long long rank) {
+    Shape::Filing& filing = shape->filing;
+    filing.indexCells = CellRange(shape);
+    filing.indexRank = rank;
+
+    Entry entry = {shape, rank};
+    const BoundingBox& range = filing.indexCells;
+    for(int y = range.top; y <= range.bottom; y++) {
+        for(int x = range.left; x <= range.right; x++) {
+            vector<Entry>& cell = cells[(size_t)y * columns + x];
+            auto it = upper_bound(cell.begin(), cell.end(), entry,
+                                  [](const Entry& a, const Entry& b) { return a.rank < b.rank; });
+            cell.insert(it, entry);
+        }
+    }
+}
+
+// Take a shape out of the cells it was placed in
+void SpatialHash::Unplace(const Shape* shape) {
+    const BoundingBox& range = shape->filing.indexCells;
+    for(int y = range.top; y <= range.bottom; y++) {
+        for(int x = range.left; x <= range.right; x++) {
+            vector<Entry>& cell = cells[(size_t)y * columns + x];
+            for(auto it = cell.begin(); it != cell.end(); ++it) {
+                if(it->shape == shape) {
+                    cell.erase(it);
+                    break;
+                }
+            }
+        }
+    }
+}
+
+// Shape management
+void SpatialHash::Insert(Shape* shape, long long rank) {
+    if(!shape) return;
+    Remove(shape);
+    shape->filing.indexPosition = (int)shapes.size();
+    shapes.push_back(shape);
+    Place(shape, rank);
+}
+
+// The last shape in the list takes the removed one's position
+void SpatialHash::Remove(const Shape* shape) {
+    if(!Holds(shape)) return;
+    Unplace(shape);
+
+    int position = shape->filing.indexPosition;
+    shapes[position] = shapes.back();
+    shapes[position]->filing.indexPosition = position;
+    shapes.pop_back();
+    shape->filing.indexPosition = -1;
+}
+
+// Move a transformed shape to the cells its new bounds cover
+void SpatialHash::Update(Shape* shape) {
+    if(!Holds(shape)) return;
+    if(CellRange(shape) == shape->filing.indexCells) return;
+
+    Unplace(shape);
+    Place(shape, shape->filing.indexRank);
+}
+
+void SpatialHash::Clear() {
+    for(vector<Entry>& cell : cells) {
+        cell.clear();
+    }
+    for(const Shape* shape : shapes) {
+        shape->filing.indexPosition = -1;
+    }
+    shapes.clear();
+}
@@ -0,0 +1,62 @@
+#include "Transform.h"
+
+// Matrix of each orientation as {xx, xy, yx, yy}: x' = xx*x + xy*y and
+// y' = yx*x + yy*y. A quarter turn clockwise on screen maps (x, y) to (-y, x)
+static constexpr int ORIENTATION_MATRIX[8][4] = {
+    { 1,  0,  0,  1}, { 0, -1,  1,  0}, {-1,  0,  0, -1}, { 0,  1, -1,  0},
+    { 1,  0,  0, -1}, { 0,  1,  1,  0}, {-1,  0,  0,  1}, { 0, -1, -1,  0}
+};
+
+// ORIENTATION_PRODUCT[a][b] applies b first, then a
+static constexpr unsigned char ORIENTATION_PRODUCT[8][8] = {
+    {0, 1, 2, 3, 4, 5, 6, 7},
+    {1, 2, 3, 0, 5, 6, 7, 4},
+    {2, 3, 0, 1, 6, 7, 4, 5},
+    {3, 0, 1, 2, 7, 4, 5, 6},
+    {4, 7, 6, 5, 0, 3, 2, 1},
+    {5, 4, 7, 6, 1, 0, 3, 2},
+    {6, 5, 4, 7, 2, 1, 0, 3},
+    {7, 6, 5, 4, 3, 2, 1, 0}
+};
+
+static const int QUARTER_TURN = 1;
+
+// Operations
+void Transform::Rotate() {
+    orientation = ORIENTATION_PRODUCT[QUARTER_TURN][orientation];
+}
+
+void Transform::Flip() {
+    orientation = ORIENTATION_PRODUCT[MIRROR][orientation];
+}
+
+bool Transform::ResizeUp() {
+    if(scale >= MAX_SCALE) return false;
+    scale++;
+    return true;
+}
+
+bool Transform::ResizeDown() {
+    if(scale <= MIN_SCALE) return false;
+    scale--;
+    return true;
+}
+
+// Apply the orientation to a vector
+Point Transform::Orient(Point v) const {
+    const int* m = ORIENTATION_MATRIX[orientation];
+    return Point(m[0] * v.x + m[1] * v.y, m[2] * v.x + m[3] * v.y);
+}
+
+// Scale a length, halving rounds down like repeated integer halving
+int Transform::ScaleLength(int length) const {
+    if(scale >= 0) return length * (1 << scale);
+    int divisor = 1 << -scale;
+    return length >= 0 ? length / divisor : -((divisor - 1 - length) / divisor);
+}
+
+// Map a point of the local frame into the parent
+Point Transform::Apply(Point local) const {
+    Point v = Orient(Point(ScaleLength(local.x), ScaleLength(local.y)));
+    return Point(origin.x + v.x, origin.y + v.y);
+}
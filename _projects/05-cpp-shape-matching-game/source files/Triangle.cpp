@@ -1,4 +1,5 @@
 #include "Triangle.h"
+#include "GUI.h"
 #include <algorithm>
 #include <cmath>
 
@@ -7,88 +8,100 @@ using namespace std;
 // Constructor
 Triangle::Triangle(Point ref, int side, ShapeColor fill, ShapeColor outline)
     : Shape(ref, fill, outline), sideLength(side) {
+    UpdateSignature();
 }
 
 // Destructor
 Triangle::~Triangle() {
 }
 
-// Calculate triangle points based on reference point and side length
-void Triangle::CalculatePoints(Point& p1, Point& p2, Point& p3) const {
-    // Equilateral triangle with one vertex at refPoint (bottom left)
+// Calculate triangle points in the parent's frame. The triangle turns and
+// mirrors about the center of its box
+void Triangle::CalculatePoints(const Transform& parent, Point& p1, Point& p2, Point& p3) const {
+    // Equilateral triangle with one vertex at the reference point (bottom left)
     // Height of equilateral triangle = side * sqrt(3) / 2
-    int height = (int)(sideLength * 0.866);
+    int side = transform.ScaleLength(sideLength);
+    int height = (int)(side * 0.866);
+    Point center(transform.origin.x + side / 2, transform.origin.y - height / 2);
 
-    p1 = refPoint; // Bottom left
-    p2 = Point(refPoint.x + sideLength, refPoint.y); // Bottom right
-    p3 = Point(refPoint.x + sideLength/2, refPoint.y - height); // Top center
-
-    // Apply flip if necessary
-    if(isFlipped) {
-        p1.y = refPoint.y - height;
-        p2.y = refPoint.y - height;
-        p3.y = refPoint.y;
-    }
-
-    // Apply rotation around center
-    Point center = Point(refPoint.x + sideLength/2, refPoint.y - height/2);
-    p1 = RotatePoint(p1, center, rotationCount);
-    p2 = RotatePoint(p2, center, rotationCount);
-    p3 = RotatePoint(p3, center, rotationCount);
+    p1 = PlacePoint(parent, center, Point(-(side / 2), height / 2));          // Bottom left
+    p2 = PlacePoint(parent, center, Point(side - side / 2, height / 2));      // Bottom right
+    p3 = PlacePoint(parent, center, Point(0, -(height - height / 2)));        // Top center
 }
 
 // Draw triangle
 void Triangle::Draw(GUI* pGUI) const {
     pGUI->SetPenColor(GetColorValue(outlineColor));
     pGUI->SetBrushColor(GetColorValue(fillColor));
+    Draw(pGUI, Transform());
+}
 
+// Geometry only, the composite sets its own colors first
+void Triangle::Draw(GUI* pGUI, const Transform& parent) const {
     Point p1, p2, p3;
-    CalculatePoints(p1, p2, p3);
+    CalculatePoints(parent, p1, p2, p3);
 
     // Draw filled triangle
     pGUI->DrawTriangle(p1, p2, p3, FILLED);
 }
 
-// Rotate triangle by 90 degrees clockwise
-void Triangle::Rotate() {
-    rotationCount = (rotationCount + 1) % 4;
+// Box around the three corners
+BoundingBox Triangle::GetBounds() const {
+    return GetBounds(Transform());
 }
 
-// Resize up (double side length)
-void Triangle::ResizeUp() {
-    sideLength *= 2;
-    resizeCount++;
+BoundingBox Triangle::GetBounds(const Transform& parent) const {
+    Point p1, p2, p3;
+    CalculatePoints(parent, p1, p2, p3);
+    return BoundingBox(min(p1.x, min(p2.x, p3.x)), min(p1.y, min(p2.y, p3.y)),
+                       max(p1.x, max(p2.x, p3.x)), max(p1.y, max(p2.y, p3.y)));
 }
 
-// Resize down (half side length)
-void Triangle::ResizeDown() {
-    sideLength = max(6, sideLength / 2); // Minimum side length of 6
-    resizeCount--;
+// Barycentric test, the point is inside when its three weights have the
+// sign of the whole area or are zero
+bool Triangle::IsPointInside(Point p) const {
+    return IsPointInside(Transform(), p);
 }
 
-// Vertical flip
-void Triangle::Flip() {
-    isFlipped = !isFlipped;
+bool Triangle::IsPointInside(const Transform& parent, Point p) const {
+    Point p1, p2, p3;
+    CalculatePoints(parent, p1, p2, p3);
+
+    long long area = (long long)(p2.x - p1.x) * (p3.y - p1.y) - (long long)(p2.y - p1.y) * (p3.x - p1.x);
+    if(area == 0) return false;
+
+    long long w1 = (long long)(p2.x - p.x) * (p3.y - p.y) - (long long)(p2.y - p.y) * (p3.x - p.x);
+    long long w2 = (long long)(p3.x - p.x) * (p1.y - p.y) - (long long)(p3.y - p.y) * (p1.x - p.x);
+    long long w3 = (long long)(p1.x - p.x) * (p2.y - p.y) - (long long)(p1.y - p.y) * (p2.x - p.x);
+    if(area < 0) {
+        w1 = -w1;
+        w2 = -w2;
+        w3 = -w3;
+    }
+    return w1 >= 0 && w2 >= 0 && w3 >= 0;
 }
 
 // Check if this triangle matches another shape
 bool Triangle::Match(const Shape* other) const {
-    const Triangle* otherTriangle = dynamic_cast<const Triangle*>(other);
-    if(!otherTriangle) return false;
+    if(!other || other->GetShapeType() != GetShapeType()) return false;
+    const Triangle* otherTriangle = static_cast<const Triangle*>(other);
 
     // Match if same side length and colors
-    return sideLength == otherTriangle->sideLength && 
+    return transform.ScaleLength(sideLength) == otherTriangle->transform.ScaleLength(otherTriangle->sideLength) && 
            fillColor == otherTriangle->fillColor && 
            outlineColor == otherTriangle->outlineColor;
 }
 
+// Side length and colors
+uint64_t Triangle::ComputeSignature() const {
+    uint64_t sig = MixSignature(GetShapeType(), transform.ScaleLength(sideLength));
+    sig = MixSignature(sig, fillColor);
+    return MixSignature(sig, outlineColor);
+}
+
 // Clone this triangle
 Shape* Triangle::Clone() const {
-    Triangle* clone = new Triangle(refPoint, sideLength, fillColor, outlineColor);
-    clone->rotationCount = rotationCount;
-    clone->resizeCount = resizeCount;
-    clone->isFlipped = isFlipped;
-    return clone;
+    return new Triangle(*this);
 }
 
 // Save triangle data
@@ -102,4 +115,5 @@ void Triangle::Save(ofstream& outFile) const {
 void Triangle::Load(ifstream& inFile) {
     Shape::Load(inFile);
     inFile >> sideLength;
+    UpdateSignature();
 }
@@ -1,4 +1,5 @@
 #include "ApplicationManager.h"
+#include "CMUBackend.h"
 #include <iostream>
 
 using namespace std;
@@ -6,7 +7,7 @@ using namespace std;
 int main() {
     try {
         // Create application manager and run the game
-        ApplicationManager app;
+        ApplicationManager app(new CMUBackend(GUI::WINDOW_WIDTH, GUI::WINDOW_HEIGHT));
 
         cout << "=== Shape Hunt Game ===" << endl;
         cout << "Welcome to the Shape Hunt Game!" << endl;
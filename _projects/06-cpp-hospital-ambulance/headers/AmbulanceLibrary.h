@@ -0,0 +1,59 @@
+#ifndef AMBULANCE_LIBRARY_H
+#define AMBULANCE_LIBRARY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#define AMB_API __declspec(dllexport)
+#else
+#define AMB_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define AMB_API_VERSION 1
+
+typedef struct amb_simulation amb_simulation;
+
+typedef struct {
+    int32_t ready_sc, ready_nc;
+    int32_t busy_sc, busy_nc;
+    int32_t offline_sc, offline_nc;
+    int32_t ep_waiting, sp_waiting, np_waiting;
+    int32_t ep_not_served;
+    int64_t busy_time;
+} amb_hospital_counters;
+
+typedef struct {
+    const int32_t* pid;
+    const int32_t* finish_time;
+    const int32_t* wait_time;
+    int32_t length;
+} amb_results;
+
+AMB_API int amb_api_version(void);
+
+AMB_API amb_simulation* amb_create(void);
+AMB_API void amb_destroy(amb_simulation* simulation);
+AMB_API const char* amb_last_error(const amb_simulation* simulation);
+
+AMB_API int amb_load_file(amb_simulation* simulation, const char* path);
+AMB_API int amb_load_buffer(amb_simulation* simulation, const char* data, size_t length);
+
+AMB_API int amb_step(amb_simulation* simulation, int ticks);
+AMB_API int amb_run(amb_simulation* simulation);
+AMB_API int amb_is_finished(const amb_simulation* simulation);
+AMB_API int amb_current_time(const amb_simulation* simulation);
+
+AMB_API int amb_hospital_count(const amb_simulation* simulation);
+AMB_API int amb_get_hospital_counters(amb_simulation* simulation, int hospital_id, amb_hospital_counters* counters);
+AMB_API int amb_get_results(amb_simulation* simulation, amb_results* results);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -2,13 +2,30 @@
 #define AMBULANCE_SYSTEM_H
 
 #include "Hospital.h"
+#include "EventJournal.h"
+#include "BatchDispatcher.h"
+#include "DispatchPolicies.h"
+#include "Scenario.h"
+#include "SimulationSnapshot.h"
+#include "TravelProfiles.h"
+#include "StochasticTimes.h"
+#include "TelemetryRecorder.h"
+#include "TerminalViewer.h"
 #include <vector>
 #include <map>
 #include <fstream>
 
-struct RequestCancellation {
-    int cancellationTime;
-    int patientId;
+enum DispatchMode { GREEDY_DISPATCH, OPTIMAL_DISPATCH };
+enum DispatchPolicyType { FIXED_TYPE_POLICY, RESERVE_SC_POLICY, SEVERITY_SP_POLICY, NEAREST_CAR_POLICY };
+enum ForwardPolicyType { NO_FORWARD_POLICY, SHORTEST_QUEUE_FORWARD_POLICY, NEAREST_HOSPITAL_FORWARD_POLICY };
+
+struct SimulationSummary {
+    int hospitalCount;
+    int npCount, spCount, epCount;
+    int totalCars, scCount, ncCount;
+    int epNotServedByHomeHospital;
+    double totalWaitTime, totalBusyTime;
+    int endTime;
 };
 
 class AmbulanceSystem {
@@ -19,6 +36,9 @@ private:
     vector<RequestCancellation> cancellations;
     map<int, vector<Patient*>> requestsByTime;
     map<int, vector<RequestCancellation>> cancellationsByTime;
+    vector<Hospital*> activeHospitals;
+    size_t sortedActive;
+    vector<Hospital*> changedHospitals;
     int currentTime;
     int scSpeed, ncSpeed;
 
@@ -27,23 +47,85 @@ private:
     int epNotServedByHomeHospital;
     double totalWaitTime, totalBusyTime;
     int simulationEndTime;
+    EventJournal* journal;
+    TelemetryRecorder* telemetry;
+    TerminalViewer* viewer;
+    TravelProfiles* travelProfiles;
+    StochasticTimes* stochasticTimes;
+    DispatchMode dispatchMode;
+    BatchDispatcher* batchDispatcher;
+    DispatchPolicyType dispatchPolicy;
+    ForwardPolicyType forwardPolicy;
+
+    template <class Dispatch>
+    void runWithForwarding(bool interactive, Dispatch& dispatch);
+    template <class Dispatch, class Forward>
+    void runLoop(bool interactive, Dispatch& dispatch, Forward& forward);
+    void sortActiveHospitals();
+    void dropIdleHospitals();
+    bool isActiveFinished() const;
+    void sampleTelemetry(int time);
+    void updateEndTime();
 
 public:
     AmbulanceSystem();
     ~AmbulanceSystem();
 
     bool loadFromFile(const string& filename);
+    bool loadFromStream(istream& file);
+    void loadScenario(const Scenario& scenario);
+    void loadScenario(const Scenario& scenario, const vector<int>& scCars, const vector<int>& ncCars);
     void runSimulation(bool interactive = false);
     void saveOutputFile(const string& filename);
+    bool saveColumnarFile(const string& filename);
+    void writeResults(ostream& file);
+    bool enableJournal(const string& filename);
+    bool loadTravelProfiles(const string& filename);
+    void enableStochasticTimes(const StochasticParams& params);
+    bool enableTelemetry(const string& filename, int maxRows = TELEMETRY_DEFAULT_ROWS);
+    void enableViewer(int fps = VIEWER_DEFAULT_FPS, int ticksPerFrame = 1);
+    void setDispatchMode(DispatchMode mode) { dispatchMode = mode; }
+    void setDispatchPolicy(DispatchPolicyType policy) { dispatchPolicy = policy; }
+    void setForwardPolicy(ForwardPolicyType policy) { forwardPolicy = policy; }
+    const BatchDispatcher* getBatchDispatcher() const { return batchDispatcher; }
+    const vector<Patient*>& getPatients() const { return allPatients; }
+    int getCurrentTime() const { return currentTime; }
+    int getEndTime() const { return simulationEndTime; }
+    bool isFinished() const;
+    Hospital* getHospital(int hospitalId) { return hospitals[hospitalId - 1]; }
+    int getHospitalCount() const { return hospitals.size(); }
+
+    void addCancellation(const RequestCancellation& cancellation);
+    bool removeCancellation(int patientId, int time, RequestCancellation& removed);
 
+    void saveSnapshot(SimulationSnapshot& snapshot, const SimulationSnapshot* previous) const;
+    void restoreSnapshot(const SimulationSnapshot& snapshot);
+    bool matchesSnapshot(const SimulationSnapshot& snapshot) const;
+    void spliceSnapshot(const SimulationSnapshot& at, const SimulationSnapshot& final);
+
+    bool step();
     void processTimeStep(int time);
     void handleNewRequests(int time);
     void handleCancellations(int time);
+    void handleActiveCancellations(int time);
     void updateAllHospitals(int time);
     void forwardEPRequest(Patient* patient);
+    void forwardEPRequest(Patient* patient, Hospital* destination);
+
+    template <class Dispatch, class Forward>
+    bool step(Dispatch& dispatch, Forward& forward);
+    template <class Dispatch, class Forward>
+    void processTimeStep(int time, Dispatch& dispatch, Forward& forward);
+    template <class Forward>
+    void handleNewRequests(int time, Forward& forward);
+    template <class Dispatch>
+    void updateAllHospitals(int time, Dispatch& dispatch);
 
     void displayInteractiveStep(int time);
     void calculateStatistics();
+    SimulationSummary getSummary() const;
+    static void writeOutput(ostream& file, const vector<Patient*>& patients,
+                            const SimulationSummary& summary);
 
     PatientType stringToPatientType(const string& typeStr);
     CarType stringToCarType(const string& typeStr);
@@ -52,4 +134,73 @@ public:
     int getDistance(int hospital1, int hospital2);
 };
 
+template <class Dispatch, class Forward>
+bool AmbulanceSystem::step(Dispatch& dispatch, Forward& forward) {
+    if (currentTime > simulationEndTime) return false;
+    processTimeStep(currentTime, dispatch, forward);
+    if (isActiveFinished()) return false;
+    currentTime++;
+    return true;
+}
+
+template <class Dispatch, class Forward>
+void AmbulanceSystem::processTimeStep(int time, Dispatch& dispatch, Forward& forward) {
+    if (journal) journal->beginTick(time);
+    handleNewRequests(time, forward);
+    handleActiveCancellations(time);
+    updateAllHospitals(time, dispatch);
+    if (telemetry) sampleTelemetry(time);
+}
+
+template <class Forward>
+void AmbulanceSystem::handleNewRequests(int time, Forward& forward) {
+    map<int, vector<Patient*>>::iterator requests = requestsByTime.find(time);
+    if (requests == requestsByTime.end()) return;
+
+    for (Patient* patient : requests->second) {
+        Hospital* home = hospitals[patient->nearestHospitalId - 1];
+        if (journal) journal->recordArrival(patient);
+        if (patient->type == EP && forward.shouldForward(*home, patient)) {
+            Hospital* destination = forward.destination(*home, patient);
+            if (destination) {
+                forwardEPRequest(patient, destination);
+                continue;
+            }
+        }
+        home->addPatientRequest(patient);
+    }
+}
+
+template <class Dispatch>
+void AmbulanceSystem::updateAllHospitals(int time, Dispatch& dispatch) {
+    sortActiveHospitals();
+    size_t active = activeHospitals.size();
+
+    if (batchDispatcher) {
+        for (size_t i = 0; i < active; i++) {
+            activeHospitals[i]->updateCars(time);
+        }
+        batchDispatcher->dispatch(time);
+    } else if (Dispatch::CROSS_HOSPITAL) {
+        for (size_t i = 0; i < active; i++) {
+            activeHospitals[i]->updateCars(time);
+        }
+        dispatch.allowBorrowing(false);
+        for (size_t i = 0; i < active; i++) {
+            activeHospitals[i]->processRequests(time, dispatch);
+        }
+        dispatch.allowBorrowing(true);
+        for (size_t i = 0; i < active; i++) {
+            activeHospitals[i]->processRequests(time, dispatch);
+        }
+    } else {
+        for (size_t i = 0; i < active; i++) {
+            activeHospitals[i]->updateCars(time);
+            activeHospitals[i]->processRequests(time, dispatch);
+        }
+    }
+
+    dropIdleHospitals();
+}
+
 #endif
\ No newline at end of file
@@ -0,0 +1,79 @@
+#ifndef BATCH_DISPATCHER_H
+#define BATCH_DISPATCHER_H
+
+#include "Hospital.h"
+#include <vector>
+#include <cstdint>
+
+class BatchDispatcher {
+private:
+    struct Bidder {
+        Patient* patient;
+        int hospital;
+        int arcStart, arcEnd;
+        int car;
+        int64_t value;
+    };
+
+    struct Arc {
+        int group;
+        int64_t value;
+    };
+
+    struct ReverseArc {
+        int bidder;
+        int64_t value;
+    };
+
+    const vector<Hospital*>& hospitals;
+    const vector<vector<int>>& distances;
+    vector<vector<int>> neighbours;
+    vector<int> carBase;
+    vector<Car*> carsByIndex;
+
+    vector<Bidder> bidders;
+    vector<Arc> arcs;
+    vector<int> reverseStart;
+    vector<ReverseArc> reverseArcs;
+    vector<int> groupOf;
+    vector<int> groupStart;
+    vector<int> groupSpeed;
+    vector<int> heap;
+    vector<int64_t> price;
+    vector<int> owner;
+    vector<int> unassigned;
+
+    vector<double> solveMicros;
+    uint64_t totalBids;
+
+    int carIndex(const Car* car) const;
+    void collectReadyCars();
+    void collectWaitingPatients(int currentTime);
+    void buildArcs(Bidder& bidder, int currentTime);
+    void resetAssignments();
+    void siftDown(int group);
+    int bestArc(const Bidder& bidder, int64_t& best, int64_t& second) const;
+    void runAuction(int64_t eps);
+    void buildReverseArcs();
+    int64_t profit(const Bidder& bidder) const;
+    void runReverseAuction(int64_t eps);
+    void applyAssignments(int currentTime);
+
+public:
+    static const int NEIGHBOUR_COUNT = 8;
+    static const int EP_WEIGHT = 3000;
+    static const int SEVERITY_WEIGHT = 100;
+    static const int SP_WEIGHT = 2000;
+    static const int NP_WEIGHT = 1000;
+    static const int MAX_AGE_BONUS = 999;
+    static const int TRAVEL_WEIGHT = 10;
+
+    BatchDispatcher(const vector<Hospital*>& hospitals, const vector<vector<int>>& distances);
+
+    void dispatch(int currentTime);
+
+    const vector<double>& getSolveMicros() const { return solveMicros; }
+    uint64_t getTotalBids() const { return totalBids; }
+};
+
+#endif
@@ -0,0 +1,76 @@
+#ifndef BATCH_RUNNER_H
+#define BATCH_RUNNER_H
+
+#include "AmbulanceSystem.h"
+#include <vector>
+#include <deque>
+#include <string>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+
+struct BatchJob {
+    string inputFile;
+    string outputFile;
+    int64_t cost;
+    int64_t memory;
+
+    bool ok;
+    string error;
+    SimulationSummary summary;
+    int servedCount;
+    double seconds;
+    int worker;
+};
+
+class BatchRunner {
+private:
+    struct WorkerQueue {
+        mutex lock;
+        deque<int> jobs;
+        int64_t remainingCost;
+    };
+
+    vector<BatchJob> jobs;
+    int threadCount;
+    int64_t memoryLimit;
+
+    vector<WorkerQueue*> queues;
+    mutex memoryLock;
+    condition_variable memoryReleased;
+    int64_t memoryInUse;
+    int running;
+    int steals;
+    int admissionWaits;
+    int64_t peakMemory;
+    double wallSeconds;
+
+    bool takeJob(int worker, int& job);
+    void admit(const BatchJob& job);
+    void release(const BatchJob& job);
+    void runJob(BatchJob& job, int worker);
+    void workerLoop(int worker);
+
+public:
+    static const int64_t MEMORY_PER_INPUT_BYTE = 4;
+    static const int64_t MEMORY_PER_JOB = 1 << 20;
+
+    BatchRunner(int threads, int64_t memoryLimit);
+    ~BatchRunner();
+
+    bool addManifest(const string& manifest, const string& outputDirectory);
+    bool addDirectory(const string& directory, const string& outputDirectory);
+    bool addJob(const string& inputFile, const string& outputFile);
+
+    void run();
+    bool writeSummary(const string& filename) const;
+
+    const vector<BatchJob>& getJobs() const { return jobs; }
+    int getFailedCount() const;
+    int getSteals() const { return steals; }
+    int getAdmissionWaits() const { return admissionWaits; }
+    int64_t getPeakMemory() const { return peakMemory; }
+    double getWallSeconds() const { return wallSeconds; }
+};
+
+#endif
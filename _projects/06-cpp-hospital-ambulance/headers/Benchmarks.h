@@ -0,0 +1,13 @@
+#ifndef BENCHMARKS_H
+#define BENCHMARKS_H
+
+#include <string>
+#include <vector>
+using namespace std;
+
+int benchDispatchCommand(const vector<string>& args);
+int benchPoliciesCommand(const vector<string>& args);
+int benchGeoCommand(const vector<string>& args);
+int benchShardsCommand(const vector<string>& args);
+
+#endif
@@ -0,0 +1,77 @@
+#ifndef BINARY_IO_H
+#define BINARY_IO_H
+
+#include <vector>
+#include <cstdint>
+using namespace std;
+
+inline void putVarint(vector<unsigned char>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back((unsigned char)(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back((unsigned char)value);
+}
+
+const int MAX_VARINT_BYTES = 10;
+
+// Writes into space the caller has already sized and returns the byte after it
+inline unsigned char* putVarint(unsigned char* p, uint64_t value) {
+    while (value >= 0x80) {
+        *p++ = (unsigned char)(value | 0x80);
+        value >>= 7;
+    }
+    *p++ = (unsigned char)value;
+    return p;
+}
+
+inline uint64_t getVarint(const unsigned char*& p) {
+    uint64_t value = *p & 0x7f;
+    if (!(*p++ & 0x80)) return value;
+    for (int shift = 7; shift < 64; shift += 7) {
+        uint64_t byte = *p++;
+        value |= (byte & 0x7f) << shift;
+        if (!(byte & 0x80)) break;
+    }
+    return value;
+}
+
+// Bounded form for untrusted input: false if the varint runs past end or is too long.
+inline bool getVarint(const unsigned char*& p, const unsigned char* end, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64 && p < end; shift += 7) {
+        uint64_t byte = *p++;
+        value |= (byte & 0x7f) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+inline uint64_t zigzagEncode(int64_t value) {
+    return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+inline int64_t zigzagDecode(uint64_t value) {
+    return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+inline void putFixed32(vector<unsigned char>& out, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        out.push_back((unsigned char)(value >> (8 * i)));
+    }
+}
+
+inline uint32_t getFixed32(const unsigned char* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+inline void putFixed64(vector<unsigned char>& out, uint64_t value) {
+    putFixed32(out, (uint32_t)value);
+    putFixed32(out, (uint32_t)(value >> 32));
+}
+
+inline uint64_t getFixed64(const unsigned char* p) {
+    return (uint64_t)getFixed32(p) | ((uint64_t)getFixed32(p + 4) << 32);
+}
+
+#endif
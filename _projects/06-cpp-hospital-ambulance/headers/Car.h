@@ -4,7 +4,7 @@
 #include "Patient.h"
 
 enum CarType { NC, SC };
-enum CarStatus { READY, ASSIGNED, LOADED };
+enum CarStatus { READY, ASSIGNED, LOADED, OFFLINE };
 
 class Car {
 public:
@@ -15,11 +15,12 @@ public:
     int hospitalId;
     Patient* currentPatient;
     int remainingDistance;
+    int returnDistance;
     int busyStartTime;
     int totalBusyTime;
 
     Car(int id, CarType t, int sp, int hid);
-    void assignPatient(Patient* p, int currentTime, int distance);
+    void assignPatient(Patient* p, int currentTime, int distance, int backDistance = -1);
     void moveOneStep();
     bool hasReachedDestination() const;
     void pickupPatient(int currentTime);
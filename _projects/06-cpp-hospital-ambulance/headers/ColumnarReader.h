@@ -0,0 +1,59 @@
+#ifndef COLUMNAR_READER_H
+#define COLUMNAR_READER_H
+
+#include "ColumnarWriter.h"
+#include <iostream>
+
+class ColumnarReader {
+private:
+    struct Column {
+        string name;
+        ColumnType type;
+    };
+
+    struct Block {
+        int rows;
+        uint32_t nullColumns;
+        vector<uint64_t> columnOffset;
+        vector<int64_t> minimum;
+        vector<int64_t> maximum;
+    };
+
+    int fd;
+    const unsigned char* data;
+    size_t size;
+    vector<Column> columns;
+    vector<Block> blocks;
+    uint64_t rowCount;
+
+    void unmap();
+
+public:
+    ColumnarReader();
+    ~ColumnarReader();
+
+    bool open(const string& filename);
+    int findColumn(const string& name) const;
+    bool mayContain(int block, int column, int64_t from, int64_t to) const;
+    uint64_t exportCsv(ostream& out, int whereColumn, int64_t from, int64_t to, int& blocksRead) const;
+
+    int64_t value(int block, int column, int row) const {
+        const unsigned char* base = data + blocks[block].columnOffset[column];
+        if (columns[column].type == COLUMN_UINT8) return base[row];
+        return ((const int32_t*)base)[row];
+    }
+    const int32_t* int32Column(int block, int column) const {
+        return (const int32_t*)(data + blocks[block].columnOffset[column]);
+    }
+    const uint8_t* uint8Column(int block, int column) const { return data + blocks[block].columnOffset[column]; }
+    int64_t blockMin(int block, int column) const { return blocks[block].minimum[column]; }
+    int64_t blockMax(int block, int column) const { return blocks[block].maximum[column]; }
+    bool blockHasNulls(int block, int column) const { return (blocks[block].nullColumns >> column) & 1; }
+    int blockRowCount(int block) const { return blocks[block].rows; }
+    int getBlockCount() const { return blocks.size(); }
+    int getColumnCount() const { return columns.size(); }
+    const string& getColumnName(int column) const { return columns[column].name; }
+    uint64_t getRowCount() const { return rowCount; }
+};
+
+#endif
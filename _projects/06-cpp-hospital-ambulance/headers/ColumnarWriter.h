@@ -0,0 +1,80 @@
+#ifndef COLUMNAR_WRITER_H
+#define COLUMNAR_WRITER_H
+
+#include "Patient.h"
+#include <vector>
+#include <string>
+#include <fstream>
+#include <cstdint>
+
+enum ColumnType { COLUMN_INT32 = 1, COLUMN_UINT8 = 2 };
+
+enum ResultColumn {
+    RC_PID,
+    RC_TYPE,
+    RC_SEVERITY,
+    RC_HOME_HOSPITAL,
+    RC_CAR_HOSPITAL,
+    RC_REQUEST_TIME,
+    RC_PICKUP_TIME,
+    RC_FINISH_TIME,
+    RC_WAIT_TIME,
+    RC_FLAGS,
+    RC_COUNT
+};
+
+enum ResultFlag { RF_SERVED = 1, RF_CANCELLED = 2, RF_FORWARDED = 4 };
+
+// A nullable column holds COLUMNAR_NULL where the event didn't happen. Those
+// rows are left out of the block minimum and maximum and set the column's bit
+// in the block's null mask instead
+struct ColumnInfo {
+    const char* name;
+    ColumnType type;
+    bool nullable;
+};
+
+extern const ColumnInfo RESULT_COLUMNS[RC_COUNT];
+
+const uint32_t COLUMNAR_MAGIC = 0x43424d41;
+const uint32_t COLUMNAR_VERSION = 2;
+const int COLUMNAR_BLOCK_ROWS = 65536;
+const int COLUMNAR_ALIGNMENT = 64;
+const int64_t COLUMNAR_NULL = -1;
+const int COLUMNAR_MAX_COLUMNS = 32;
+
+inline int columnWidth(ColumnType type) {
+    return type == COLUMN_INT32 ? 4 : 1;
+}
+
+class ColumnarWriter {
+private:
+    ofstream file;
+    int blockRows;
+    vector<vector<unsigned char>> columns;
+    int rowsInBlock;
+    int64_t minimum[RC_COUNT];
+    int64_t maximum[RC_COUNT];
+    uint32_t nullColumns;
+    uint64_t offset;
+    uint64_t rowCount;
+    vector<unsigned char> directory;
+    uint32_t blockCount;
+
+    void startBlock();
+    void setValue(int column, int64_t value);
+    void flushBlock();
+    void pad(uint64_t alignment);
+
+public:
+    ColumnarWriter(int blockRows = COLUMNAR_BLOCK_ROWS);
+
+    bool open(const string& filename);
+    void append(const Patient* patient);
+    bool close();
+
+    uint64_t getRowCount() const { return rowCount; }
+    uint32_t getBlockCount() const { return blockCount; }
+};
+
+#endif
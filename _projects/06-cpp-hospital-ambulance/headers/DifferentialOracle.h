@@ -0,0 +1,96 @@
+#ifndef DIFFERENTIAL_ORACLE_H
+#define DIFFERENTIAL_ORACLE_H
+
+#include "AmbulanceSystem.h"
+#include <string>
+#include <vector>
+#include <cstdint>
+
+struct Divergence {
+    int time;
+    int hospitalId;
+    int carId;
+    string detail;
+};
+
+class OracleEngine {
+public:
+    virtual ~OracleEngine() {}
+    virtual void load(const Scenario& scenario) = 0;
+    virtual bool step() = 0;
+    virtual AmbulanceSystem& state() = 0;
+};
+
+class ReferenceEngine : public OracleEngine {
+private:
+    AmbulanceSystem system;
+
+public:
+    void load(const Scenario& scenario) { system.loadScenario(scenario); }
+    bool step() { return system.step(); }
+    AmbulanceSystem& state() { return system; }
+};
+
+template <class Dispatch>
+class PolicyEngine : public OracleEngine {
+private:
+    AmbulanceSystem system;
+    Dispatch dispatch;
+    NoForwarding forward;
+
+public:
+    void load(const Scenario& scenario) { system.loadScenario(scenario); }
+    bool step() { return system.step(dispatch, forward); }
+    AmbulanceSystem& state() { return system; }
+};
+
+class RewindEngine : public OracleEngine {
+private:
+    AmbulanceSystem system;
+    FixedTypeDispatch dispatch;
+    NoForwarding forward;
+    SimulationSnapshot checkpoint;
+    int interval;
+
+public:
+    RewindEngine(int interval) : interval(interval) {}
+    void load(const Scenario& scenario);
+    bool step();
+    AmbulanceSystem& state() { return system; }
+};
+
+class DifferentialOracle {
+private:
+    string engineName;
+    int interval;
+    int ticksCompared;
+    int runs;
+
+    static uint64_t mix(uint64_t hash, uint64_t value);
+    static uint64_t carHash(const Car* car);
+    static string describeCar(const Car* car);
+    static string describeQueues(const Hospital* hospital);
+    void locate(AmbulanceSystem& reference, AmbulanceSystem& engine, Divergence& divergence) const;
+    static Scenario removeHospital(const Scenario& scenario, int hospital);
+    template <class T>
+    bool removeChunks(Scenario& current, vector<T> Scenario::*items, Divergence& divergence, int limit);
+    bool reduceCars(Scenario& current, vector<int> Scenario::*cars, Divergence& divergence, int limit);
+
+public:
+    static const int REWIND_INTERVAL = 7;
+
+    DifferentialOracle(const string& engineName, int interval = REWIND_INTERVAL);
+
+    static OracleEngine* createEngine(const string& name, int interval = REWIND_INTERVAL);
+    static uint64_t hospitalHash(const Hospital* hospital);
+    static uint64_t stateHash(AmbulanceSystem& system);
+    static Scenario randomScenario(uint32_t seed);
+
+    bool findDivergence(const Scenario& scenario, Divergence& divergence);
+    Scenario shrink(const Scenario& scenario, Divergence& divergence, int maxRuns);
+
+    int getTicksCompared() const { return ticksCompared; }
+    int getRuns() const { return runs; }
+};
+
+#endif
@@ -0,0 +1,149 @@
+#ifndef DISPATCH_POLICIES_H
+#define DISPATCH_POLICIES_H
+
+#include "Hospital.h"
+#include <vector>
+
+vector<vector<int>> nearestHospitals(const vector<vector<int>>& distances, int count);
+
+struct LocalDispatch {
+    static const bool CROSS_HOSPITAL = false;
+
+    bool serveSPBeforeEP(const Patient*, const Patient*, int) const {
+        return false;
+    }
+
+    void assign(Hospital& hospital, Car* car, Patient* patient, int currentTime) {
+        hospital.assignCarToPatient(car, patient, currentTime);
+    }
+
+    void allowBorrowing(bool) {}
+};
+
+struct FixedTypeDispatch : LocalDispatch {
+    Car* carForEP(Hospital& hospital, const Patient*) {
+        Car* car = hospital.findAvailableCar(NC);
+        return car ? car : hospital.findAvailableCar(SC);
+    }
+
+    Car* carForSP(Hospital& hospital, const Patient*) {
+        return hospital.findAvailableCar(SC);
+    }
+
+    Car* carForNP(Hospital& hospital, const Patient*) {
+        return hospital.findAvailableCar(NC);
+    }
+};
+
+struct ReserveScForEP : FixedTypeDispatch {
+    Car* carForSP(Hospital& hospital, const Patient*) {
+        Car* first = nullptr;
+        for (Car* car : hospital.cars) {
+            if (car->status == READY && car->type == SC) {
+                if (first) return first;
+                first = car;
+            }
+        }
+        return nullptr;
+    }
+};
+
+struct SeverityWeightedSP : FixedTypeDispatch {
+    static const int SP_WAIT_PER_SEVERITY = 5;
+
+    bool serveSPBeforeEP(const Patient* sp, const Patient* ep, int currentTime) const {
+        return (currentTime - sp->requestTime) / SP_WAIT_PER_SEVERITY >= ep->severity;
+    }
+};
+
+class NearestReadyCarAcrossHospitals : public FixedTypeDispatch {
+private:
+    const vector<Hospital*>& hospitals;
+    const vector<vector<int>>& distances;
+    vector<vector<int>> neighbours;
+    bool borrowing;
+
+public:
+    static const bool CROSS_HOSPITAL = true;
+    static const int NEIGHBOUR_COUNT = 8;
+
+    NearestReadyCarAcrossHospitals(const vector<Hospital*>& hospitals, const vector<vector<int>>& distances);
+
+    Car* carForEP(Hospital& hospital, const Patient* patient) {
+        Car* car = FixedTypeDispatch::carForEP(hospital, patient);
+        if (car || !borrowing) return car;
+        for (int n : neighbours[hospital.hospitalId - 1]) {
+            if (n == hospital.hospitalId - 1) continue;
+            car = FixedTypeDispatch::carForEP(*hospitals[n], patient);
+            if (car) return car;
+        }
+        return nullptr;
+    }
+
+    // Cars are only lent once every hospital has served its own queues, and
+    // only to EP patients. Lending for SP and NP, or before the lender was
+    // served, left the lender short when its own requests came in.
+    void allowBorrowing(bool allow) { borrowing = allow; }
+
+    void assign(Hospital& hospital, Car* car, Patient* patient, int currentTime) {
+        int from = car->hospitalId - 1, to = hospital.hospitalId - 1;
+        hospital.assignForeignCar(hospitals[from], car, patient, currentTime,
+                                  distances[from][to], distances[to][from]);
+    }
+};
+
+struct NoForwarding {
+    bool shouldForward(const Hospital&, const Patient*) const {
+        return false;
+    }
+
+    Hospital* destination(const Hospital&, const Patient*) {
+        return nullptr;
+    }
+};
+
+struct ForwardWhenNoReadyCar {
+    bool shouldForward(const Hospital& home, const Patient*) const {
+        for (Car* car : home.cars) {
+            if (car->status == READY) return false;
+        }
+        return true;
+    }
+};
+
+class ShortestEPQueueForwarding : public ForwardWhenNoReadyCar {
+private:
+    const vector<Hospital*>& hospitals;
+    const vector<vector<int>>& distances;
+
+public:
+    ShortestEPQueueForwarding(const vector<Hospital*>& hospitals, const vector<vector<int>>& distances)
+        : hospitals(hospitals), distances(distances) {}
+
+    Hospital* destination(int currentHospitalId) const;
+
+    Hospital* destination(const Hospital& home, const Patient*) const {
+        return destination(home.hospitalId);
+    }
+};
+
+class NearestHospitalForwarding : public ForwardWhenNoReadyCar {
+private:
+    const vector<Hospital*>& hospitals;
+    vector<vector<int>> neighbours;
+
+public:
+    static const int NEIGHBOUR_COUNT = 8;
+
+    NearestHospitalForwarding(const vector<Hospital*>& hospitals, const vector<vector<int>>& distances);
+
+    Hospital* destination(const Hospital& home, const Patient* patient) const {
+        for (int n : neighbours[home.hospitalId - 1]) {
+            if (n == home.hospitalId - 1) continue;
+            if (!shouldForward(*hospitals[n], patient)) return hospitals[n];
+        }
+        return nullptr;
+    }
+};
+
+#endif
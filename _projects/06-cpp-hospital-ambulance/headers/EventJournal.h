@@ -0,0 +1,72 @@
+#ifndef EVENT_JOURNAL_H
+#define EVENT_JOURNAL_H
+
+#include "Patient.h"
+#include <vector>
+#include <fstream>
+#include <cstdint>
+
+class Hospital;
+
+enum JournalEvent {
+    JE_TICK,
+    JE_ARRIVAL,
+    JE_QUEUE_INSERT,
+    JE_ASSIGN,
+    JE_PICKUP,
+    JE_RETURN,
+    JE_CANCEL,
+    JE_EP_FORWARD,
+    JE_END
+};
+
+const uint32_t JOURNAL_MAGIC = 0x4a424d41;
+const uint32_t JOURNAL_INDEX_MAGIC = 0x49424d41;
+const int JOURNAL_VERSION = 1;
+const int JOURNAL_INDEX_INTERVAL = 4096;
+
+struct JournalIndexEntry {
+    int time;
+    int previousTime;
+    uint64_t offset;
+    uint64_t eventCount;
+};
+
+class EventJournal {
+private:
+    ofstream file;
+    vector<unsigned char> buffer;
+    vector<JournalIndexEntry> index;
+    vector<int> carBase;
+    uint64_t flushedBytes;
+    uint64_t eventCount;
+    uint64_t eventsSinceIndex;
+    int currentTime;
+    int writtenTime;
+
+    void startEvent(JournalEvent type);
+    void putCar(int hospitalId, int carId);
+    void flush();
+
+public:
+    EventJournal();
+    ~EventJournal();
+
+    bool open(const string& filename);
+    void writeHeader(int scSpeed, int ncSpeed, const vector<Hospital*>& hospitals,
+                     const vector<Patient*>& patients);
+    void close(int endTime);
+
+    void beginTick(int time);
+    void recordArrival(const Patient* patient);
+    void recordQueueInsert(int hospitalId, const Patient* patient);
+    void recordAssign(int hospitalId, int carId, const Patient* patient);
+    void recordPickup(int hospitalId, int carId);
+    void recordReturn(int hospitalId, int carId);
+    void recordCancel(int hospitalId, int carId);
+    void recordForward(int fromHospitalId, int toHospitalId, const Patient* patient);
+
+    uint64_t getEventCount() const { return eventCount; }
+};
+
+#endif
@@ -0,0 +1,67 @@
+#ifndef FLEET_OPTIMIZER_H
+#define FLEET_OPTIMIZER_H
+
+#include "Scenario.h"
+#include <vector>
+#include <map>
+
+struct ServiceTarget {
+    PatientType type;
+    double percentile;
+    int maxWait;
+};
+
+struct FleetEvaluation {
+    bool feasible;
+    bool aborted;
+    int percentileWait;
+    int misses;
+    int endTime;
+};
+
+// A simulated allocation. peakBusy has the fleet's layout and holds the most
+// cars of each hospital and type that were out at once
+struct FleetRun {
+    FleetEvaluation result;
+    vector<int> peakBusy;
+};
+
+class FleetOptimizer {
+private:
+    const Scenario& scenario;
+    ServiceTarget target;
+    int scCost, ncCost;
+    int threadCount;
+
+    vector<int> watchedPatients;
+    int targetPatients;
+    int allowedMisses;
+
+    map<vector<int>, FleetRun> cache;
+    vector<bool> pruned;
+    int evaluations, cacheHits, reusedRuns, abortedRuns, prunedMoves, rounds;
+
+    FleetEvaluation simulate(const vector<int>& fleet, vector<int>& peakBusy) const;
+    bool sameRun(const vector<int>& fleet, const vector<int>& parent, const FleetRun& run) const;
+    void evaluateAll(const vector<vector<int>>& fleets, const vector<int>& parent,
+                     vector<FleetEvaluation>& results);
+    FleetEvaluation evaluate(const vector<int>& fleet);
+
+public:
+    static const int MAX_SCALE_STEPS = 8;
+
+    FleetOptimizer(const Scenario& scenario, const ServiceTarget& target, int scCost, int ncCost,
+                   int threads);
+
+    bool optimize(vector<int>& scCars, vector<int>& ncCars, FleetEvaluation& result);
+    int cost(const vector<int>& scCars, const vector<int>& ncCars) const;
+
+    int getEvaluations() const { return evaluations; }
+    int getCacheHits() const { return cacheHits; }
+    int getReusedRuns() const { return reusedRuns; }
+    int getAbortedRuns() const { return abortedRuns; }
+    int getPrunedMoves() const { return prunedMoves; }
+    int getRounds() const { return rounds; }
+};
+
+#endif
@@ -0,0 +1,41 @@
+#ifndef GEO_INDEX_H
+#define GEO_INDEX_H
+
+#include <vector>
+using namespace std;
+
+struct GeoPoint {
+    double lat, lon;
+};
+
+class GeoIndex {
+private:
+    struct Node {
+        int axis;
+        double split;
+        int left, right;
+        int leaf;
+    };
+
+    double originLat, originLon, metresPerLon;
+    vector<Node> nodes;
+    vector<double> leafX, leafY;
+    vector<int> leafIds;
+
+    int build(vector<int>& order, const vector<double>& x, const vector<double>& y, int begin, int end);
+    void assignRange(const vector<GeoPoint>& points, vector<int>& nearest, vector<int>& distances,
+                     size_t begin, size_t end) const;
+
+public:
+    static const int LEAF_SIZE = 8;
+    static const int MIN_POINTS_PER_THREAD = 16384;
+
+    GeoIndex(const vector<GeoPoint>& hospitals);
+
+    void project(const GeoPoint& point, double& x, double& y) const;
+    int distance(const GeoPoint& a, const GeoPoint& b) const;
+    int nearest(double x, double y, int& distance) const;
+    void assign(const vector<GeoPoint>& points, vector<int>& nearest, vector<int>& distances, int threads) const;
+};
+
+#endif
@@ -6,6 +6,10 @@
 #include <vector>
 #include <queue>
 
+class EventJournal;
+class TravelProfiles;
+class StochasticTimes;
+
 class Hospital {
 public:
     int hospitalId;
@@ -14,22 +18,96 @@ public:
     queue<Patient*> spQueue;
     queue<Patient*> npQueue;
     int epNotServed;
+    int offlinePending[2];
+    int readyCars[2];
+    // Lowest readyCars has been after a dispatch or taking cars offline, INT_MAX before either
+    int fewestReady[2];
+    int busyCars;
+    vector<Hospital*>* worklist;
+    bool listed;
+    vector<Hospital*>* changeList;
+    bool changed;
+    EventJournal* journal;
+    const TravelProfiles* travel;
+    const StochasticTimes* stochastic;
 
     Hospital(int id);
     ~Hospital();
     void addCar(Car* car);
+    void recountCars();
+    void markActive() {
+        if (worklist && !listed) {
+            listed = true;
+            worklist->push_back(this);
+        }
+    }
+    // Set only while telemetry is on: the hospitals whose counters moved this tick
+    void markChanged() {
+        if (changeList && !changed) {
+            changed = true;
+            changeList->push_back(this);
+        }
+    }
+    bool isIdle() const { return busyCars == 0 && epQueue.empty() && spQueue.empty() && npQueue.empty(); }
     void addPatientRequest(Patient* patient);
     void processRequests(int currentTime);
+    template <class Policy>
+    void processRequests(int currentTime, Policy& policy);
     Car* findAvailableCar(CarType requiredType);
-    void assignCarToPatient(Car* car, Patient* patient, int currentTime);
+    void assignCarToPatient(Car* car, Patient* patient, int currentTime,
+                            int distance = -1, int backDistance = -1);
+    void assignForeignCar(Hospital* carHospital, Car* car, Patient* patient, int currentTime,
+                          int toDistance, int fromDistance);
     void updateCars(int currentTime);
     void handleCancellation(int patientId, int currentTime);
     bool forwardEPRequest(Patient* patient);
     void displayStatus(int currentTime) const;
+    void takeCarsOffline(CarType type, int count);
+    void bringCarsOnline(CarType type, int count);
     int getReadyCarsCount(CarType type) const;
     int getTotalCarsCount(CarType type) const;
     vector<Car*> getOutgoingCars() const;
     vector<Car*> getReturningCars() const;
 };
 
+template <class Policy>
+void Hospital::processRequests(int currentTime, Policy& policy) {
+    bool spBlocked = false;
+    while (!epQueue.empty()) {
+        Patient* patient = epQueue.top();
+        if (!spBlocked && !spQueue.empty() &&
+            policy.serveSPBeforeEP(spQueue.front(), patient, currentTime)) {
+            Car* spCar = policy.carForSP(*this, spQueue.front());
+            if (spCar) {
+                Patient* spPatient = spQueue.front();
+                spQueue.pop();
+                policy.assign(*this, spCar, spPatient, currentTime);
+                continue;
+            }
+            spBlocked = true;
+        }
+
+        Car* car = policy.carForEP(*this, patient);
+        if (!car) break;
+        epQueue.pop();
+        policy.assign(*this, car, patient, currentTime);
+    }
+
+    while (!spBlocked && !spQueue.empty()) {
+        Patient* patient = spQueue.front();
+        Car* car = policy.carForSP(*this, patient);
+        if (!car) break;
+        spQueue.pop();
+        policy.assign(*this, car, patient, currentTime);
+    }
+
+    while (!npQueue.empty()) {
+        Patient* patient = npQueue.front();
+        Car* car = policy.carForNP(*this, patient);
+        if (!car) break;
+        npQueue.pop();
+        policy.assign(*this, car, patient, currentTime);
+    }
+}
+
 #endif
\ No newline at end of file
@@ -0,0 +1,67 @@
+#ifndef JOURNAL_REPLAY_H
+#define JOURNAL_REPLAY_H
+
+#include "EventJournal.h"
+#include "Car.h"
+#include <vector>
+#include <iostream>
+
+class JournalReplay {
+private:
+    vector<unsigned char> data;
+    size_t eventsOffset;
+    size_t eventsEnd;
+    size_t position;
+    vector<JournalIndexEntry> index;
+
+    int scSpeed, ncSpeed;
+    vector<int> carBase;
+    vector<unsigned char> carTypes;
+
+    vector<int> patientPid;
+    vector<unsigned char> patientType;
+    vector<int> patientRequestTime;
+    vector<int> patientHospital;
+    vector<int> patientDistance;
+    vector<int> patientSeverity;
+
+    vector<int> pickupTime;
+    vector<int> finishTime;
+    vector<unsigned char> cancelled;
+    vector<int> queuedAt;
+    vector<unsigned char> carStatus;
+    vector<int> carPatient;
+    vector<int> carBusyStart;
+    vector<long long> carBusyTotal;
+    vector<int> queueLength;
+    vector<int> epForwarded;
+
+    int currentTime;
+    int decodedTime;
+    int endTime;
+    uint64_t eventsApplied;
+    bool corrupt;
+
+    bool parseHeader(const unsigned char* p, const unsigned char* end);
+    bool parseIndex(size_t size);
+    void resetState();
+    uint64_t applyEvents(int untilTime);
+    void printCar(ostream& out, int car) const;
+
+public:
+    JournalReplay();
+
+    bool load(const string& filename);
+    uint64_t replayTo(int time);
+    uint64_t replayAll();
+    void printState(ostream& out) const;
+    bool printEvents(ostream& out, int fromTime, int toTime) const;
+    bool writeOutputFile(const string& filename) const;
+
+    bool isValid() const { return !corrupt; }
+    int getEndTime() const { return endTime; }
+    int getCurrentTime() const { return currentTime; }
+    size_t getIndexSize() const { return index.size(); }
+};
+
+#endif
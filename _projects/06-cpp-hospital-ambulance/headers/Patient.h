@@ -9,12 +9,14 @@ enum PatientType { NP, SP, EP };
 class Patient {
 public:
     int pid;
+    int index;
     PatientType type;
     int requestTime;
     int pickupTime;
     int finishTime;
     int nearestHospitalId;
     int distanceToHospital;
+    int carHospitalId;
     int severity;
     bool cancelled;
     bool served;
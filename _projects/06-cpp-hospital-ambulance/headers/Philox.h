@@ -0,0 +1,70 @@
+#ifndef PHILOX_H
+#define PHILOX_H
+
+#include <cstdint>
+#include <cstddef>
+
+const uint32_t PHILOX_M0 = 0xD2511F53;
+const uint32_t PHILOX_M1 = 0xCD9E8D57;
+const uint32_t PHILOX_W0 = 0x9E3779B9;
+const uint32_t PHILOX_W1 = 0xBB67AE85;
+const int PHILOX_ROUNDS = 10;
+const int PHILOX_LANES = 8;
+
+inline void philoxRound(uint32_t& x0, uint32_t& x1, uint32_t& x2, uint32_t& x3, uint32_t k0, uint32_t k1) {
+    uint64_t p0 = (uint64_t)PHILOX_M0 * x0;
+    uint64_t p1 = (uint64_t)PHILOX_M1 * x2;
+    uint32_t y0 = (uint32_t)(p1 >> 32) ^ x1 ^ k0;
+    uint32_t y2 = (uint32_t)(p0 >> 32) ^ x3 ^ k1;
+    x1 = (uint32_t)p1;
+    x3 = (uint32_t)p0;
+    x0 = y0;
+    x2 = y2;
+}
+
+inline void philox4x32(uint32_t block[4], uint64_t key) {
+    uint32_t k0 = (uint32_t)key, k1 = (uint32_t)(key >> 32);
+    for (int round = 0; round < PHILOX_ROUNDS; round++) {
+        philoxRound(block[0], block[1], block[2], block[3], k0, k1);
+        k0 += PHILOX_W0;
+        k1 += PHILOX_W1;
+    }
+}
+
+inline void philox4x32Batch(const uint32_t* counter0, uint32_t counter1, size_t count, uint64_t key,
+                            uint32_t* out0, uint32_t* out1, uint32_t* out2, uint32_t* out3) {
+    size_t first = 0;
+    for (; first + PHILOX_LANES <= count; first += PHILOX_LANES) {
+        uint32_t x0[PHILOX_LANES], x1[PHILOX_LANES], x2[PHILOX_LANES], x3[PHILOX_LANES];
+        for (int lane = 0; lane < PHILOX_LANES; lane++) {
+            x0[lane] = counter0[first + lane];
+            x1[lane] = counter1;
+            x2[lane] = x3[lane] = 0;
+        }
+        uint32_t k0 = (uint32_t)key, k1 = (uint32_t)(key >> 32);
+        for (int round = 0; round < PHILOX_ROUNDS; round++) {
+            for (int lane = 0; lane < PHILOX_LANES; lane++) {
+                philoxRound(x0[lane], x1[lane], x2[lane], x3[lane], k0, k1);
+            }
+            k0 += PHILOX_W0;
+            k1 += PHILOX_W1;
+        }
+        for (int lane = 0; lane < PHILOX_LANES; lane++) {
+            out0[first + lane] = x0[lane];
+            out1[first + lane] = x1[lane];
+            out2[first + lane] = x2[lane];
+            out3[first + lane] = x3[lane];
+        }
+    }
+
+    for (; first < count; first++) {
+        uint32_t block[4] = {counter0[first], counter1, 0, 0};
+        philox4x32(block, key);
+        out0[first] = block[0];
+        out1[first] = block[1];
+        out2[first] = block[2];
+        out3[first] = block[3];
+    }
+}
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef SCENARIO_H
+#define SCENARIO_H
+
+#include "Patient.h"
+#include <vector>
+#include <iostream>
+
+struct RequestCancellation {
+    int cancellationTime;
+    int patientId;
+};
+
+struct ScenarioRequest {
+    PatientType type;
+    int requestTime;
+    int patientId;
+    int hospitalId;
+    int distance;
+    int severity;
+};
+
+class Scenario {
+private:
+    bool readCars(istream& in, int H);
+    bool readCancellations(istream& in);
+    bool readGeo(istream& in);
+
+public:
+    static constexpr const char* GEO_HEADER = "GEO";
+
+    int scSpeed, ncSpeed;
+    vector<vector<int>> distances;
+    vector<int> scCars, ncCars;
+    vector<ScenarioRequest> requests;
+    vector<RequestCancellation> cancellations;
+
+    Scenario();
+    bool read(istream& in);
+    void write(ostream& out) const;
+    int hospitalCount() const { return distances.size(); }
+
+    static PatientType patientTypeFromString(const string& typeStr);
+};
+
+#endif
@@ -0,0 +1,39 @@
+#ifndef SCENARIO_GENERATOR_H
+#define SCENARIO_GENERATOR_H
+
+#include "GeoIndex.h"
+#include <iostream>
+#include <cstdint>
+using namespace std;
+
+struct ScenarioParams {
+    int hospitals;
+    int scCars;
+    int ncCars;
+    int requests;
+    int cancellations;
+    int horizon;
+    int mapSize;
+    int scSpeed, ncSpeed;
+    uint32_t seed;
+
+    ScenarioParams();
+};
+
+class ScenarioGenerator {
+private:
+    uint64_t state;
+
+    uint32_t next();
+    int uniform(int low, int high);
+    void writeCars(const ScenarioParams& params, ostream& out);
+    void writeCancellations(const ScenarioParams& params, const vector<int>& requestTime, ostream& out);
+
+public:
+    ScenarioGenerator(uint32_t seed);
+    void generate(const ScenarioParams& params, ostream& out);
+    void generateGeo(const ScenarioParams& params, ostream& out);
+    GeoPoint randomLocation(const ScenarioParams& params);
+};
+
+#endif
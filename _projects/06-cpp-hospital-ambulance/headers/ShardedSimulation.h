@@ -0,0 +1,99 @@
+#ifndef SHARDED_SIMULATION_H
+#define SHARDED_SIMULATION_H
+
+#include "AmbulanceSystem.h"
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <pthread.h>
+
+class ShardedSimulation {
+private:
+    struct PatientResult {
+        int pickupTime;
+        int finishTime;
+        char served;
+        char cancelled;
+    };
+
+    struct ShardStats {
+        int endTime;
+        int epNotServed;
+        int64_t busyTime;
+        int forwardsSent;
+        double seconds;
+        double cpuSeconds;
+        int finished;
+    };
+
+    struct Forward {
+        int patient;
+        int destination;
+    };
+
+    struct Arrival {
+        int patient;
+        int destination;
+        Patient* local;
+    };
+
+    const Scenario& scenario;
+    int shardCount;
+    DispatchPolicyType dispatchPolicy;
+    ForwardPolicyType forwardPolicy;
+    string travelProfileFile;
+    bool stochastic;
+    StochasticParams stochasticParams;
+
+    vector<int> regionOf;
+    vector<vector<int>> neighbours;
+    vector<vector<int>> exported;
+    vector<int> syncTicks;
+    vector<int> outboxCapacity;
+    int lastRequestTime;
+    int endLimit;
+    double wallSeconds;
+
+    void* shared;
+    size_t sharedBytes;
+    pthread_barrier_t* barrier;
+    uint8_t* ready;
+    ShardStats* stats;
+    PatientResult* results;
+    vector<int*> outboxCount;
+    vector<Forward*> outbox;
+
+    void partition();
+    void planSynchronization();
+    bool mapSharedMemory();
+    void unmapSharedMemory();
+    template <class Dispatch>
+    void runShard(int shard, Dispatch& dispatch);
+    void runShard(int shard);
+    bool hasReadyCar(AmbulanceSystem& system, int shard, int hospital) const;
+    int forwardDestination(AmbulanceSystem& system, int shard, Patient* patient) const;
+
+public:
+    ShardedSimulation(const Scenario& scenario, int shards, DispatchPolicyType dispatchPolicy,
+                      ForwardPolicyType forwardPolicy, const string& travelProfileFile = "");
+    ~ShardedSimulation();
+
+    static bool supports(DispatchMode mode, DispatchPolicyType dispatchPolicy, ForwardPolicyType forwardPolicy);
+
+    void enableStochasticTimes(const StochasticParams& params) {
+        stochastic = true;
+        stochasticParams = params;
+    }
+    bool run();
+    void writeResults(ostream& file) const;
+
+    int getShardCount() const { return shardCount; }
+    int getSyncTickCount() const { return syncTicks.size(); }
+    int getForwardsSent() const;
+    double getWallSeconds() const { return wallSeconds; }
+    double getMaxShardSeconds() const;
+    double getMeanShardSeconds() const;
+    double getMaxShardCpuSeconds() const;
+};
+
+#endif
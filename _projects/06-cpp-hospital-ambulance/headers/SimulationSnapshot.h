@@ -0,0 +1,54 @@
+#ifndef SIMULATION_SNAPSHOT_H
+#define SIMULATION_SNAPSHOT_H
+
+#include "Hospital.h"
+#include <vector>
+#include <memory>
+
+struct CarState {
+    CarStatus status;
+    Patient* patient;
+    int remainingDistance;
+    int returnDistance;
+    int busyStartTime;
+    int totalBusyTime;
+};
+
+struct PatientState {
+    int pickupTime;
+    int finishTime;
+    int carHospitalId;
+    bool cancelled;
+    bool served;
+};
+
+struct HospitalState {
+    priority_queue<Patient*, vector<Patient*>, EPComparator> epQueue;
+    queue<Patient*> spQueue;
+    queue<Patient*> npQueue;
+    int epNotServed;
+    int offlinePending[2];
+};
+
+class SimulationSnapshot {
+public:
+    static const int CHUNK_SIZE = 1024;
+
+    int time;
+    vector<CarState> cars;
+    vector<HospitalState> hospitals;
+    vector<shared_ptr<const vector<PatientState>>> patientChunks;
+    int sharedChunks;
+};
+
+template <class Queue>
+const typename Queue::container_type& queueContainer(const Queue& queue) {
+    struct Access : Queue {
+        static const typename Queue::container_type& get(const Queue& queue) {
+            return queue.*&Access::c;
+        }
+    };
+    return Access::get(queue);
+}
+
+#endif
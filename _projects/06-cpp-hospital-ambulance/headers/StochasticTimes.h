@@ -0,0 +1,50 @@
+#ifndef STOCHASTIC_TIMES_H
+#define STOCHASTIC_TIMES_H
+
+#include "Patient.h"
+#include <vector>
+#include <cstdint>
+
+struct StochasticParams {
+    uint64_t seed;
+    double travelSpread;
+    int serviceMin;
+    int serviceMax;
+
+    StochasticParams() : seed(0), travelSpread(0.25), serviceMin(1), serviceMax(5) {}
+    bool valid() const;
+};
+
+class StochasticTimes {
+private:
+    struct Draw {
+        uint32_t outbound;
+        uint32_t onScene;
+        uint32_t inbound;
+    };
+
+    StochasticParams params;
+    uint32_t factorLow;
+    uint32_t factorRange;
+    vector<int> pids;
+    vector<Draw> draws;
+
+    Draw draw(const Patient* patient) const;
+    Draw lookup(const Patient* patient) const;
+    int scaleDistance(int distance, uint32_t word) const;
+
+public:
+    static const int FACTOR_BITS = 16;
+    static const int BATCH_SIZE = 256;
+
+    StochasticTimes(const StochasticParams& params);
+
+    void precompute(const vector<Patient*>& patients);
+    int outboundDistance(const Patient* patient, int distance) const;
+    int returnDistance(const Patient* patient, int distance, int speed) const;
+    int serviceTicks(const Patient* patient) const;
+
+    const StochasticParams& getParams() const { return params; }
+};
+
+#endif
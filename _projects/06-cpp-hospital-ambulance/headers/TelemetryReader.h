@@ -0,0 +1,34 @@
+#ifndef TELEMETRY_READER_H
+#define TELEMETRY_READER_H
+
+#include "TelemetryRecorder.h"
+#include <iostream>
+
+class TelemetryReader {
+private:
+    int hospitalCount;
+    int metricCount;
+    int firstTime;
+    int stride;
+    int rows;
+    int lastRowTicks;
+    vector<int32_t> values;
+
+public:
+    TelemetryReader();
+
+    bool load(const string& filename);
+    void exportCsv(ostream& out, int fromTime, int toTime, int hospitalId) const;
+
+    int value(int row, int hospitalId, TelemetryMetric metric) const {
+        return values[((size_t)row * hospitalCount + hospitalId - 1) * metricCount + metric];
+    }
+    int rowTime(int row) const { return firstTime + row * stride; }
+    int getHospitalCount() const { return hospitalCount; }
+    int getRowCount() const { return rows; }
+    int getStride() const { return stride; }
+    int getFirstTime() const { return firstTime; }
+    int getLastTime() const { return rows > 0 ? rowTime(rows - 1) + lastRowTicks - 1 : firstTime; }
+};
+
+#endif
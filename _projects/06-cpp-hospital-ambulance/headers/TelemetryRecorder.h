@@ -0,0 +1,67 @@
+#ifndef TELEMETRY_RECORDER_H
+#define TELEMETRY_RECORDER_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+using namespace std;
+
+class Hospital;
+
+enum TelemetryMetric {
+    TM_EP_QUEUE,
+    TM_SP_QUEUE,
+    TM_NP_QUEUE,
+    TM_READY_SC,
+    TM_READY_NC,
+    TM_IN_FLIGHT,
+    TM_COUNT
+};
+
+const uint32_t TELEMETRY_MAGIC = 0x54424d41;
+const int TELEMETRY_VERSION = 2;
+const int TELEMETRY_DEFAULT_ROWS = 4096;
+
+class TelemetryRecorder {
+private:
+    // One counter that moved during the open row: its value before the row,
+    // its highest (or lowest) value in the row, and its value at the row's end
+    struct Change {
+        int column;
+        int32_t carried;
+        int32_t merged;
+        int32_t last;
+    };
+
+    string filename;
+    int hospitalCount;
+    int maxRows;
+    int firstTime;
+    int stride;
+    int rows;
+    int ticksInRow;
+    vector<int32_t> initial;
+    vector<int32_t> current;
+    // Closed rows are held encoded as they go in the file; only the open row
+    // is a list of changes, found by column through latest.
+    vector<unsigned char> encoded;
+    size_t encodedSize;
+    vector<Change> open;
+    vector<int> latest;
+
+    static int32_t fold(int metric, int32_t a, int32_t b);
+    void closeRow(vector<unsigned char>& out, size_t& size);
+    void downsample();
+
+public:
+    TelemetryRecorder(const string& filename, const vector<Hospital*>& hospitals,
+                      int maxRows = TELEMETRY_DEFAULT_ROWS, int minTicks = 0);
+
+    void sample(int time, const vector<Hospital*>& changed);
+    bool close();
+
+    int getRowCount() const { return rows; }
+    int getStride() const { return stride; }
+};
+
+#endif
@@ -0,0 +1,66 @@
+#ifndef TERMINAL_VIEWER_H
+#define TERMINAL_VIEWER_H
+
+#include <vector>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+using namespace std;
+
+class Hospital;
+
+struct HospitalView {
+    int epQueue, spQueue, npQueue;
+    int readySC, readyNC;
+    int busy;
+    int epNotServed;
+};
+
+struct ViewerFrame {
+    int time;
+    bool finished;
+    vector<HospitalView> hospitals;
+};
+
+const int VIEWER_DEFAULT_FPS = 20;
+const int VIEWER_MAX_TICKS_PER_FRAME = 1 << 20;
+
+class TerminalViewer {
+private:
+    int fps;
+    thread worker;
+
+    mutex lock;
+    condition_variable advance;
+    ViewerFrame latest;
+    bool fresh;
+    int allowedTime;
+    int ticksPerFrame;
+    bool paused;
+    bool detached;
+
+    ViewerFrame shown;
+    vector<string> screen;
+    string jumpInput;
+    bool jumping;
+    string message;
+    bool rawTerminal;
+    bool inputOpen;
+
+    static void capture(ViewerFrame& frame, int time, const vector<Hospital*>& hospitals);
+    void run();
+    void handleKey(char key);
+    void render();
+    vector<string> layout() const;
+
+public:
+    TerminalViewer(int fps = VIEWER_DEFAULT_FPS, int ticksPerFrame = 1);
+    ~TerminalViewer();
+
+    void start();
+    void tickDone(int time, const vector<Hospital*>& hospitals);
+    void finish(int time, const vector<Hospital*>& hospitals);
+};
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef TRAVEL_PROFILES_H
+#define TRAVEL_PROFILES_H
+
+#include <vector>
+#include <iostream>
+#include <cstdint>
+using namespace std;
+
+class TravelProfiles {
+private:
+    struct Breakpoint {
+        uint16_t time;
+        uint16_t factor;
+    };
+
+    int dayLength;
+    int hospitalCount;
+    int zoneCount;
+    vector<Breakpoint> breakpoints;
+    vector<uint32_t> profileStart;
+    vector<uint16_t> zoneOf;
+    vector<uint16_t> zoneProfile;
+    vector<uint32_t> pairKeys;
+    vector<uint16_t> pairProfiles;
+    int inputProfiles;
+
+public:
+    static constexpr const char* HEADER = "PROFILES";
+    static const int FACTOR_ONE = 1024;
+    static const int MAX_DAY_LENGTH = 65536;
+
+    TravelProfiles();
+
+    bool read(istream& in, int hospitals);
+    int profileFor(int fromHospital, int toHospital) const;
+    int factorAt(int profile, int time) const;
+    int scale(int fromHospital, int toHospital, int distance, int departTime) const;
+
+    int getProfileCount() const { return profileStart.size() - 1; }
+    int getInputProfileCount() const { return inputProfiles; }
+    size_t memoryBytes() const;
+};
+
+#endif
@@ -0,0 +1,61 @@
+#ifndef WHAT_IF_ENGINE_H
+#define WHAT_IF_ENGINE_H
+
+#include "AmbulanceSystem.h"
+#include "Scenario.h"
+#include <vector>
+#include <string>
+
+enum ScenarioEditType { REMOVE_CANCELLATION, ADD_CANCELLATION, CARS_OFFLINE };
+
+struct ScenarioEdit {
+    ScenarioEditType type;
+    int patientId;
+    int hospitalId;
+    CarType carType;
+    int count;
+    int fromTime, toTime;
+};
+
+struct WhatIfResult {
+    int restartTime;
+    int convergedTime;
+    int ticksSimulated;
+    double seconds;
+    string output;
+};
+
+class WhatIfEngine {
+private:
+    AmbulanceSystem system;
+    string scenarioFile;
+    int interval;
+    int baselineEndTime;
+    vector<SimulationSnapshot> snapshots;
+    SimulationSnapshot finalState;
+    string baselineOutput;
+    double baselineSeconds;
+    size_t snapshotBytes;
+    int sharedChunks, totalChunks;
+
+    const SimulationSnapshot& snapshotBefore(int time) const;
+    const SimulationSnapshot* snapshotAt(int time) const;
+    size_t ownedBytes(const SimulationSnapshot& snapshot) const;
+
+public:
+    WhatIfEngine(int interval);
+
+    bool load(const string& filename);
+    void runBaseline();
+    bool query(const vector<ScenarioEdit>& edits, WhatIfResult& result, bool incremental = true);
+    bool runFresh(const vector<ScenarioEdit>& edits, WhatIfResult& result) const;
+
+    const string& getBaselineOutput() const { return baselineOutput; }
+    double getBaselineSeconds() const { return baselineSeconds; }
+    int getSnapshotCount() const { return snapshots.size(); }
+    size_t getSnapshotBytes() const { return snapshotBytes; }
+    double getSharedChunkRatio() const { return totalChunks ? (double)sharedChunks / totalChunks : 0.0; }
+    int getEndTime() const { return finalState.time; }
+};
+
+#endif
@@ -0,0 +1,201 @@
+#include "AmbulanceLibrary.h"
+#include "AmbulanceSystem.h"
+#include <fstream>
+#include <new>
+
+class MemoryBuffer : public streambuf {
+public:
+    MemoryBuffer(const char* data, size_t length) {
+        char* start = const_cast<char*>(data);
+        setg(start, start, start + length);
+    }
+};
+
+struct amb_simulation {
+    AmbulanceSystem system;
+    bool loaded;
+    bool finished;
+    bool resultsFinal;
+    string error;
+    int32_t* results;
+    size_t patientCount;
+
+    amb_simulation() : loaded(false), finished(false), resultsFinal(false), results(nullptr), patientCount(0) {}
+    ~amb_simulation() { delete[] results; }
+
+    bool load(istream& in) {
+        if (loaded) {
+            error = "a scenario is already loaded";
+            return false;
+        }
+        if (!system.loadFromStream(in)) {
+            error = "invalid input";
+            return false;
+        }
+        patientCount = system.getPatients().size();
+        results = new (nothrow) int32_t[patientCount * 3 + 1];
+        if (!results) {
+            error = "out of memory";
+            return false;
+        }
+        loaded = true;
+        error.clear();
+        return true;
+    }
+
+    bool ready() {
+        if (!loaded) error = "no scenario loaded";
+        return loaded;
+    }
+
+    // Write the results block. Once the run has finished it no longer
+    // changes, so it is written one last time and then only handed out
+    void fillResults() {
+        if (resultsFinal) return;
+        int32_t* pid = results;
+        int32_t* finishTime = pid + patientCount;
+        int32_t* waitTime = finishTime + patientCount;
+        const vector<Patient*>& patients = system.getPatients();
+        for (size_t i = 0; i < patientCount; i++) {
+            const Patient* patient = patients[i];
+            bool served = patient->served && !patient->cancelled;
+            pid[i] = patient->pid;
+            finishTime[i] = served ? patient->finishTime : -1;
+            waitTime[i] = served ? patient->getWaitingTime() : -1;
+        }
+        resultsFinal = finished;
+    }
+};
+
+// Run the body of an API call. Nothing may be thrown through the C
+// interface, so an exception becomes an error return
+template <typename Body>
+static int guarded(amb_simulation* simulation, Body body) {
+    try {
+        return body();
+    } catch (const bad_alloc&) {
+        simulation->error = "out of memory";
+    } catch (const exception& e) {
+        simulation->error = e.what();
+    } catch (...) {
+        simulation->error = "internal error";
+    }
+    return -1;
+}
+
+int amb_api_version(void) {
+    return AMB_API_VERSION;
+}
+
+amb_simulation* amb_create(void) {
+    try {
+        return new amb_simulation();
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void amb_destroy(amb_simulation* simulation) {
+    delete simulation;
+}
+
+const char* amb_last_error(const amb_simulation* simulation) {
+    return simulation->error.c_str();
+}
+
+int amb_load_file(amb_simulation* simulation, const char* path) {
+    return guarded(simulation, [&]() -> int {
+        ifstream file(path);
+        if (!file.is_open()) {
+            simulation->error = string("cannot open ") + path;
+            return -1;
+        }
+        return simulation->load(file) ? 0 : -1;
+    });
+}
+
+int amb_load_buffer(amb_simulation* simulation, const char* data, size_t length) {
+    return guarded(simulation, [&]() -> int {
+        MemoryBuffer buffer(data, length);
+        istream in(&buffer);
+        return simulation->load(in) ? 0 : -1;
+    });
+}
+
+int amb_step(amb_simulation* simulation, int ticks) {
+    return guarded(simulation, [&]() -> int {
+        if (!simulation->ready()) return -1;
+        for (int i = 0; i < ticks && !simulation->finished; i++) {
+            if (!simulation->system.step()) simulation->finished = true;
+        }
+        return simulation->finished ? 0 : 1;
+    });
+}
+
+int amb_run(amb_simulation* simulation) {
+    return guarded(simulation, [&]() -> int {
+        if (!simulation->ready()) return -1;
+        while (!simulation->finished) {
+            if (!simulation->system.step()) simulation->finished = true;
+        }
+        return 0;
+    });
+}
+
+int amb_is_finished(const amb_simulation* simulation) {
+    return simulation->finished ? 1 : 0;
+}
+
+int amb_current_time(const amb_simulation* simulation) {
+    return simulation->system.getCurrentTime();
+}
+
+int amb_hospital_count(const amb_simulation* simulation) {
+    return simulation->system.getHospitalCount();
+}
+
+int amb_get_hospital_counters(amb_simulation* simulation, int hospital_id, amb_hospital_counters* counters) {
+    return guarded(simulation, [&]() -> int {
+        if (!simulation->ready()) return -1;
+        if (hospital_id < 1 || hospital_id > simulation->system.getHospitalCount()) {
+            simulation->error = "no such hospital";
+            return -1;
+        }
+
+        const Hospital* hospital = simulation->system.getHospital(hospital_id);
+        int ready[2] = {0, 0}, busy[2] = {0, 0}, offline[2] = {0, 0};
+        counters->busy_time = 0;
+        for (const Car* car : hospital->cars) {
+            if (car->status == READY) ready[car->type]++;
+            else if (car->status == OFFLINE) offline[car->type]++;
+            else busy[car->type]++;
+            counters->busy_time += car->totalBusyTime;
+        }
+
+        counters->ready_sc = ready[SC];
+        counters->ready_nc = ready[NC];
+        counters->busy_sc = busy[SC];
+        counters->busy_nc = busy[NC];
+        counters->offline_sc = offline[SC];
+        counters->offline_nc = offline[NC];
+        counters->ep_waiting = hospital->epQueue.size();
+        counters->sp_waiting = hospital->spQueue.size();
+        counters->np_waiting = hospital->npQueue.size();
+        counters->ep_not_served = hospital->epNotServed;
+        return 0;
+    });
+}
+
+int amb_get_results(amb_simulation* simulation, amb_results* results) {
+    return guarded(simulation, [&]() -> int {
+        if (!simulation->ready()) return -1;
+        simulation->fillResults();
+
+        size_t count = simulation->patientCount;
+        results->pid = simulation->results;
+        results->finish_time = simulation->results + count;
+        results->wait_time = simulation->results + 2 * count;
+        results->length = count;
+        return 0;
+    });
+}
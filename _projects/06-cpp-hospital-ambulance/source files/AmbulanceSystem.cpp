@@ -1,19 +1,31 @@
 #include "AmbulanceSystem.h"
+#include "ColumnarWriter.h"
 #include <iostream>
 #include <sstream>
 #include <algorithm>
 #include <iomanip>
+#include <climits>
 
 using namespace std;
 
 AmbulanceSystem::AmbulanceSystem() {
     currentTime = 1;
+    sortedActive = 0;
     totalPatients = npCount = spCount = epCount = 0;
     totalCars = scCount = ncCount = 0;
     epNotServedByHomeHospital = 0;
     totalWaitTime = totalBusyTime = 0.0;
     simulationEndTime = 0;
     scSpeed = ncSpeed = 0;
+    journal = nullptr;
+    telemetry = nullptr;
+    viewer = nullptr;
+    travelProfiles = nullptr;
+    stochasticTimes = nullptr;
+    dispatchMode = GREEDY_DISPATCH;
+    batchDispatcher = nullptr;
+    dispatchPolicy = FIXED_TYPE_POLICY;
+    forwardPolicy = NO_FORWARD_POLICY;
 }
 
 AmbulanceSystem::~AmbulanceSystem() {
@@ -23,13 +35,16 @@ AmbulanceSystem::~AmbulanceSystem() {
     for (Patient* patient : allPatients) {
         delete patient;
     }
+    delete journal;
+    delete telemetry;
+    delete viewer;
+    delete travelProfiles;
+    delete stochasticTimes;
+    delete batchDispatcher;
 }
 
 PatientType AmbulanceSystem::stringToPatientType(const string& typeStr) {
-    if (typeStr == "NP") return NP;
-    if (typeStr == "SP") return SP;
-    if (typeStr == "EP") return EP;
-    return NP;
+    return Scenario::patientTypeFromString(typeStr);
 }
 
 CarType AmbulanceSystem::stringToCarType(const string& typeStr) {
@@ -44,32 +59,44 @@ bool AmbulanceSystem::loadFromFile(const string& filename) {
         return false;
     }
 
-    int H;
-    file >> H;
-
-    file >> scSpeed >> ncSpeed;
+    bool loaded = loadFromStream(file);
+    file.close();
+    return loaded;
+}
 
-    distanceMatrix.resize(H, vector<int>(H));
-    for (int i = 0; i < H; i++) {
-        for (int j = 0; j < H; j++) {
-            file >> distanceMatrix[i][j];
-        }
+bool AmbulanceSystem::loadFromStream(istream& file) {
+    Scenario scenario;
+    if (!scenario.read(file)) {
+        return false;
     }
+    loadScenario(scenario);
+    return true;
+}
+
+void AmbulanceSystem::loadScenario(const Scenario& scenario) {
+    loadScenario(scenario, scenario.scCars, scenario.ncCars);
+}
+
+void AmbulanceSystem::loadScenario(const Scenario& scenario, const vector<int>& scCars,
+                                   const vector<int>& ncCars) {
+    int H = scenario.hospitalCount();
+    scSpeed = scenario.scSpeed;
+    ncSpeed = scenario.ncSpeed;
+    distanceMatrix = scenario.distances;
 
     for (int i = 0; i < H; i++) {
         hospitals.push_back(new Hospital(i + 1));
+        hospitals.back()->travel = travelProfiles;
+        hospitals.back()->worklist = &activeHospitals;
     }
 
     for (int i = 0; i < H; i++) {
-        int scNum, ncNum;
-        file >> scNum >> ncNum;
-
         int carId = 1;
-        for (int j = 0; j < scNum; j++) {
+        for (int j = 0; j < scCars[i]; j++) {
             hospitals[i]->addCar(new Car(carId++, SC, scSpeed, i + 1));
             scCount++;
         }
-        for (int j = 0; j < ncNum; j++) {
+        for (int j = 0; j < ncCars[i]; j++) {
             hospitals[i]->addCar(new Car(carId++, NC, ncSpeed, i + 1));
             ncCount++;
         }
@@ -77,56 +104,125 @@ bool AmbulanceSystem::loadFromFile(const string& filename) {
 
     totalCars = scCount + ncCount;
 
-    int R;
-    file >> R;
+    allPatients.reserve(scenario.requests.size());
+    for (const ScenarioRequest& request : scenario.requests) {
+        Patient* patient = new Patient(request.patientId, request.type, request.requestTime,
+                                       request.hospitalId, request.distance, request.severity);
+        patient->index = allPatients.size();
+        allPatients.push_back(patient);
+        requestsByTime[request.requestTime].push_back(patient);
 
-    for (int i = 0; i < R; i++) {
-        string typeStr;
-        int requestTime, patientId, hospitalId, distance, severity = 0;
+        totalPatients++;
+        if (request.type == NP) npCount++;
+        else if (request.type == SP) spCount++;
+        else if (request.type == EP) epCount++;
+    }
 
-        file >> typeStr >> requestTime >> patientId >> hospitalId >> distance;
+    for (const RequestCancellation& cancellation : scenario.cancellations) {
+        cancellations.push_back(cancellation);
+        cancellationsByTime[cancellation.cancellationTime].push_back(cancellation);
+    }
 
-        PatientType type = stringToPatientType(typeStr);
-        if (type == EP) {
-            file >> severity;
-        }
+    updateEndTime();
+}
 
-        Patient* patient = new Patient(patientId, type, requestTime, hospitalId, distance, severity);
-        allPatients.push_back(patient);
-        requestsByTime[requestTime].push_back(patient);
+// The simulation runs 1000 ticks past the last request or cancellation
+void AmbulanceSystem::updateEndTime() {
+    simulationEndTime = 0;
+    if (!requestsByTime.empty()) {
+        simulationEndTime = max(simulationEndTime, requestsByTime.rbegin()->first);
+    }
+    if (!cancellationsByTime.empty()) {
+        simulationEndTime = max(simulationEndTime, cancellationsByTime.rbegin()->first);
+    }
+    simulationEndTime += 1000;
+}
 
-        totalPatients++;
-        if (type == NP) npCount++;
-        else if (type == SP) spCount++;
-        else if (type == EP) epCount++;
+bool AmbulanceSystem::enableJournal(const string& filename) {
+    EventJournal* newJournal = new EventJournal();
+    if (!newJournal->open(filename)) {
+        delete newJournal;
+        return false;
+    }
+    newJournal->writeHeader(scSpeed, ncSpeed, hospitals, allPatients);
 
-        simulationEndTime = max(simulationEndTime, requestTime);
+    delete journal;
+    journal = newJournal;
+    for (Hospital* hospital : hospitals) {
+        hospital->journal = journal;
     }
+    return true;
+}
 
-    int C;
-    file >> C;
+bool AmbulanceSystem::loadTravelProfiles(const string& filename) {
+    ifstream file(filename);
+    if (!file.is_open()) {
+        cerr << "Error opening file: " << filename << endl;
+        return false;
+    }
 
-    for (int i = 0; i < C; i++) {
-        int cancellationTime, patientId;
-        file >> cancellationTime >> patientId;
+    TravelProfiles* profiles = new TravelProfiles();
+    if (!profiles->read(file, hospitals.size())) {
+        cerr << "Invalid travel profile file: " << filename << endl;
+        delete profiles;
+        return false;
+    }
 
-        RequestCancellation cancellation = {cancellationTime, patientId};
-        cancellations.push_back(cancellation);
-        cancellationsByTime[cancellationTime].push_back(cancellation);
+    delete travelProfiles;
+    travelProfiles = profiles;
+    for (Hospital* hospital : hospitals) {
+        hospital->travel = travelProfiles;
+    }
+    return true;
+}
 
-        simulationEndTime = max(simulationEndTime, cancellationTime);
+void AmbulanceSystem::enableStochasticTimes(const StochasticParams& params) {
+    delete stochasticTimes;
+    stochasticTimes = new StochasticTimes(params);
+    stochasticTimes->precompute(allPatients);
+    for (Hospital* hospital : hospitals) {
+        hospital->stochastic = stochasticTimes;
     }
+}
 
-    simulationEndTime += 1000;
+bool AmbulanceSystem::enableTelemetry(const string& filename, int maxRows) {
+    ofstream file(filename, ios::binary | ios::trunc);
+    if (!file.is_open()) {
+        cerr << "Error creating telemetry file: " << filename << endl;
+        return false;
+    }
 
-    file.close();
+    delete telemetry;
+    // The run goes on at least until the last request arrives
+    int minTicks = requestsByTime.empty() ? 0 : requestsByTime.rbegin()->first - currentTime + 1;
+    telemetry = new TelemetryRecorder(filename, hospitals, maxRows, minTicks);
+    changedHospitals.clear();
+    for (Hospital* hospital : hospitals) {
+        hospital->changeList = &changedHospitals;
+        hospital->changed = false;
+    }
     return true;
 }
 
+// The recorder reads only the hospitals whose counters moved since the last tick
+void AmbulanceSystem::sampleTelemetry(int time) {
+    telemetry->sample(time, changedHospitals);
+    for (Hospital* hospital : changedHospitals) {
+        hospital->changed = false;
+    }
+    changedHospitals.clear();
+}
+
+void AmbulanceSystem::enableViewer(int fps, int ticksPerFrame) {
+    delete viewer;
+    viewer = new TerminalViewer(fps, ticksPerFrame);
+}
+
 void AmbulanceSystem::handleNewRequests(int time) {
     if (requestsByTime.find(time) != requestsByTime.end()) {
         for (Patient* patient : requestsByTime[time]) {
             int hospitalIndex = patient->nearestHospitalId - 1;
+            if (journal) journal->recordArrival(patient);
             hospitals[hospitalIndex]->addPatientRequest(patient);
         }
     }
@@ -142,16 +238,48 @@ void AmbulanceSystem::handleCancellations(int time) {
     }
 }
 
+// Only hospitals on the worklist hold queued patients or busy cars, so a
+// cancellation cannot affect any other
+void AmbulanceSystem::handleActiveCancellations(int time) {
+    map<int, vector<RequestCancellation>>::iterator cancellations = cancellationsByTime.find(time);
+    if (cancellations == cancellationsByTime.end()) return;
+
+    for (RequestCancellation& cancellation : cancellations->second) {
+        for (Hospital* hospital : activeHospitals) {
+            hospital->handleCancellation(cancellation.patientId, time);
+        }
+    }
+}
+
 void AmbulanceSystem::updateAllHospitals(int time) {
+    if (batchDispatcher) {
+        for (Hospital* hospital : hospitals) {
+            hospital->updateCars(time);
+        }
+        batchDispatcher->dispatch(time);
+        return;
+    }
+
     for (Hospital* hospital : hospitals) {
         hospital->updateCars(time);
         hospital->processRequests(time);
     }
 }
+
+bool AmbulanceSystem::step() {
+    if (currentTime > simulationEndTime) return false;
+    processTimeStep(currentTime);
+    if (isFinished()) return false;
+    currentTime++;
+    return true;
+}
+
 void AmbulanceSystem::processTimeStep(int time) {
+    if (journal) journal->beginTick(time);
     handleNewRequests(time);
     handleCancellations(time);
     updateAllHospitals(time);
+    if (telemetry) sampleTelemetry(time);
 }
 
 void AmbulanceSystem::runSimulation(bool interactive) {
@@ -161,44 +289,329 @@ void AmbulanceSystem::runSimulation(bool interactive) {
         cout << "Silent Mode, Simulation Starts..." << endl;
     }
 
+    if (dispatchMode == OPTIMAL_DISPATCH && !batchDispatcher) {
+        batchDispatcher = new BatchDispatcher(hospitals, distanceMatrix);
+    }
+    if (viewer) viewer->start();
+
+    switch (dispatchPolicy) {
+        case RESERVE_SC_POLICY: {
+            ReserveScForEP dispatch;
+            runWithForwarding(interactive, dispatch);
+            break;
+        }
+        case SEVERITY_SP_POLICY: {
+            SeverityWeightedSP dispatch;
+            runWithForwarding(interactive, dispatch);
+            break;
+        }
+        case NEAREST_CAR_POLICY: {
+            NearestReadyCarAcrossHospitals dispatch(hospitals, distanceMatrix);
+            runWithForwarding(interactive, dispatch);
+            break;
+        }
+        default: {
+            FixedTypeDispatch dispatch;
+            runWithForwarding(interactive, dispatch);
+            break;
+        }
+    }
+
+    if (viewer) {
+        viewer->finish(currentTime, hospitals);
+        delete viewer;
+        viewer = nullptr;
+    }
+    if (journal) journal->close(currentTime);
+    if (telemetry && !telemetry->close()) {
+        cerr << "Error writing telemetry file" << endl;
+    }
+
+    if (!interactive) {
+        cout << "Simulation ends, Output file created" << endl;
+    }
+}
+
+template <class Dispatch>
+void AmbulanceSystem::runWithForwarding(bool interactive, Dispatch& dispatch) {
+    switch (forwardPolicy) {
+        case SHORTEST_QUEUE_FORWARD_POLICY: {
+            ShortestEPQueueForwarding forward(hospitals, distanceMatrix);
+            runLoop(interactive, dispatch, forward);
+            break;
+        }
+        case NEAREST_HOSPITAL_FORWARD_POLICY: {
+            NearestHospitalForwarding forward(hospitals, distanceMatrix);
+            runLoop(interactive, dispatch, forward);
+            break;
+        }
+        default: {
+            NoForwarding forward;
+            runLoop(interactive, dispatch, forward);
+            break;
+        }
+    }
+}
+
+template <class Dispatch, class Forward>
+void AmbulanceSystem::runLoop(bool interactive, Dispatch& dispatch, Forward& forward) {
     while (currentTime <= simulationEndTime) {
-        processTimeStep(currentTime);
+        processTimeStep(currentTime, dispatch, forward);
 
         if (interactive) {
             displayInteractiveStep(currentTime);
         }
 
-        bool allCarsReady = true;
-        for (Hospital* hospital : hospitals) {
-            for (Car* car : hospital->cars) {
-                if (car->status != READY) {
-                    allCarsReady = false;
-                    break;
-                }
+        if (isActiveFinished()) {
+            break;
+        }
+        if (viewer) viewer->tickDone(currentTime, hospitals);
+
+        currentTime++;
+    }
+}
+
+bool AmbulanceSystem::isFinished() const {
+    if (currentTime <= 100) return false;
+    if (requestsByTime.lower_bound(currentTime) != requestsByTime.end()) return false;
+
+    for (Hospital* hospital : hospitals) {
+        for (Car* car : hospital->cars) {
+            if (car->status == ASSIGNED || car->status == LOADED) return false;
+        }
+    }
+    return true;
+}
+
+// Same test through the worklist and the busy-car counters, for the policy loop
+bool AmbulanceSystem::isActiveFinished() const {
+    if (currentTime <= 100) return false;
+    if (requestsByTime.lower_bound(currentTime) != requestsByTime.end()) return false;
+
+    for (const Hospital* hospital : activeHospitals) {
+        if (hospital->busyCars > 0) return false;
+    }
+    return true;
+}
+
+void AmbulanceSystem::sortActiveHospitals() {
+    if (sortedActive == activeHospitals.size()) return;
+
+    auto byId = [](const Hospital* a, const Hospital* b) { return a->hospitalId < b->hospitalId; };
+    sort(activeHospitals.begin() + sortedActive, activeHospitals.end(), byId);
+    inplace_merge(activeHospitals.begin(), activeHospitals.begin() + sortedActive, activeHospitals.end(), byId);
+    sortedActive = activeHospitals.size();
+}
+
+void AmbulanceSystem::dropIdleHospitals() {
+    size_t kept = 0, keptSorted = 0;
+    for (size_t i = 0; i < activeHospitals.size(); i++) {
+        Hospital* hospital = activeHospitals[i];
+        if (i < sortedActive && hospital->isIdle()) {
+            hospital->listed = false;
+            continue;
+        }
+        activeHospitals[kept++] = hospital;
+        if (i < sortedActive) keptSorted = kept;
+    }
+    activeHospitals.resize(kept);
+    sortedActive = keptSorted;
+}
+
+// Edits keep the end time what loading the edited scenario would give
+void AmbulanceSystem::addCancellation(const RequestCancellation& cancellation) {
+    cancellationsByTime[cancellation.cancellationTime].push_back(cancellation);
+    updateEndTime();
+}
+
+bool AmbulanceSystem::removeCancellation(int patientId, int time, RequestCancellation& removed) {
+    for (map<int, vector<RequestCancellation>>::iterator entry = cancellationsByTime.begin();
+         entry != cancellationsByTime.end(); ++entry) {
+        if (time >= 0 && entry->first != time) continue;
+        vector<RequestCancellation>& list = entry->second;
+        for (size_t i = 0; i < list.size(); i++) {
+            if (list[i].patientId == patientId) {
+                removed = list[i];
+                list.erase(list.begin() + i);
+                if (list.empty()) cancellationsByTime.erase(entry);
+                updateEndTime();
+                return true;
             }
-            if (!allCarsReady) break;
         }
+    }
+    return false;
+}
 
-        bool hasActiveRequests = false;
-        for (int t = currentTime; t <= simulationEndTime; t++) {
-            if (requestsByTime.find(t) != requestsByTime.end() && !requestsByTime[t].empty()) {
-                hasActiveRequests = true;
-                break;
+static bool samePatientState(const Patient* patient, const PatientState& state) {
+    return patient->pickupTime == state.pickupTime && patient->finishTime == state.finishTime &&
+           patient->carHospitalId == state.carHospitalId && patient->cancelled == state.cancelled &&
+           patient->served == state.served;
+}
+
+void AmbulanceSystem::saveSnapshot(SimulationSnapshot& snapshot, const SimulationSnapshot* previous) const {
+    snapshot.time = currentTime;
+
+    snapshot.cars.clear();
+    snapshot.hospitals.resize(hospitals.size());
+    for (size_t h = 0; h < hospitals.size(); h++) {
+        Hospital* hospital = hospitals[h];
+        for (Car* car : hospital->cars) {
+            CarState state = {car->status, car->currentPatient, car->remainingDistance,
+                              car->returnDistance, car->busyStartTime, car->totalBusyTime};
+            snapshot.cars.push_back(state);
+        }
+        snapshot.hospitals[h].epQueue = hospital->epQueue;
+        snapshot.hospitals[h].spQueue = hospital->spQueue;
+        snapshot.hospitals[h].npQueue = hospital->npQueue;
+        snapshot.hospitals[h].epNotServed = hospital->epNotServed;
+        snapshot.hospitals[h].offlinePending[NC] = hospital->offlinePending[NC];
+        snapshot.hospitals[h].offlinePending[SC] = hospital->offlinePending[SC];
+    }
+
+    int chunkSize = SimulationSnapshot::CHUNK_SIZE;
+    size_t chunks = (allPatients.size() + chunkSize - 1) / chunkSize;
+    snapshot.patientChunks.resize(chunks);
+    snapshot.sharedChunks = 0;
+    for (size_t c = 0; c < chunks; c++) {
+        size_t first = c * chunkSize;
+        size_t last = min(allPatients.size(), first + chunkSize);
+
+        if (previous && c < previous->patientChunks.size()) {
+            const vector<PatientState>& old = *previous->patientChunks[c];
+            bool same = true;
+            for (size_t i = first; i < last && same; i++) {
+                same = samePatientState(allPatients[i], old[i - first]);
+            }
+            if (same) {
+                snapshot.patientChunks[c] = previous->patientChunks[c];
+                snapshot.sharedChunks++;
+                continue;
             }
         }
 
-        if (allCarsReady && !hasActiveRequests && currentTime > 100) {
-            break;
+        vector<PatientState>* chunk = new vector<PatientState>(last - first);
+        for (size_t i = first; i < last; i++) {
+            const Patient* patient = allPatients[i];
+            PatientState state = {patient->pickupTime, patient->finishTime, patient->carHospitalId,
+                                  patient->cancelled, patient->served};
+            (*chunk)[i - first] = state;
         }
+        snapshot.patientChunks[c] = shared_ptr<const vector<PatientState>>(chunk);
+    }
+}
 
-        currentTime++;
+void AmbulanceSystem::restoreSnapshot(const SimulationSnapshot& snapshot) {
+    currentTime = snapshot.time;
+
+    size_t index = 0;
+    for (size_t h = 0; h < hospitals.size(); h++) {
+        Hospital* hospital = hospitals[h];
+        for (Car* car : hospital->cars) {
+            const CarState& state = snapshot.cars[index++];
+            car->status = state.status;
+            car->currentPatient = state.patient;
+            car->remainingDistance = state.remainingDistance;
+            car->returnDistance = state.returnDistance;
+            car->busyStartTime = state.busyStartTime;
+            car->totalBusyTime = state.totalBusyTime;
+        }
+        hospital->epQueue = snapshot.hospitals[h].epQueue;
+        hospital->spQueue = snapshot.hospitals[h].spQueue;
+        hospital->npQueue = snapshot.hospitals[h].npQueue;
+        hospital->epNotServed = snapshot.hospitals[h].epNotServed;
+        hospital->offlinePending[NC] = snapshot.hospitals[h].offlinePending[NC];
+        hospital->offlinePending[SC] = snapshot.hospitals[h].offlinePending[SC];
+        hospital->recountCars();
+        if (!hospital->isIdle()) hospital->markActive();
     }
 
-    if (!interactive) {
-        cout << "Simulation ends, Output file created" << endl;
+    int chunkSize = SimulationSnapshot::CHUNK_SIZE;
+    for (size_t i = 0; i < allPatients.size(); i++) {
+        const PatientState& state = (*snapshot.patientChunks[i / chunkSize])[i % chunkSize];
+        Patient* patient = allPatients[i];
+        patient->pickupTime = state.pickupTime;
+        patient->finishTime = state.finishTime;
+        patient->carHospitalId = state.carHospitalId;
+        patient->cancelled = state.cancelled;
+        patient->served = state.served;
     }
 }
 
+bool AmbulanceSystem::matchesSnapshot(const SimulationSnapshot& snapshot) const {
+    if (currentTime != snapshot.time) return false;
+
+    size_t index = 0;
+    for (size_t h = 0; h < hospitals.size(); h++) {
+        const Hospital* hospital = hospitals[h];
+        for (const Car* car : hospital->cars) {
+            const CarState& state = snapshot.cars[index++];
+            if (car->status != state.status || car->currentPatient != state.patient ||
+                car->remainingDistance != state.remainingDistance ||
+                car->returnDistance != state.returnDistance || car->busyStartTime != state.busyStartTime) {
+                return false;
+            }
+            if (car->currentPatient) {
+                const PatientState& patient = (*snapshot.patientChunks[car->currentPatient->index /
+                                                SimulationSnapshot::CHUNK_SIZE])
+                                              [car->currentPatient->index % SimulationSnapshot::CHUNK_SIZE];
+                if (car->currentPatient->pickupTime != patient.pickupTime) return false;
+            }
+        }
+
+        const HospitalState& state = snapshot.hospitals[h];
+        if (hospital->offlinePending[NC] != state.offlinePending[NC] ||
+            hospital->offlinePending[SC] != state.offlinePending[SC]) {
+            return false;
+        }
+        if (queueContainer(hospital->epQueue) != queueContainer(state.epQueue) ||
+            queueContainer(hospital->spQueue) != queueContainer(state.spQueue) ||
+            queueContainer(hospital->npQueue) != queueContainer(state.npQueue)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void AmbulanceSystem::spliceSnapshot(const SimulationSnapshot& at, const SimulationSnapshot& final) {
+    int chunkSize = SimulationSnapshot::CHUNK_SIZE;
+    for (size_t i = 0; i < allPatients.size(); i++) {
+        Patient* patient = allPatients[i];
+        if (patient->finishTime != -1 || patient->cancelled) continue;
+
+        const PatientState& state = (*final.patientChunks[i / chunkSize])[i % chunkSize];
+        patient->pickupTime = state.pickupTime;
+        patient->finishTime = state.finishTime;
+        patient->carHospitalId = state.carHospitalId;
+        patient->cancelled = state.cancelled;
+        patient->served = state.served;
+    }
+
+    size_t index = 0;
+    for (size_t h = 0; h < hospitals.size(); h++) {
+        Hospital* hospital = hospitals[h];
+        for (Car* car : hospital->cars) {
+            const CarState& from = at.cars[index];
+            const CarState& to = final.cars[index++];
+            car->status = to.status;
+            car->currentPatient = to.patient;
+            car->remainingDistance = to.remainingDistance;
+            car->returnDistance = to.returnDistance;
+            car->busyStartTime = to.busyStartTime;
+            car->totalBusyTime += to.totalBusyTime - from.totalBusyTime;
+        }
+        hospital->epQueue = final.hospitals[h].epQueue;
+        hospital->spQueue = final.hospitals[h].spQueue;
+        hospital->npQueue = final.hospitals[h].npQueue;
+        hospital->epNotServed += final.hospitals[h].epNotServed - at.hospitals[h].epNotServed;
+        hospital->offlinePending[NC] = final.hospitals[h].offlinePending[NC];
+        hospital->offlinePending[SC] = final.hospitals[h].offlinePending[SC];
+        hospital->recountCars();
+        if (!hospital->isIdle()) hospital->markActive();
+    }
+
+    currentTime = final.time;
+}
+
 void AmbulanceSystem::displayInteractiveStep(int time) {
     cout << "Current Timestep: " << time << endl;
 
@@ -269,22 +682,65 @@ void AmbulanceSystem::calculateStatistics() {
         }
     }
 
+    epNotServedByHomeHospital = 0;
     for (Hospital* hospital : hospitals) {
         epNotServedByHomeHospital += hospital->epNotServed;
     }
 }
 
-void AmbulanceSystem::saveOutputFile(const string& filename) {
-    calculateStatistics();
+SimulationSummary AmbulanceSystem::getSummary() const {
+    SimulationSummary summary;
+    summary.hospitalCount = hospitals.size();
+    summary.npCount = npCount;
+    summary.spCount = spCount;
+    summary.epCount = epCount;
+    summary.totalCars = totalCars;
+    summary.scCount = scCount;
+    summary.ncCount = ncCount;
+    summary.epNotServedByHomeHospital = epNotServedByHomeHospital;
+    summary.totalWaitTime = totalWaitTime;
+    summary.totalBusyTime = totalBusyTime;
+    summary.endTime = currentTime;
+    return summary;
+}
 
+void AmbulanceSystem::saveOutputFile(const string& filename) {
     ofstream file(filename);
     if (!file.is_open()) {
         cerr << "Error creating output file: " << filename << endl;
         return;
     }
 
+    writeResults(file);
+    file.close();
+}
+
+bool AmbulanceSystem::saveColumnarFile(const string& filename) {
+    ColumnarWriter writer;
+    if (!writer.open(filename)) {
+        cerr << "Error creating columnar file: " << filename << endl;
+        return false;
+    }
+
+    for (const Patient* patient : allPatients) {
+        writer.append(patient);
+    }
+    if (!writer.close()) {
+        cerr << "Error writing columnar file: " << filename << endl;
+        return false;
+    }
+    return true;
+}
+
+void AmbulanceSystem::writeResults(ostream& file) {
+    calculateStatistics();
+    writeOutput(file, allPatients, getSummary());
+}
+
+void AmbulanceSystem::writeOutput(ostream& file, const vector<Patient*>& patients,
+                                  const SimulationSummary& summary) {
     vector<Patient*> servedPatients;
-    for (Patient* patient : allPatients) {
+    for (Patient* patient : patients) {
         if (patient->served && !patient->cancelled) {
             servedPatients.push_back(patient);
         }
@@ -303,48 +759,28 @@ void AmbulanceSystem::saveOutputFile(const string& filename) {
     }
 
     double avgWaitTime = (servedPatients.size() > 0) ? 
-                        (totalWaitTime / servedPatients.size()) : 0.0;
-    double avgBusyTime = (totalCars > 0) ? (totalBusyTime / totalCars) : 0.0;
-    double avgUtilization = (currentTime > 0) ? 
-                           ((avgBusyTime / currentTime) * 100.0) : 0.0;
+                        (summary.totalWaitTime / servedPatients.size()) : 0.0;
+    double avgBusyTime = (summary.totalCars > 0) ? (summary.totalBusyTime / summary.totalCars) : 0.0;
+    double avgUtilization = (summary.endTime > 0) ? 
+                           ((avgBusyTime / summary.endTime) * 100.0) : 0.0;
 
     file << "Patients: " << servedPatients.size() 
-         << " [NP: " << npCount << ", SP: " << spCount << ", EP: " << epCount << "]" << endl;
-    file << "Hospitals: " << hospitals.size() << endl;
-    file << "Cars: " << totalCars 
-         << " [SCar: " << scCount << ", NCar: " << ncCount << "]" << endl;
+         << " [NP: " << summary.npCount << ", SP: " << summary.spCount << ", EP: " << summary.epCount << "]" << endl;
+    file << "Hospitals: " << summary.hospitalCount << endl;
+    file << "Cars: " << summary.totalCars 
+         << " [SCar: " << summary.scCount << ", NCar: " << summary.ncCount << "]" << endl;
     file << "Avg wait time = " << fixed << setprecision(0) << avgWaitTime << endl;
 
-    double epNotServedPercentage = (epCount > 0) ? 
-                                  ((double)epNotServedByHomeHospital / epCount * 100.0) : 0.0;
+    double epNotServedPercentage = (summary.epCount > 0) ? 
+                                  ((double)summary.epNotServedByHomeHospital / summary.epCount * 100.0) : 0.0;
     file << "EP not served by home hospital: " << fixed << setprecision(1) 
          << epNotServedPercentage << "%" << endl;
     file << "Avg busy time = " << fixed << setprecision(0) << avgBusyTime << endl;
     file << "Avg utilization = " << fixed << setprecision(0) << avgUtilization << "%" << endl;
-
-    file.close();
 }
 
 Hospital* AmbulanceSystem::findBestHospitalForEP(int currentHospitalId) {
-    Hospital* bestHospital = nullptr;
-    int minQueueLength = INT_MAX;
-    int minDistance = INT_MAX;
-
-    for (Hospital* hospital : hospitals) {
-        if (hospital->hospitalId == currentHospitalId) continue;
-
-        int queueLength = hospital->epQueue.size();
-        int distance = getDistance(currentHospitalId, hospital->hospitalId);
-
-        if (queueLength < minQueueLength || 
-           (queueLength == minQueueLength && distance < minDistance)) {
-            minQueueLength = queueLength;
-            minDistance = distance;
-            bestHospital = hospital;
-        }
-    }
-
-    return bestHospital;
+    return ShortestEPQueueForwarding(hospitals, distanceMatrix).destination(currentHospitalId);
 }
 
 int AmbulanceSystem::getDistance(int hospital1, int hospital2) {
@@ -358,7 +794,12 @@ int AmbulanceSystem::getDistance(int hospital1, int hospital2) {
 void AmbulanceSystem::forwardEPRequest(Patient* patient) {
     Hospital* bestHospital = findBestHospitalForEP(patient->nearestHospitalId);
     if (bestHospital) {
-        bestHospital->addPatientRequest(patient);
-        hospitals[patient->nearestHospitalId - 1]->epNotServed++;
+        forwardEPRequest(patient, bestHospital);
     }
+}
+
+void AmbulanceSystem::forwardEPRequest(Patient* patient, Hospital* destination) {
+    if (journal) journal->recordForward(patient->nearestHospitalId, destination->hospitalId, patient);
+    destination->addPatientRequest(patient);
+    hospitals[patient->nearestHospitalId - 1]->epNotServed++;
 }
\ No newline at end of file
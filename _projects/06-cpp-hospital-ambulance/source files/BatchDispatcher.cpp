@@ -0,0 +1,324 @@
+#include "BatchDispatcher.h"
+#include "DispatchPolicies.h"
+#include <algorithm>
+#include <chrono>
+
+BatchDispatcher::BatchDispatcher(const vector<Hospital*>& hospitals, const vector<vector<int>>& distances)
+    : hospitals(hospitals), distances(distances) {
+    totalBids = 0;
+
+    int H = hospitals.size();
+    neighbours = nearestHospitals(distances, NEIGHBOUR_COUNT);
+
+    carBase.assign(1, 0);
+    for (Hospital* hospital : hospitals) {
+        for (Car* car : hospital->cars) {
+            carsByIndex.push_back(car);
+        }
+        carBase.push_back(carsByIndex.size());
+    }
+    price.assign(carsByIndex.size(), 0);
+    owner.assign(carsByIndex.size(), -1);
+    groupOf.assign(H * 2, -1);
+}
+
+int BatchDispatcher::carIndex(const Car* car) const {
+    return carBase[car->hospitalId - 1] + car->carId - 1;
+}
+
+void BatchDispatcher::collectReadyCars() {
+    groupStart.clear();
+    groupSpeed.clear();
+    heap.clear();
+
+    for (size_t h = 0; h < hospitals.size(); h++) {
+        for (int type = 0; type < 2; type++) {
+            groupOf[h * 2 + type] = -1;
+            size_t first = heap.size();
+            for (Car* car : hospitals[h]->cars) {
+                if (car->status == READY && car->type == type) {
+                    int index = carIndex(car);
+                    price[index] = 0;
+                    owner[index] = -1;
+                    heap.push_back(index);
+                }
+            }
+            if (heap.size() > first) {
+                groupOf[h * 2 + type] = groupStart.size();
+                groupStart.push_back(first);
+                groupSpeed.push_back(carsByIndex[heap[first]]->speed);
+            }
+        }
+    }
+    groupStart.push_back(heap.size());
+}
+
+void BatchDispatcher::collectWaitingPatients(int currentTime) {
+    bidders.clear();
+    arcs.clear();
+
+    for (size_t h = 0; h < hospitals.size(); h++) {
+        Hospital* hospital = hospitals[h];
+        size_t first = bidders.size();
+
+        while (!hospital->epQueue.empty()) {
+            Bidder bidder = {hospital->epQueue.top(), (int)h, 0, 0, -1, 0};
+            bidders.push_back(bidder);
+            hospital->epQueue.pop();
+        }
+        while (!hospital->spQueue.empty()) {
+            Bidder bidder = {hospital->spQueue.front(), (int)h, 0, 0, -1, 0};
+            bidders.push_back(bidder);
+            hospital->spQueue.pop();
+        }
+        while (!hospital->npQueue.empty()) {
+            Bidder bidder = {hospital->npQueue.front(), (int)h, 0, 0, -1, 0};
+            bidders.push_back(bidder);
+            hospital->npQueue.pop();
+        }
+
+        int limit[3] = {0, 0, 0};
+        for (int n : neighbours[h]) {
+            int sc = groupOf[n * 2 + SC], nc = groupOf[n * 2 + NC];
+            int scReady = (sc < 0) ? 0 : groupStart[sc + 1] - groupStart[sc];
+            int ncReady = (nc < 0) ? 0 : groupStart[nc + 1] - groupStart[nc];
+            limit[EP] += scReady + ncReady;
+            limit[SP] += scReady;
+            limit[NP] += ncReady;
+        }
+
+        for (size_t i = first; i < bidders.size(); i++) {
+            Bidder& bidder = bidders[i];
+            bidder.arcStart = bidder.arcEnd = arcs.size();
+            if (limit[bidder.patient->type] > 0) {
+                limit[bidder.patient->type]--;
+                buildArcs(bidder, currentTime);
+            }
+        }
+    }
+}
+
+void BatchDispatcher::buildArcs(Bidder& bidder, int currentTime) {
+    Patient* patient = bidder.patient;
+    int weight = (patient->type == EP) ? EP_WEIGHT + SEVERITY_WEIGHT * patient->severity :
+                 (patient->type == SP) ? SP_WEIGHT : NP_WEIGHT;
+    weight += min(currentTime - patient->requestTime, (int)MAX_AGE_BONUS);
+
+    for (int n : neighbours[bidder.hospital]) {
+        int distance = patient->distanceToHospital;
+        if (n != bidder.hospital) distance += distances[n][bidder.hospital];
+
+        for (int type = 0; type < 2; type++) {
+            if (patient->type == SP && type != SC) continue;
+            if (patient->type == NP && type != NC) continue;
+            int group = groupOf[n * 2 + type];
+            if (group < 0) continue;
+
+            int speed = max(1, groupSpeed[group]);
+            int travelTicks = (distance + speed - 1) / speed;
+            int64_t value = weight - TRAVEL_WEIGHT * travelTicks;
+            if (value <= 0) continue;
+
+            Arc arc = {group, value};
+            arcs.push_back(arc);
+        }
+    }
+    bidder.arcEnd = arcs.size();
+}
+
+void BatchDispatcher::siftDown(int group) {
+    int* slots = heap.data() + groupStart[group];
+    int size = groupStart[group + 1] - groupStart[group];
+    int slot = 0;
+    while (true) {
+        int child = 2 * slot + 1;
+        if (child >= size) break;
+        if (child + 1 < size && price[slots[child + 1]] < price[slots[child]]) child++;
+        if (price[slots[child]] >= price[slots[slot]]) break;
+        swap(slots[child], slots[slot]);
+        slot = child;
+    }
+}
+
+int BatchDispatcher::bestArc(const Bidder& bidder, int64_t& best, int64_t& second) const {
+    int bestIndex = -1;
+    best = second = 0;
+    for (int a = bidder.arcStart; a < bidder.arcEnd; a++) {
+        const Arc& arc = arcs[a];
+        int start = groupStart[arc.group], end = groupStart[arc.group + 1];
+        int64_t net = arc.value - price[heap[start]];
+        if (net > best) {
+            second = best;
+            best = net;
+            bestIndex = a;
+        } else if (net > second) {
+            second = net;
+        }
+        if (end - start > 1) {
+            int64_t next = price[heap[start + 1]];
+            if (end - start > 2) next = min(next, price[heap[start + 2]]);
+            second = max(second, arc.value - next);
+        }
+    }
+    return bestIndex;
+}
+
+void BatchDispatcher::resetAssignments() {
+    unassigned.clear();
+    for (int i = (int)bidders.size() - 1; i >= 0; i--) {
+        bidders[i].car = -1;
+        if (bidders[i].arcEnd > bidders[i].arcStart) {
+            unassigned.push_back(i);
+        }
+    }
+    for (int car : heap) {
+        owner[car] = -1;
+    }
+}
+
+void BatchDispatcher::runAuction(int64_t eps) {
+    while (!unassigned.empty()) {
+        int i = unassigned.back();
+        unassigned.pop_back();
+
+        int64_t best, second;
+        int a = bestArc(bidders[i], best, second);
+        if (a < 0) continue;
+
+        int group = arcs[a].group;
+        int car = heap[groupStart[group]];
+        price[car] += best - second + eps;
+        siftDown(group);
+
+        int previous = owner[car];
+        owner[car] = i;
+        bidders[i].car = car;
+        bidders[i].value = arcs[a].value;
+        if (previous >= 0) {
+            bidders[previous].car = -1;
+            unassigned.push_back(previous);
+        }
+        totalBids++;
+    }
+}
+
+void BatchDispatcher::buildReverseArcs() {
+    int groups = groupStart.size() - 1;
+    reverseStart.assign(groups + 1, 0);
+    for (const Arc& arc : arcs) {
+        reverseStart[arc.group + 1]++;
+    }
+    for (int g = 0; g < groups; g++) {
+        reverseStart[g + 1] += reverseStart[g];
+    }
+    reverseArcs.resize(arcs.size());
+    vector<int> fill(reverseStart.begin(), reverseStart.end() - 1);
+    for (size_t i = 0; i < bidders.size(); i++) {
+        for (int a = bidders[i].arcStart; a < bidders[i].arcEnd; a++) {
+            ReverseArc reverse = {(int)i, arcs[a].value};
+            reverseArcs[fill[arcs[a].group]++] = reverse;
+        }
+    }
+}
+
+int64_t BatchDispatcher::profit(const Bidder& bidder) const {
+    return (bidder.car >= 0) ? bidder.value - price[bidder.car] : 0;
+}
+
+void BatchDispatcher::runReverseAuction(int64_t eps) {
+    unassigned.clear();
+    for (int car : heap) {
+        if (owner[car] < 0 && price[car] > 0) unassigned.push_back(car);
+    }
+
+    while (!unassigned.empty()) {
+        int car = unassigned.back();
+        unassigned.pop_back();
+
+        int group = groupOf[(carsByIndex[car]->hospitalId - 1) * 2 + carsByIndex[car]->type];
+
+        int bestBidder = -1;
+        int64_t best = 0, second = 0, bestValue = 0;
+        for (int r = reverseStart[group]; r < reverseStart[group + 1]; r++) {
+            const ReverseArc& reverse = reverseArcs[r];
+            int64_t net = reverse.value - profit(bidders[reverse.bidder]);
+            if (bestBidder < 0 || net > best) {
+                if (bestBidder >= 0) second = max(second, best);
+                best = net;
+                bestBidder = reverse.bidder;
+                bestValue = reverse.value;
+            } else if (net > second) {
+                second = net;
+            }
+        }
+
+        if (bestBidder < 0 || best <= eps) {
+            price[car] = 0;
+            continue;
+        }
+
+        price[car] = max((int64_t)0, second - eps);
+        Bidder& bidder = bidders[bestBidder];
+        int previous = bidder.car;
+        owner[car] = bestBidder;
+        bidder.car = car;
+        bidder.value = bestValue;
+        if (previous >= 0) {
+            owner[previous] = -1;
+            if (price[previous] > 0) unassigned.push_back(previous);
+        }
+        totalBids++;
+    }
+}
+
+void BatchDispatcher::applyAssignments(int currentTime) {
+    for (Bidder& bidder : bidders) {
+        Patient* patient = bidder.patient;
+        Hospital* queueHospital = hospitals[bidder.hospital];
+
+        if (bidder.car < 0) {
+            if (patient->type == EP) queueHospital->epQueue.push(patient);
+            else if (patient->type == SP) queueHospital->spQueue.push(patient);
+            else queueHospital->npQueue.push(patient);
+            continue;
+        }
+
+        Car* car = carsByIndex[bidder.car];
+        int from = car->hospitalId - 1;
+        queueHospital->assignForeignCar(hospitals[from], car, patient, currentTime,
+                                        distances[from][bidder.hospital], distances[bidder.hospital][from]);
+    }
+}
+
+void BatchDispatcher::dispatch(int currentTime) {
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+    collectReadyCars();
+    collectWaitingPatients(currentTime);
+
+    // The auction ends within n * eps of the best total for n bidders. With
+    // values scaled by n + 1 and a last round at eps 1 that is less than one
+    // unscaled point, so the whole-number optimum is reached exactly
+    int64_t scale = (int64_t)bidders.size() + 1;
+    int64_t maxValue = 0;
+    for (Arc& arc : arcs) {
+        arc.value *= scale;
+        maxValue = max(maxValue, arc.value);
+    }
+
+    if (maxValue > 0) {
+        int64_t eps = max((int64_t)1, maxValue / 8);
+        while (true) {
+            resetAssignments();
+            runAuction(eps);
+            if (eps == 1) break;
+            eps = max((int64_t)1, eps / 8);
+        }
+        buildReverseArcs();
+        runReverseAuction(1);
+    }
+
+    applyAssignments(currentTime);
+
+    solveMicros.push_back(chrono::duration<double, micro>(chrono::steady_clock::now() - start).count());
+}
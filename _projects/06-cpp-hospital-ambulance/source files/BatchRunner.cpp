@@ -0,0 +1,275 @@
+#include "BatchRunner.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <new>
+#include <thread>
+#include <dirent.h>
+#include <sys/stat.h>
+
+static string fileName(const string& path) {
+    size_t slash = path.find_last_of('/');
+    return (slash == string::npos) ? path : path.substr(slash + 1);
+}
+
+static string outputPath(const string& outputDirectory, const string& inputFile) {
+    string name = fileName(inputFile);
+    size_t dot = name.find_last_of('.');
+    if (dot != string::npos && dot > 0) name = name.substr(0, dot);
+    return outputDirectory + "/" + name + ".out";
+}
+
+static string csvField(const string& value) {
+    if (value.find_first_of(",\"\n") == string::npos) return value;
+    string quoted = "\"";
+    for (char c : value) {
+        if (c == '"') quoted += '"';
+        quoted += c;
+    }
+    return quoted + "\"";
+}
+
+BatchRunner::BatchRunner(int threads, int64_t memoryLimit)
+    : threadCount(max(1, threads)), memoryLimit(memoryLimit) {
+    memoryInUse = 0;
+    running = 0;
+    steals = 0;
+    admissionWaits = 0;
+    peakMemory = 0;
+    wallSeconds = 0.0;
+}
+
+BatchRunner::~BatchRunner() {
+    for (WorkerQueue* queue : queues) {
+        delete queue;
+    }
+}
+
+bool BatchRunner::addJob(const string& inputFile, const string& outputFile) {
+    struct stat info;
+    bool readable = stat(inputFile.c_str(), &info) == 0 && S_ISREG(info.st_mode);
+    int64_t size = readable ? info.st_size : 0;
+
+    BatchJob job;
+    job.inputFile = inputFile;
+    job.outputFile = outputFile;
+    job.cost = size;
+    job.memory = size * MEMORY_PER_INPUT_BYTE + MEMORY_PER_JOB;
+    job.ok = false;
+    job.servedCount = 0;
+    job.seconds = 0.0;
+    job.worker = -1;
+    jobs.push_back(job);
+    return readable;
+}
+
+bool BatchRunner::addManifest(const string& manifest, const string& outputDirectory) {
+    ifstream file(manifest);
+    if (!file.is_open()) return false;
+
+    string line;
+    while (getline(file, line)) {
+        if (!line.empty() && line[line.size() - 1] == '\r') line.erase(line.size() - 1);
+        if (line.empty() || line[0] == '#') continue;
+
+        size_t tab = line.find('\t');
+        string inputFile = line.substr(0, tab);
+        string outputFile = (tab == string::npos) ? outputPath(outputDirectory, inputFile) : line.substr(tab + 1);
+        addJob(inputFile, outputFile);
+    }
+    return true;
+}
+
+bool BatchRunner::addDirectory(const string& directory, const string& outputDirectory) {
+    DIR* handle = opendir(directory.c_str());
+    if (!handle) return false;
+
+    vector<string> names;
+    while (dirent* entry = readdir(handle)) {
+        if (entry->d_name[0] != '.') names.push_back(entry->d_name);
+    }
+    closedir(handle);
+
+    sort(names.begin(), names.end());
+    for (const string& name : names) {
+        string inputFile = directory + "/" + name;
+        struct stat info;
+        if (stat(inputFile.c_str(), &info) != 0 || !S_ISREG(info.st_mode)) continue;
+        addJob(inputFile, outputPath(outputDirectory, inputFile));
+    }
+    return true;
+}
+
+bool BatchRunner::takeJob(int worker, int& job) {
+    WorkerQueue* own = queues[worker];
+    {
+        lock_guard<mutex> guard(own->lock);
+        if (!own->jobs.empty()) {
+            job = own->jobs.front();
+            own->jobs.pop_front();
+            own->remainingCost -= jobs[job].cost;
+            return true;
+        }
+    }
+
+    while (true) {
+        int victim = -1;
+        int64_t largest = 0;
+        for (int w = 0; w < threadCount; w++) {
+            lock_guard<mutex> guard(queues[w]->lock);
+            if (w != worker && !queues[w]->jobs.empty() && queues[w]->remainingCost >= largest) {
+                victim = w;
+                largest = queues[w]->remainingCost;
+            }
+        }
+        if (victim < 0) return false;
+
+        lock_guard<mutex> guard(queues[victim]->lock);
+        if (queues[victim]->jobs.empty()) continue;
+        job = queues[victim]->jobs.back();
+        queues[victim]->jobs.pop_back();
+        queues[victim]->remainingCost -= jobs[job].cost;
+        lock_guard<mutex> memoryGuard(memoryLock);
+        steals++;
+        return true;
+    }
+}
+
+void BatchRunner::admit(const BatchJob& job) {
+    unique_lock<mutex> guard(memoryLock);
+    if (memoryLimit > 0 && running > 0 && memoryInUse + job.memory > memoryLimit) {
+        admissionWaits++;
+        memoryReleased.wait(guard, [&] { return running == 0 || memoryInUse + job.memory <= memoryLimit; });
+    }
+    memoryInUse += job.memory;
+    running++;
+    peakMemory = max(peakMemory, memoryInUse);
+}
+
+void BatchRunner::release(const BatchJob& job) {
+    {
+        lock_guard<mutex> guard(memoryLock);
+        memoryInUse -= job.memory;
+        running--;
+    }
+    memoryReleased.notify_all();
+}
+
+void BatchRunner::runJob(BatchJob& job, int worker) {
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    job.worker = worker;
+
+    AmbulanceSystem system;
+    ifstream in(job.inputFile);
+    if (!in.is_open()) {
+        job.error = "cannot open input";
+        return;
+    }
+    // A declared record count can be large enough to exhaust memory
+    // before the short data is noticed, which is bad input as well
+    bool loaded;
+    try {
+        loaded = system.loadFromStream(in);
+    } catch (const bad_alloc&) {
+        loaded = false;
+    }
+    if (!loaded) {
+        job.error = "invalid input";
+        return;
+    }
+    while (system.step()) {
+    }
+
+    ofstream out(job.outputFile);
+    if (!out.is_open()) {
+        job.error = "cannot create output";
+        return;
+    }
+    system.writeResults(out);
+    job.summary = system.getSummary();
+    for (const Patient* patient : system.getPatients()) {
+        if (patient->served && !patient->cancelled) job.servedCount++;
+    }
+    job.ok = true;
+    job.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+void BatchRunner::workerLoop(int worker) {
+    int job;
+    while (takeJob(worker, job)) {
+        admit(jobs[job]);
+        runJob(jobs[job], worker);
+        release(jobs[job]);
+    }
+}
+
+void BatchRunner::run() {
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+    vector<int> order(jobs.size());
+    for (size_t i = 0; i < order.size(); i++) order[i] = i;
+    stable_sort(order.begin(), order.end(), [&](int a, int b) { return jobs[a].cost > jobs[b].cost; });
+
+    threadCount = max(1, min(threadCount, (int)jobs.size()));
+    for (int w = 0; w < threadCount; w++) {
+        queues.push_back(new WorkerQueue());
+        queues.back()->remainingCost = 0;
+    }
+    for (int job : order) {
+        WorkerQueue* lightest = queues[0];
+        for (WorkerQueue* queue : queues) {
+            if (queue->remainingCost < lightest->remainingCost) lightest = queue;
+        }
+        lightest->jobs.push_back(job);
+        lightest->remainingCost += jobs[job].cost;
+    }
+
+    vector<thread> workers;
+    for (int w = 1; w < threadCount; w++) {
+        workers.push_back(thread(&BatchRunner::workerLoop, this, w));
+    }
+    workerLoop(0);
+    for (thread& t : workers) {
+        t.join();
+    }
+
+    wallSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+bool BatchRunner::writeSummary(const string& filename) const {
+    ofstream file(filename);
+    if (!file.is_open()) return false;
+
+    file << "input,output,status,hospitals,patients,np,sp,ep,cars,sc,nc,avg_wait,ep_not_served_pct,"
+            "avg_busy,avg_utilization,end_time,seconds\n";
+    file << fixed;
+    for (const BatchJob& job : jobs) {
+        file << csvField(job.inputFile) << "," << csvField(job.outputFile) << ",";
+        if (!job.ok) {
+            file << csvField(job.error.empty() ? "not run" : job.error) << ",,,,,,,,,,,,,,\n";
+            continue;
+        }
+
+        const SimulationSummary& summary = job.summary;
+        double avgWait = job.servedCount > 0 ? summary.totalWaitTime / job.servedCount : 0.0;
+        double avgBusy = summary.totalCars > 0 ? summary.totalBusyTime / summary.totalCars : 0.0;
+        double utilization = summary.endTime > 0 ? avgBusy / summary.endTime * 100.0 : 0.0;
+        double epNotServed = summary.epCount > 0 ? (double)summary.epNotServedByHomeHospital / summary.epCount * 100.0
+                                                 : 0.0;
+        file << "ok," << summary.hospitalCount << "," << job.servedCount << "," << summary.npCount << ","
+             << summary.spCount << "," << summary.epCount << "," << summary.totalCars << "," << summary.scCount
+             << "," << summary.ncCount << "," << setprecision(2) << avgWait << "," << epNotServed << ","
+             << avgBusy << "," << utilization << "," << summary.endTime << "," << setprecision(4) << job.seconds
+             << "\n";
+    }
+    return true;
+}
+
+int BatchRunner::getFailedCount() const {
+    int failed = 0;
+    for (const BatchJob& job : jobs) {
+        if (!job.ok) failed++;
+    }
+    return failed;
+}
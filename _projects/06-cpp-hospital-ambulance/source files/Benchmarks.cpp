@@ -0,0 +1,365 @@
+#include "Benchmarks.h"
+#include "AmbulanceSystem.h"
+#include "ScenarioGenerator.h"
+#include "GeoIndex.h"
+#include "ShardedSimulation.h"
+#include <iostream>
+#include <sstream>
+#include <algorithm>
+#include <cstdlib>
+#include <chrono>
+#include <thread>
+#include <climits>
+
+static double percentile(vector<double> values, double fraction) {
+    if (values.empty()) return 0.0;
+    size_t rank = (size_t)(fraction * (values.size() - 1));
+    nth_element(values.begin(), values.begin() + rank, values.end());
+    return values[rank];
+}
+
+static vector<double> servedWaits(const AmbulanceSystem& system) {
+    vector<double> waits;
+    for (const Patient* patient : system.getPatients()) {
+        if (patient->served && !patient->cancelled) {
+            waits.push_back(patient->getWaitingTime());
+        }
+    }
+    return waits;
+}
+
+static bool parseScenarioArgs(const vector<string>& args, ScenarioParams& params) {
+    for (size_t i = 0; i < args.size(); i++) {
+        if (i + 1 >= args.size()) return false;
+        int value = atoi(args[i + 1].c_str());
+        if (args[i] == "--hospitals") params.hospitals = value;
+        else if (args[i] == "--cars") {
+            params.scCars = value / 3;
+            params.ncCars = value - params.scCars;
+        }
+        else if (args[i] == "--requests") params.requests = value;
+        else if (args[i] == "--horizon") params.horizon = value;
+        else if (args[i] == "--seed") params.seed = value;
+        else return false;
+        i++;
+    }
+    return true;
+}
+
+int benchDispatchCommand(const vector<string>& args) {
+    ScenarioParams params;
+    params.hospitals = 1000;
+    params.scCars = 6667;
+    params.ncCars = 13333;
+    params.requests = 200000;
+    params.cancellations = 2000;
+    params.horizon = 500;
+    params.scSpeed = 10;
+    params.ncSpeed = 8;
+    if (!parseScenarioArgs(args, params)) {
+        cerr << "Usage: ambulance_system bench-dispatch [--hospitals N] [--cars N] [--requests N] "
+             << "[--horizon T] [--seed S]" << endl;
+        return 1;
+    }
+
+    stringstream scenario;
+    ScenarioGenerator(params.seed).generate(params, scenario);
+    string text = scenario.str();
+
+    cout << "Scenario: " << params.hospitals << " hospitals, " << params.scCars + params.ncCars
+         << " cars, " << params.requests << " requests over " << params.horizon << " ticks" << endl;
+
+    DispatchMode modes[] = {GREEDY_DISPATCH, OPTIMAL_DISPATCH};
+    for (DispatchMode mode : modes) {
+        AmbulanceSystem system;
+        stringstream input(text);
+        system.loadFromStream(input);
+        system.setDispatchMode(mode);
+
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        system.runSimulation(false);
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        vector<double> waits = servedWaits(system);
+        double total = 0;
+        for (double wait : waits) total += wait;
+
+        cout << (mode == GREEDY_DISPATCH ? "greedy " : "optimal") << ": served " << waits.size()
+             << ", avg wait " << (waits.empty() ? 0.0 : total / waits.size())
+             << ", p95 wait " << percentile(waits, 0.95)
+             << ", p99 wait " << percentile(waits, 0.99)
+             << ", max wait " << percentile(waits, 1.0)
+             << ", run " << seconds << " s" << endl;
+
+        const BatchDispatcher* dispatcher = system.getBatchDispatcher();
+        if (dispatcher) {
+            const vector<double>& micros = dispatcher->getSolveMicros();
+            double sum = 0;
+            for (double value : micros) sum += value;
+            cout << "solver per tick: mean " << (micros.empty() ? 0.0 : sum / micros.size()) << " us"
+                 << ", p50 " << percentile(micros, 0.5) << " us"
+                 << ", p99 " << percentile(micros, 0.99) << " us"
+                 << ", max " << percentile(micros, 1.0) << " us"
+                 << " over " << micros.size() << " ticks, " << dispatcher->getTotalBids() << " bids" << endl;
+        }
+    }
+    return 0;
+}
+
+static string summaryText(AmbulanceSystem& system) {
+    system.calculateStatistics();
+    stringstream out;
+    AmbulanceSystem::writeOutput(out, system.getPatients(), system.getSummary());
+    return out.str();
+}
+
+template <class Dispatch, class Forward>
+static double timeSteps(const string& text, int endTime, Dispatch* dispatch, Forward* forward, string& output) {
+    AmbulanceSystem system;
+    stringstream input(text);
+    system.loadFromStream(input);
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (int time = 1; time <= endTime; time++) {
+        if (dispatch) system.processTimeStep(time, *dispatch, *forward);
+        else system.processTimeStep(time);
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    output = summaryText(system);
+    return seconds;
+}
+
+int benchPoliciesCommand(const vector<string>& args) {
+    ScenarioParams params;
+    params.hospitals = 200;
+    params.scCars = 1333;
+    params.ncCars = 2667;
+    params.requests = 100000;
+    params.cancellations = 1000;
+    params.horizon = 500;
+    params.scSpeed = 10;
+    params.ncSpeed = 8;
+    if (!parseScenarioArgs(args, params)) {
+        cerr << "Usage: ambulance_system bench-policies [--hospitals N] [--cars N] [--requests N] "
+             << "[--horizon T] [--seed S]" << endl;
+        return 1;
+    }
+
+    stringstream scenario;
+    ScenarioGenerator(params.seed).generate(params, scenario);
+    string text = scenario.str();
+
+    cout << "Scenario: " << params.hospitals << " hospitals, " << params.scCars + params.ncCars
+         << " cars, " << params.requests << " requests over " << params.horizon << " ticks" << endl;
+
+    int endTime = params.horizon + 1000;
+    const int repeats = 15;
+    double legacyBest = 0, policyBest = 0;
+    string legacyOutput, policyOutput;
+    for (int r = 0; r < repeats; r++) {
+        FixedTypeDispatch dispatch;
+        NoForwarding forward;
+        double legacy = timeSteps<FixedTypeDispatch, NoForwarding>(text, endTime, nullptr, nullptr, legacyOutput);
+        double policy = timeSteps(text, endTime, &dispatch, &forward, policyOutput);
+        legacyBest = (r == 0) ? legacy : min(legacyBest, legacy);
+        policyBest = (r == 0) ? policy : min(policyBest, policy);
+    }
+    cout << "legacy loop:             " << legacyBest * 1000.0 << " ms for " << endTime << " ticks" << endl;
+    cout << "FixedTypeDispatch loop:  " << policyBest * 1000.0 << " ms for " << endTime << " ticks ("
+         << (policyBest / legacyBest - 1.0) * 100.0 << "% vs legacy), output "
+         << (legacyOutput == policyOutput ? "identical" : "DIFFERENT") << endl;
+
+    struct Variant {
+        const char* name;
+        DispatchPolicyType dispatch;
+        ForwardPolicyType forward;
+    };
+    Variant variants[] = {
+        {"fixed-type", FIXED_TYPE_POLICY, NO_FORWARD_POLICY},
+        {"reserve-sc", RESERVE_SC_POLICY, NO_FORWARD_POLICY},
+        {"severity-sp", SEVERITY_SP_POLICY, NO_FORWARD_POLICY},
+        {"nearest-car", NEAREST_CAR_POLICY, NO_FORWARD_POLICY},
+        {"fixed-type + shortest-queue", FIXED_TYPE_POLICY, SHORTEST_QUEUE_FORWARD_POLICY},
+        {"fixed-type + nearest", FIXED_TYPE_POLICY, NEAREST_HOSPITAL_FORWARD_POLICY},
+    };
+    for (const Variant& variant : variants) {
+        AmbulanceSystem system;
+        stringstream input(text);
+        system.loadFromStream(input);
+        system.setDispatchPolicy(variant.dispatch);
+        system.setForwardPolicy(variant.forward);
+
+        streambuf* saved = cout.rdbuf(nullptr);
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        system.runSimulation(false);
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        cout.rdbuf(saved);
+
+        vector<double> waits = servedWaits(system);
+        double total = 0;
+        for (double wait : waits) total += wait;
+        cout << variant.name << ": served " << waits.size()
+             << ", avg wait " << (waits.empty() ? 0.0 : total / waits.size())
+             << ", p95 wait " << percentile(waits, 0.95)
+             << ", p99 wait " << percentile(waits, 0.99)
+             << ", run " << seconds << " s" << endl;
+    }
+    return 0;
+}
+
+static int bruteForceNearest(const vector<double>& x, const vector<double>& y, double px, double py) {
+    int best = -1;
+    double bestD2 = 0;
+    for (size_t h = 0; h < x.size(); h++) {
+        double d2 = (x[h] - px) * (x[h] - px) + (y[h] - py) * (y[h] - py);
+        if (best < 0 || d2 < bestD2) {
+            best = h;
+            bestD2 = d2;
+        }
+    }
+    return best;
+}
+
+int benchGeoCommand(const vector<string>& args) {
+    ScenarioParams params;
+    params.hospitals = 200;
+    params.requests = 1000000;
+    params.mapSize = 40000;
+    int threads = max(1u, thread::hardware_concurrency());
+
+    vector<string> scenarioArgs;
+    for (size_t i = 0; i < args.size(); i++) {
+        if (args[i] == "--threads" && i + 1 < args.size()) threads = max(1, atoi(args[++i].c_str()));
+        else scenarioArgs.push_back(args[i]);
+    }
+    if (!parseScenarioArgs(scenarioArgs, params) || params.hospitals < 1) {
+        cerr << "Usage: ambulance_system bench-geo [--hospitals N] [--requests N] [--threads N] [--seed S]" << endl;
+        return 1;
+    }
+
+    ScenarioGenerator generator(params.seed);
+    vector<GeoPoint> hospitals(params.hospitals), callers(params.requests);
+    for (GeoPoint& hospital : hospitals) hospital = generator.randomLocation(params);
+    for (GeoPoint& caller : callers) caller = generator.randomLocation(params);
+
+    cout << "Scenario: " << params.hospitals << " hospitals, " << params.requests << " callers in a "
+         << params.mapSize / 1000.0 << " km square" << endl;
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    GeoIndex index(hospitals);
+    double buildSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cout << "k-d tree build: " << buildSeconds * 1e6 << " us" << endl;
+
+    vector<int> nearest, distances;
+    int threadCounts[] = {1, threads};
+    for (int count : threadCounts) {
+        double best = 0;
+        for (int r = 0; r < 5; r++) {
+            start = chrono::steady_clock::now();
+            index.assign(callers, nearest, distances, count);
+            double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            best = (r == 0) ? seconds : min(best, seconds);
+        }
+        cout << "assign with " << count << " thread" << (count == 1 ? "" : "s") << ": " << best * 1000.0
+             << " ms, " << params.requests / best / 1e6 << " M requests/s" << endl;
+        if (threads == 1) break;
+    }
+
+    vector<double> x(params.hospitals), y(params.hospitals);
+    for (int h = 0; h < params.hospitals; h++) index.project(hospitals[h], x[h], y[h]);
+    int checked = min(params.requests, 100000), mismatches = 0;
+    start = chrono::steady_clock::now();
+    for (int i = 0; i < checked; i++) {
+        double px, py;
+        index.project(callers[i], px, py);
+        if (bruteForceNearest(x, y, px, py) != nearest[i]) mismatches++;
+    }
+    double bruteSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cout << "brute force check: " << mismatches << " mismatches in " << checked << " requests, "
+         << checked / bruteSeconds / 1e6 << " M requests/s" << endl;
+
+    stringstream text;
+    ScenarioGenerator(params.seed).generateGeo(params, text);
+    Scenario scenario;
+    start = chrono::steady_clock::now();
+    scenario.read(text);
+    double loadSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cout << "full GEO load (parse + assign): " << loadSeconds * 1000.0 << " ms, "
+         << params.requests / loadSeconds / 1e6 << " M requests/s" << endl;
+
+    return mismatches == 0 ? 0 : 1;
+}
+
+int benchShardsCommand(const vector<string>& args) {
+    ScenarioParams params;
+    params.hospitals = 1000;
+    params.scCars = 6667;
+    params.ncCars = 13333;
+    params.requests = 200000;
+    params.cancellations = 2000;
+    params.horizon = 1000;
+    params.scSpeed = 10;
+    params.ncSpeed = 8;
+    int maxShards = 16;
+    ForwardPolicyType forwardPolicy = NEAREST_HOSPITAL_FORWARD_POLICY;
+
+    vector<string> scenarioArgs;
+    bool valid = true;
+    for (size_t i = 0; i < args.size(); i++) {
+        if (args[i] == "--max-shards" && i + 1 < args.size()) maxShards = max(1, atoi(args[++i].c_str()));
+        else if (args[i] == "--forward" && i + 1 < args.size()) {
+            string name = args[++i];
+            if (name == "none") forwardPolicy = NO_FORWARD_POLICY;
+            else if (name != "nearest") valid = false;
+        }
+        else scenarioArgs.push_back(args[i]);
+    }
+    if (!valid || !parseScenarioArgs(scenarioArgs, params)) {
+        cerr << "Usage: ambulance_system bench-shards [--hospitals N] [--cars N] [--requests N] [--horizon T] "
+             << "[--seed S] [--max-shards N] [--forward none|nearest]" << endl;
+        return 1;
+    }
+
+    stringstream text;
+    ScenarioGenerator(params.seed).generate(params, text);
+    Scenario scenario;
+    scenario.read(text);
+
+    cout << "Scenario: " << params.hospitals << " hospitals, " << params.scCars + params.ncCars
+         << " cars, " << params.requests << " requests over " << params.horizon << " ticks, "
+         << thread::hardware_concurrency() << " hardware threads" << endl;
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    AmbulanceSystem system;
+    system.loadScenario(scenario);
+    system.setForwardPolicy(forwardPolicy);
+    streambuf* saved = cout.rdbuf(nullptr);
+    system.runSimulation(false);
+    cout.rdbuf(saved);
+    stringstream expected;
+    system.writeResults(expected);
+    double singleSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cout << "single process: " << singleSeconds * 1000.0 << " ms" << endl;
+
+    bool identical = true;
+    for (int shards = 1; shards <= maxShards; shards *= 2) {
+        ShardedSimulation simulation(scenario, shards, FIXED_TYPE_POLICY, forwardPolicy);
+        if (!simulation.run()) return 1;
+        stringstream output;
+        simulation.writeResults(output);
+        bool same = output.str() == expected.str();
+        identical = identical && same;
+
+        cout << simulation.getShardCount() << " shards: " << simulation.getWallSeconds() * 1000.0 << " ms"
+             << " (speedup " << singleSeconds / simulation.getWallSeconds() << "x)"
+             << ", slowest shard " << simulation.getMaxShardSeconds() * 1000.0 << " ms"
+             << ", mean shard " << simulation.getMeanShardSeconds() * 1000.0 << " ms"
+             << ", slowest shard CPU " << simulation.getMaxShardCpuSeconds() * 1000.0 << " ms"
+             << " (" << singleSeconds / simulation.getMaxShardCpuSeconds() << "x with a core per shard)"
+             << ", " << simulation.getSyncTickCount() << " sync ticks"
+             << ", " << simulation.getForwardsSent() << " cross-shard forwards"
+             << ", output " << (same ? "identical" : "DIFFERENT") << endl;
+    }
+    return identical ? 0 : 1;
+}
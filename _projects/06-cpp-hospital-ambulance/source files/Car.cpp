@@ -9,14 +9,17 @@ Car::Car(int id, CarType t, int sp, int hid) {
     status = READY;
     currentPatient = nullptr;
     remainingDistance = 0;
+    returnDistance = -1;
     busyStartTime = -1;
     totalBusyTime = 0;
 }
 
-void Car::assignPatient(Patient* p, int currentTime, int distance) {
+void Car::assignPatient(Patient* p, int currentTime, int distance, int backDistance) {
     currentPatient = p;
+    p->carHospitalId = hospitalId;
     status = ASSIGNED;
     remainingDistance = distance;
+    returnDistance = backDistance;
     busyStartTime = currentTime;
 }
 
@@ -35,7 +38,7 @@ void Car::pickupPatient(int currentTime) {
     if (currentPatient && status == ASSIGNED) {
         currentPatient->pickupTime = currentTime;
         status = LOADED;
-        remainingDistance = currentPatient->distanceToHospital;
+        remainingDistance = (returnDistance >= 0) ? returnDistance : currentPatient->distanceToHospital;
     }
 }
 
@@ -46,6 +49,7 @@ void Car::returnToHospital(int currentTime) {
         currentPatient = nullptr;
         status = READY;
         remainingDistance = 0;
+        returnDistance = -1;
         if (busyStartTime != -1) {
             totalBusyTime += (currentTime - busyStartTime);
             busyStartTime = -1;
@@ -57,6 +61,7 @@ void Car::reset() {
     currentPatient = nullptr;
     status = READY;
     remainingDistance = 0;
+    returnDistance = -1;
     if (busyStartTime != -1) {
         busyStartTime = -1;
     }
@@ -71,6 +76,7 @@ string Car::getStatusString() const {
         case READY: return "Ready";
         case ASSIGNED: return "Assigned";
         case LOADED: return "Loaded";
+        case OFFLINE: return "Offline";
         default: return "Unknown";
     }
 }
\ No newline at end of file
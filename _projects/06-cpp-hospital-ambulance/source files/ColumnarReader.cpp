@@ -0,0 +1,135 @@
+#include "ColumnarReader.h"
+#include "BinaryIO.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+ColumnarReader::ColumnarReader() {
+    fd = -1;
+    data = nullptr;
+    size = 0;
+    rowCount = 0;
+}
+
+ColumnarReader::~ColumnarReader() {
+    unmap();
+}
+
+void ColumnarReader::unmap() {
+    if (data) munmap((void*)data, size);
+    if (fd >= 0) ::close(fd);
+    fd = -1;
+    data = nullptr;
+    size = 0;
+    columns.clear();
+    blocks.clear();
+    rowCount = 0;
+}
+
+bool ColumnarReader::open(const string& filename) {
+    unmap();
+    fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size < 24) return false;
+    size = info.st_size;
+    void* mapped = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    if (mapped == MAP_FAILED) {
+        size = 0;
+        return false;
+    }
+    data = (const unsigned char*)mapped;
+
+    const unsigned char* trailer = data + size - 16;
+    if (getFixed32(data) != COLUMNAR_MAGIC || getFixed32(trailer + 12) != COLUMNAR_MAGIC ||
+        getFixed32(trailer + 8) != COLUMNAR_VERSION) {
+        return false;
+    }
+    uint64_t directoryOffset = getFixed64(trailer);
+    if (directoryOffset + 20 > size - 16) return false;
+
+    const unsigned char* p = data + directoryOffset;
+    const unsigned char* end = trailer;
+    uint32_t columnCount = getFixed32(p);
+    uint32_t blockCount = getFixed32(p + 16);
+    rowCount = getFixed64(p + 8);
+    p += 20;
+
+    if (columnCount > COLUMNAR_MAX_COLUMNS) return false;
+    for (uint32_t c = 0; c < columnCount; c++) {
+        if (p + 2 > end) return false;
+        Column column;
+        column.type = (ColumnType)p[0];
+        if (column.type != COLUMN_INT32 && column.type != COLUMN_UINT8) return false;
+        if (p + 2 + p[1] > end) return false;
+        column.name.assign((const char*)p + 2, p[1]);
+        p += 2 + p[1];
+        columns.push_back(column);
+    }
+
+    uint64_t rows = 0;
+    size_t entrySize = 16 + 16 * (size_t)columnCount;
+    for (uint32_t b = 0; b < blockCount; b++) {
+        if (p + entrySize > end) return false;
+        Block block;
+        uint64_t offset = getFixed64(p);
+        block.rows = getFixed32(p + 8);
+        block.nullColumns = getFixed32(p + 12);
+        p += 16;
+        for (uint32_t c = 0; c < columnCount; c++) {
+            block.minimum.push_back((int64_t)getFixed64(p));
+            block.maximum.push_back((int64_t)getFixed64(p + 8));
+            p += 16;
+            block.columnOffset.push_back(offset);
+            offset += (uint64_t)block.rows * columnWidth(columns[c].type);
+            offset = (offset + 7) / 8 * 8;
+        }
+        if (offset > directoryOffset) return false;
+        rows += block.rows;
+        blocks.push_back(block);
+    }
+    return rows == rowCount;
+}
+
+int ColumnarReader::findColumn(const string& name) const {
+    for (size_t c = 0; c < columns.size(); c++) {
+        if (columns[c].name == name) return c;
+    }
+    return -1;
+}
+
+// The minimum and maximum leave out null rows, so a range that takes in
+// COLUMNAR_NULL also matches any block the mask says has them
+bool ColumnarReader::mayContain(int block, int column, int64_t from, int64_t to) const {
+    if (blockHasNulls(block, column) && from <= COLUMNAR_NULL && COLUMNAR_NULL <= to) return true;
+    return blocks[block].maximum[column] >= from && blocks[block].minimum[column] <= to;
+}
+
+uint64_t ColumnarReader::exportCsv(ostream& out, int whereColumn, int64_t from, int64_t to, int& blocksRead) const {
+    for (size_t c = 0; c < columns.size(); c++) {
+        out << (c > 0 ? "," : "") << columns[c].name;
+    }
+    out << "\n";
+
+    uint64_t written = 0;
+    blocksRead = 0;
+    for (int b = 0; b < getBlockCount(); b++) {
+        if (whereColumn >= 0 && !mayContain(b, whereColumn, from, to)) continue;
+        blocksRead++;
+        for (int row = 0; row < blocks[b].rows; row++) {
+            if (whereColumn >= 0) {
+                int64_t key = value(b, whereColumn, row);
+                if (key < from || key > to) continue;
+            }
+            for (int c = 0; c < getColumnCount(); c++) {
+                if (c > 0) out << ",";
+                out << value(b, c, row);
+            }
+            out << "\n";
+            written++;
+        }
+    }
+    return written;
+}
@@ -0,0 +1,146 @@
+#include "ColumnarWriter.h"
+#include "BinaryIO.h"
+#include <cstring>
+#include <algorithm>
+
+const ColumnInfo RESULT_COLUMNS[RC_COUNT] = {
+    {"pid", COLUMN_INT32, false},
+    {"type", COLUMN_UINT8, false},
+    {"severity", COLUMN_INT32, false},
+    {"home_hospital", COLUMN_INT32, false},
+    {"car_hospital", COLUMN_INT32, true},
+    {"request_time", COLUMN_INT32, false},
+    {"pickup_time", COLUMN_INT32, true},
+    {"finish_time", COLUMN_INT32, true},
+    {"wait_time", COLUMN_INT32, true},
+    {"flags", COLUMN_UINT8, false},
+};
+
+ColumnarWriter::ColumnarWriter(int blockRows) : blockRows(max(1, blockRows)) {
+    columns.resize(RC_COUNT);
+    for (int c = 0; c < RC_COUNT; c++) {
+        columns[c].resize((size_t)this->blockRows * columnWidth(RESULT_COLUMNS[c].type));
+    }
+    startBlock();
+    offset = 0;
+    rowCount = 0;
+    blockCount = 0;
+}
+
+bool ColumnarWriter::open(const string& filename) {
+    file.open(filename, ios::binary | ios::trunc);
+    if (!file.is_open()) return false;
+
+    vector<unsigned char> header;
+    putFixed32(header, COLUMNAR_MAGIC);
+    putFixed32(header, COLUMNAR_VERSION);
+    file.write((const char*)header.data(), header.size());
+    offset = header.size();
+    pad(COLUMNAR_ALIGNMENT);
+    return true;
+}
+
+void ColumnarWriter::pad(uint64_t alignment) {
+    static const char zeros[COLUMNAR_ALIGNMENT] = {0};
+    uint64_t padding = (alignment - offset % alignment) % alignment;
+    file.write(zeros, padding);
+    offset += padding;
+}
+
+void ColumnarWriter::setValue(int column, int64_t value) {
+    if (RESULT_COLUMNS[column].type == COLUMN_INT32) {
+        int32_t narrow = (int32_t)value;
+        memcpy(&columns[column][(size_t)rowsInBlock * 4], &narrow, 4);
+    } else {
+        columns[column][rowsInBlock] = (unsigned char)value;
+    }
+    if (RESULT_COLUMNS[column].nullable && value == COLUMNAR_NULL) {
+        nullColumns |= 1u << column;
+        return;
+    }
+    minimum[column] = min(minimum[column], value);
+    maximum[column] = max(maximum[column], value);
+}
+
+void ColumnarWriter::startBlock() {
+    rowsInBlock = 0;
+    nullColumns = 0;
+    for (int c = 0; c < RC_COUNT; c++) {
+        minimum[c] = INT64_MAX;
+        maximum[c] = INT64_MIN;
+    }
+}
+
+void ColumnarWriter::append(const Patient* patient) {
+    int flags = 0;
+    if (patient->served) flags |= RF_SERVED;
+    if (patient->cancelled) flags |= RF_CANCELLED;
+    if (patient->type == EP && patient->carHospitalId > 0 && patient->carHospitalId != patient->nearestHospitalId) {
+        flags |= RF_FORWARDED;
+    }
+
+    setValue(RC_PID, patient->pid);
+    setValue(RC_TYPE, patient->type);
+    setValue(RC_SEVERITY, patient->severity);
+    setValue(RC_HOME_HOSPITAL, patient->nearestHospitalId);
+    setValue(RC_CAR_HOSPITAL, patient->carHospitalId);
+    setValue(RC_REQUEST_TIME, patient->requestTime);
+    setValue(RC_PICKUP_TIME, patient->pickupTime);
+    setValue(RC_FINISH_TIME, patient->finishTime);
+    setValue(RC_WAIT_TIME, patient->getWaitingTime());
+    setValue(RC_FLAGS, flags);
+
+    rowCount++;
+    if (++rowsInBlock == blockRows) flushBlock();
+}
+
+void ColumnarWriter::flushBlock() {
+    if (rowsInBlock == 0) return;
+
+    putFixed64(directory, offset);
+    putFixed32(directory, rowsInBlock);
+    putFixed32(directory, nullColumns);
+    for (int c = 0; c < RC_COUNT; c++) {
+        putFixed64(directory, (uint64_t)minimum[c]);
+        putFixed64(directory, (uint64_t)maximum[c]);
+    }
+
+    for (int c = 0; c < RC_COUNT; c++) {
+        size_t bytes = (size_t)rowsInBlock * columnWidth(RESULT_COLUMNS[c].type);
+        file.write((const char*)columns[c].data(), bytes);
+        offset += bytes;
+        pad(8);
+    }
+    pad(COLUMNAR_ALIGNMENT);
+
+    blockCount++;
+    startBlock();
+}
+
+bool ColumnarWriter::close() {
+    flushBlock();
+
+    uint64_t directoryOffset = offset;
+    vector<unsigned char> header;
+    putFixed32(header, RC_COUNT);
+    putFixed32(header, blockRows);
+    putFixed64(header, rowCount);
+    putFixed32(header, blockCount);
+    for (int c = 0; c < RC_COUNT; c++) {
+        size_t length = strlen(RESULT_COLUMNS[c].name);
+        header.push_back((unsigned char)RESULT_COLUMNS[c].type);
+        header.push_back((unsigned char)length);
+        header.insert(header.end(), RESULT_COLUMNS[c].name, RESULT_COLUMNS[c].name + length);
+    }
+
+    vector<unsigned char> trailer;
+    putFixed64(trailer, directoryOffset);
+    putFixed32(trailer, COLUMNAR_VERSION);
+    putFixed32(trailer, COLUMNAR_MAGIC);
+
+    file.write((const char*)header.data(), header.size());
+    file.write((const char*)directory.data(), directory.size());
+    file.write((const char*)trailer.data(), trailer.size());
+    file.close();
+    return !file.fail();
+}
@@ -0,0 +1,279 @@
+#include "DifferentialOracle.h"
+#include "ScenarioGenerator.h"
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <sstream>
+
+void RewindEngine::load(const Scenario& scenario) {
+    system.loadScenario(scenario);
+    system.saveSnapshot(checkpoint, nullptr);
+}
+
+bool RewindEngine::step() {
+    if (!system.step(dispatch, forward)) return false;
+
+    int target = system.getCurrentTime();
+    if (target - checkpoint.time < interval) return true;
+
+    system.restoreSnapshot(checkpoint);
+    while (system.getCurrentTime() < target) {
+        if (!system.step(dispatch, forward)) return false;
+    }
+    SimulationSnapshot next;
+    system.saveSnapshot(next, &checkpoint);
+    checkpoint = next;
+    return true;
+}
+
+DifferentialOracle::DifferentialOracle(const string& engineName, int interval)
+    : engineName(engineName), interval(interval) {
+    ticksCompared = 0;
+    runs = 0;
+}
+
+OracleEngine* DifferentialOracle::createEngine(const string& name, int interval) {
+    if (name == "policy") return new PolicyEngine<FixedTypeDispatch>();
+    if (name == "rewind") return new RewindEngine(max(1, interval));
+    if (name == "reserve-sc") return new PolicyEngine<ReserveScForEP>();
+    if (name == "severity-sp") return new PolicyEngine<SeverityWeightedSP>();
+    return nullptr;
+}
+
+uint64_t DifferentialOracle::mix(uint64_t hash, uint64_t value) {
+    hash ^= value + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+    return hash * 0xff51afd7ed558ccdULL;
+}
+
+uint64_t DifferentialOracle::carHash(const Car* car) {
+    uint64_t hash = mix(car->carId, car->type);
+    hash = mix(hash, car->status);
+    hash = mix(hash, car->currentPatient ? car->currentPatient->pid : -1);
+    hash = mix(hash, car->remainingDistance);
+    hash = mix(hash, car->returnDistance);
+    hash = mix(hash, car->busyStartTime);
+    return mix(hash, car->totalBusyTime);
+}
+
+uint64_t DifferentialOracle::hospitalHash(const Hospital* hospital) {
+    uint64_t hash = mix(hospital->hospitalId, hospital->epNotServed);
+    hash = mix(hash, hospital->offlinePending[NC]);
+    hash = mix(hash, hospital->offlinePending[SC]);
+    for (const Car* car : hospital->cars) {
+        hash = mix(hash, carHash(car));
+    }
+
+    hash = mix(hash, hospital->epQueue.size());
+    for (const Patient* patient : queueContainer(hospital->epQueue)) hash = mix(hash, patient->pid);
+    hash = mix(hash, hospital->spQueue.size());
+    for (const Patient* patient : queueContainer(hospital->spQueue)) hash = mix(hash, patient->pid);
+    hash = mix(hash, hospital->npQueue.size());
+    for (const Patient* patient : queueContainer(hospital->npQueue)) hash = mix(hash, patient->pid);
+    return hash;
+}
+
+uint64_t DifferentialOracle::stateHash(AmbulanceSystem& system) {
+    uint64_t hash = 0;
+    for (int h = 1; h <= system.getHospitalCount(); h++) {
+        hash += mix(h, hospitalHash(system.getHospital(h)));
+    }
+    return hash;
+}
+
+string DifferentialOracle::describeCar(const Car* car) {
+    stringstream text;
+    text << car->getStatusString();
+    if (car->currentPatient) text << " patient " << car->currentPatient->pid;
+    text << " remaining " << car->remainingDistance << " return " << car->returnDistance
+         << " busy " << car->busyStartTime << "/" << car->totalBusyTime;
+    return text.str();
+}
+
+template <class Container>
+static void describeQueue(stringstream& text, const char* name, const Container& patients) {
+    text << name << " [";
+    for (size_t i = 0; i < patients.size() && i < 8; i++) {
+        text << (i ? " " : "") << patients[i]->pid;
+    }
+    if (patients.size() > 8) text << " ...";
+    text << "] ";
+}
+
+string DifferentialOracle::describeQueues(const Hospital* hospital) {
+    stringstream text;
+    describeQueue(text, "EP", queueContainer(hospital->epQueue));
+    describeQueue(text, "SP", queueContainer(hospital->spQueue));
+    describeQueue(text, "NP", queueContainer(hospital->npQueue));
+    text << "epNotServed " << hospital->epNotServed << " offline pending " << hospital->offlinePending[SC] << "/"
+         << hospital->offlinePending[NC];
+    return text.str();
+}
+
+void DifferentialOracle::locate(AmbulanceSystem& reference, AmbulanceSystem& engine,
+                                Divergence& divergence) const {
+    for (int h = 1; h <= reference.getHospitalCount(); h++) {
+        const Hospital* expected = reference.getHospital(h);
+        const Hospital* actual = engine.getHospital(h);
+        if (hospitalHash(expected) == hospitalHash(actual)) continue;
+
+        divergence.hospitalId = h;
+        for (size_t c = 0; c < expected->cars.size(); c++) {
+            if (carHash(expected->cars[c]) == carHash(actual->cars[c])) continue;
+            divergence.carId = expected->cars[c]->carId;
+            divergence.detail = expected->cars[c]->getTypeString() + " car: reference " +
+                                describeCar(expected->cars[c]) + "; " + engineName + " " +
+                                describeCar(actual->cars[c]);
+            return;
+        }
+        divergence.detail = "queues: reference " + describeQueues(expected) + "; " + engineName + " " +
+                            describeQueues(actual);
+        return;
+    }
+}
+
+bool DifferentialOracle::findDivergence(const Scenario& scenario, Divergence& divergence) {
+    runs++;
+    ReferenceEngine reference;
+    unique_ptr<OracleEngine> engine(createEngine(engineName, interval));
+    reference.load(scenario);
+    engine->load(scenario);
+
+    divergence.hospitalId = divergence.carId = -1;
+    divergence.detail.clear();
+    while (true) {
+        int time = reference.state().getCurrentTime();
+        bool referenceRunning = reference.step();
+        bool engineRunning = engine->step();
+        ticksCompared++;
+
+        if (stateHash(reference.state()) != stateHash(engine->state())) {
+            divergence.time = time;
+            locate(reference.state(), engine->state(), divergence);
+            return true;
+        }
+        if (referenceRunning != engineRunning) {
+            divergence.time = time;
+            divergence.detail = referenceRunning ? engineName + " finished while the reference was still running"
+                                                 : "reference finished while " + engineName + " was still running";
+            return true;
+        }
+        if (!referenceRunning) break;
+    }
+
+    stringstream expected, actual;
+    reference.state().writeResults(expected);
+    engine->state().writeResults(actual);
+    if (expected.str() == actual.str()) return false;
+    divergence.time = reference.state().getCurrentTime();
+    divergence.detail = "final output differs";
+    return true;
+}
+
+Scenario DifferentialOracle::removeHospital(const Scenario& scenario, int hospital) {
+    Scenario result = scenario;
+    result.distances.erase(result.distances.begin() + hospital);
+    for (vector<int>& row : result.distances) {
+        row.erase(row.begin() + hospital);
+    }
+    result.scCars.erase(result.scCars.begin() + hospital);
+    result.ncCars.erase(result.ncCars.begin() + hospital);
+
+    result.requests.clear();
+    for (ScenarioRequest request : scenario.requests) {
+        if (request.hospitalId == hospital + 1) continue;
+        if (request.hospitalId > hospital + 1) request.hospitalId--;
+        result.requests.push_back(request);
+    }
+    return result;
+}
+
+template <class T>
+bool DifferentialOracle::removeChunks(Scenario& current, vector<T> Scenario::*items, Divergence& divergence,
+                                      int limit) {
+    bool progress = false;
+    for (size_t chunk = max<size_t>(1, (current.*items).size() / 2); runs < limit; chunk /= 2) {
+        for (size_t i = 0; i < (current.*items).size() && runs < limit;) {
+            Scenario candidate = current;
+            vector<T>& list = candidate.*items;
+            list.erase(list.begin() + i, list.begin() + min(list.size(), i + chunk));
+
+            Divergence found;
+            if (findDivergence(candidate, found)) {
+                current = candidate;
+                divergence = found;
+                progress = true;
+            } else {
+                i += chunk;
+            }
+        }
+        if (chunk == 1) break;
+    }
+    return progress;
+}
+
+bool DifferentialOracle::reduceCars(Scenario& current, vector<int> Scenario::*cars, Divergence& divergence,
+                                    int limit) {
+    bool progress = false;
+    for (int h = 0; h < current.hospitalCount(); h++) {
+        while ((current.*cars)[h] > 0 && runs < limit) {
+            int count = (current.*cars)[h];
+            Scenario candidate = current;
+            Divergence found;
+            (candidate.*cars)[h] = count / 2;
+            bool diverges = findDivergence(candidate, found);
+            if (!diverges && count / 2 != count - 1 && runs < limit) {
+                (candidate.*cars)[h] = count - 1;
+                diverges = findDivergence(candidate, found);
+            }
+            if (!diverges) break;
+            current = candidate;
+            divergence = found;
+            progress = true;
+        }
+    }
+    return progress;
+}
+
+Scenario DifferentialOracle::shrink(const Scenario& scenario, Divergence& divergence, int maxRuns) {
+    Scenario current = scenario;
+    int limit = runs + maxRuns;
+    bool progress = true;
+    while (progress && runs < limit) {
+        progress = false;
+        for (int h = current.hospitalCount() - 1; h >= 0 && current.hospitalCount() > 1 && runs < limit; h--) {
+            Scenario candidate = removeHospital(current, h);
+            Divergence found;
+            if (findDivergence(candidate, found)) {
+                current = candidate;
+                divergence = found;
+                progress = true;
+            }
+        }
+        progress |= removeChunks(current, &Scenario::requests, divergence, limit);
+        progress |= removeChunks(current, &Scenario::cancellations, divergence, limit);
+        progress |= reduceCars(current, &Scenario::scCars, divergence, limit);
+        progress |= reduceCars(current, &Scenario::ncCars, divergence, limit);
+    }
+    return current;
+}
+
+Scenario DifferentialOracle::randomScenario(uint32_t seed) {
+    mt19937 random(seed);
+    ScenarioParams params;
+    params.hospitals = uniform_int_distribution<int>(1, 6)(random);
+    params.scCars = uniform_int_distribution<int>(0, 3 * params.hospitals)(random);
+    params.ncCars = uniform_int_distribution<int>(0, 4 * params.hospitals)(random);
+    params.requests = uniform_int_distribution<int>(1, 300)(random);
+    params.cancellations = uniform_int_distribution<int>(0, params.requests / 5)(random);
+    params.horizon = uniform_int_distribution<int>(10, 300)(random);
+    params.mapSize = uniform_int_distribution<int>(100, 2000)(random);
+    params.scSpeed = uniform_int_distribution<int>(5, 120)(random);
+    params.ncSpeed = uniform_int_distribution<int>(5, 120)(random);
+    params.seed = seed;
+
+    stringstream text;
+    ScenarioGenerator(seed).generate(params, text);
+    Scenario scenario;
+    scenario.read(text);
+    return scenario;
+}
@@ -0,0 +1,55 @@
+#include "DispatchPolicies.h"
+#include <algorithm>
+#include <climits>
+
+vector<vector<int>> nearestHospitals(const vector<vector<int>>& distances, int count) {
+    int H = distances.size();
+    int K = min(H, count);
+    vector<vector<int>> neighbours(H);
+    vector<int> order(H);
+    for (int h = 0; h < H; h++) {
+        for (int n = 0; n < H; n++) order[n] = n;
+        partial_sort(order.begin(), order.begin() + K, order.end(),
+                     [&](int a, int b) {
+                         int da = (a == h) ? -1 : distances[a][h];
+                         int db = (b == h) ? -1 : distances[b][h];
+                         return da < db || (da == db && a < b);
+                     });
+        neighbours[h].assign(order.begin(), order.begin() + K);
+    }
+    return neighbours;
+}
+
+NearestReadyCarAcrossHospitals::NearestReadyCarAcrossHospitals(const vector<Hospital*>& hospitals,
+                                                               const vector<vector<int>>& distances)
+    : hospitals(hospitals), distances(distances), borrowing(true) {
+    neighbours = nearestHospitals(distances, NEIGHBOUR_COUNT + 1);
+}
+
+Hospital* ShortestEPQueueForwarding::destination(int currentHospitalId) const {
+    Hospital* bestHospital = nullptr;
+    int minQueueLength = INT_MAX;
+    int minDistance = INT_MAX;
+
+    for (Hospital* hospital : hospitals) {
+        if (hospital->hospitalId == currentHospitalId) continue;
+
+        int queueLength = hospital->epQueue.size();
+        int distance = distances[currentHospitalId - 1][hospital->hospitalId - 1];
+
+        if (queueLength < minQueueLength ||
+           (queueLength == minQueueLength && distance < minDistance)) {
+            minQueueLength = queueLength;
+            minDistance = distance;
+            bestHospital = hospital;
+        }
+    }
+
+    return bestHospital;
+}
+
+NearestHospitalForwarding::NearestHospitalForwarding(const vector<Hospital*>& hospitals,
+                                                     const vector<vector<int>>& distances)
+    : hospitals(hospitals) {
+    neighbours = nearestHospitals(distances, NEIGHBOUR_COUNT + 1);
+}
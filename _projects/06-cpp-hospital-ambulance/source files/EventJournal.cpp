@@ -0,0 +1,154 @@
+#include "EventJournal.h"
+#include "Hospital.h"
+#include "BinaryIO.h"
+#include <iostream>
+#include <algorithm>
+
+EventJournal::EventJournal() {
+    flushedBytes = 0;
+    eventCount = 0;
+    eventsSinceIndex = 0;
+    currentTime = 0;
+    writtenTime = 0;
+}
+
+EventJournal::~EventJournal() {
+    if (file.is_open()) {
+        flush();
+        file.close();
+    }
+}
+
+bool EventJournal::open(const string& filename) {
+    file.open(filename, ios::binary | ios::trunc);
+    if (!file.is_open()) {
+        cerr << "Error creating journal file: " << filename << endl;
+        return false;
+    }
+    buffer.reserve(1 << 20);
+    return true;
+}
+
+void EventJournal::writeHeader(int scSpeed, int ncSpeed, const vector<Hospital*>& hospitals,
+                               const vector<Patient*>& patients) {
+    putFixed32(buffer, JOURNAL_MAGIC);
+    putVarint(buffer, JOURNAL_VERSION);
+    putVarint(buffer, scSpeed);
+    putVarint(buffer, ncSpeed);
+
+    putVarint(buffer, hospitals.size());
+    carBase.assign(1, 0);
+    for (Hospital* hospital : hospitals) {
+        carBase.push_back(carBase.back() + hospital->cars.size());
+        putVarint(buffer, hospital->cars.size());
+        for (Car* car : hospital->cars) {
+            buffer.push_back((unsigned char)car->type);
+        }
+    }
+
+    putVarint(buffer, patients.size());
+    for (Patient* patient : patients) {
+        putVarint(buffer, zigzagEncode(patient->pid));
+        buffer.push_back((unsigned char)patient->type);
+        putVarint(buffer, zigzagEncode(patient->requestTime));
+        putVarint(buffer, patient->nearestHospitalId);
+        putVarint(buffer, zigzagEncode(patient->distanceToHospital));
+        putVarint(buffer, zigzagEncode(patient->severity));
+    }
+    flush();
+}
+
+void EventJournal::flush() {
+    if (buffer.empty()) return;
+    file.write((const char*)buffer.data(), buffer.size());
+    flushedBytes += buffer.size();
+    buffer.clear();
+}
+
+void EventJournal::beginTick(int time) {
+    currentTime = time;
+}
+
+void EventJournal::startEvent(JournalEvent type) {
+    if (currentTime != writtenTime) {
+        if (eventsSinceIndex >= JOURNAL_INDEX_INTERVAL || index.empty()) {
+            JournalIndexEntry entry = {currentTime, writtenTime, flushedBytes + buffer.size(), eventCount};
+            index.push_back(entry);
+            eventsSinceIndex = 0;
+        }
+        buffer.push_back(JE_TICK);
+        putVarint(buffer, currentTime - writtenTime);
+        writtenTime = currentTime;
+    }
+    buffer.push_back((unsigned char)type);
+    eventCount++;
+    eventsSinceIndex++;
+    if (buffer.size() >= (1 << 20)) {
+        flush();
+    }
+}
+
+void EventJournal::putCar(int hospitalId, int carId) {
+    putVarint(buffer, carBase[hospitalId - 1] + carId - 1);
+}
+
+void EventJournal::recordArrival(const Patient* patient) {
+    startEvent(JE_ARRIVAL);
+    putVarint(buffer, patient->index);
+}
+
+void EventJournal::recordQueueInsert(int hospitalId, const Patient* patient) {
+    startEvent(JE_QUEUE_INSERT);
+    putVarint(buffer, hospitalId);
+    putVarint(buffer, patient->index);
+}
+
+void EventJournal::recordAssign(int hospitalId, int carId, const Patient* patient) {
+    startEvent(JE_ASSIGN);
+    putCar(hospitalId, carId);
+    putVarint(buffer, patient->index);
+}
+
+void EventJournal::recordPickup(int hospitalId, int carId) {
+    startEvent(JE_PICKUP);
+    putCar(hospitalId, carId);
+}
+
+void EventJournal::recordReturn(int hospitalId, int carId) {
+    startEvent(JE_RETURN);
+    putCar(hospitalId, carId);
+}
+
+void EventJournal::recordCancel(int hospitalId, int carId) {
+    startEvent(JE_CANCEL);
+    putCar(hospitalId, carId);
+}
+
+void EventJournal::recordForward(int fromHospitalId, int toHospitalId, const Patient* patient) {
+    startEvent(JE_EP_FORWARD);
+    putVarint(buffer, fromHospitalId);
+    putVarint(buffer, toHospitalId);
+    putVarint(buffer, patient->index);
+}
+
+void EventJournal::close(int endTime) {
+    if (!file.is_open()) return;
+
+    currentTime = max(endTime, writtenTime);
+    startEvent(JE_END);
+    putVarint(buffer, currentTime);
+
+    uint64_t indexOffset = flushedBytes + buffer.size();
+    for (const JournalIndexEntry& entry : index) {
+        putVarint(buffer, entry.time);
+        putVarint(buffer, entry.previousTime);
+        putVarint(buffer, entry.offset);
+        putVarint(buffer, entry.eventCount);
+    }
+    putFixed64(buffer, indexOffset);
+    putFixed32(buffer, index.size());
+    putFixed32(buffer, JOURNAL_INDEX_MAGIC);
+
+    flush();
+    file.close();
+}
@@ -0,0 +1,254 @@
+#include "FleetOptimizer.h"
+#include "AmbulanceSystem.h"
+#include <algorithm>
+#include <climits>
+#include <set>
+#include <thread>
+#include <atomic>
+
+FleetOptimizer::FleetOptimizer(const Scenario& scenario, const ServiceTarget& target, int scCost,
+                               int ncCost, int threads)
+    : scenario(scenario), target(target), scCost(scCost), ncCost(ncCost), threadCount(max(1, threads)) {
+    evaluations = cacheHits = reusedRuns = abortedRuns = prunedMoves = rounds = 0;
+
+    set<int> cancelledIds;
+    for (const RequestCancellation& cancellation : scenario.cancellations) {
+        cancelledIds.insert(cancellation.patientId);
+    }
+
+    targetPatients = 0;
+    for (size_t i = 0; i < scenario.requests.size(); i++) {
+        const ScenarioRequest& request = scenario.requests[i];
+        if (request.type != target.type) continue;
+        targetPatients++;
+        if (!cancelledIds.count(request.patientId)) {
+            watchedPatients.push_back(i);
+        }
+    }
+    stable_sort(watchedPatients.begin(), watchedPatients.end(),
+                [&](int a, int b) { return scenario.requests[a].requestTime < scenario.requests[b].requestTime; });
+
+    int n = targetPatients;
+    allowedMisses = (n > 0) ? n - 1 - (int)(target.percentile / 100.0 * (n - 1)) : INT_MAX;
+}
+
+int FleetOptimizer::cost(const vector<int>& scCars, const vector<int>& ncCars) const {
+    int total = 0;
+    for (size_t i = 0; i < scCars.size(); i++) {
+        total += scCars[i] * scCost + ncCars[i] * ncCost;
+    }
+    return total;
+}
+
+FleetEvaluation FleetOptimizer::simulate(const vector<int>& fleet, vector<int>& peakBusy) const {
+    int H = scenario.hospitalCount();
+    vector<int> scCars(fleet.begin(), fleet.begin() + H);
+    vector<int> ncCars(fleet.begin() + H, fleet.end());
+
+    AmbulanceSystem system;
+    system.loadScenario(scenario, scCars, ncCars);
+    FixedTypeDispatch dispatch;
+    NoForwarding forward;
+    const vector<Patient*>& patients = system.getPatients();
+
+    FleetEvaluation result = {false, false, -1, 0, 0};
+    size_t next = 0;
+    bool running = true;
+    while (running) {
+        int time = system.getCurrentTime();
+        running = system.step(dispatch, forward);
+
+        while (next < watchedPatients.size() &&
+               patients[watchedPatients[next]]->requestTime + target.maxWait <= time) {
+            if (patients[watchedPatients[next]]->pickupTime == -1) result.misses++;
+            next++;
+        }
+        if (result.misses > allowedMisses) {
+            result.aborted = true;
+            result.endTime = time;
+            break;
+        }
+    }
+
+    peakBusy.assign(2 * H, 0);
+    for (int h = 0; h < H; h++) {
+        const Hospital* hospital = system.getHospital(h + 1);
+        peakBusy[h] = max(0, scCars[h] - hospital->fewestReady[SC]);
+        peakBusy[H + h] = max(0, ncCars[h] - hospital->fewestReady[NC]);
+    }
+    if (result.aborted) return result;
+    result.endTime = system.getCurrentTime();
+
+    vector<int> waits;
+    for (const Patient* patient : patients) {
+        if (patient->type != target.type || patient->cancelled) continue;
+        waits.push_back(patient->pickupTime == -1 ? INT_MAX : patient->getWaitingTime());
+    }
+    if (waits.empty()) {
+        result.feasible = true;
+        result.percentileWait = 0;
+        return result;
+    }
+
+    size_t rank = (size_t)(target.percentile / 100.0 * (waits.size() - 1));
+    nth_element(waits.begin(), waits.begin() + rank, waits.end());
+    result.percentileWait = waits[rank];
+    result.feasible = waits[rank] <= target.maxWait;
+    return result;
+}
+
+// Fixed-type dispatch sends a car the moment it finds one ready, and cars of
+// one type at one hospital are interchangeable. A hospital and type that never
+// ran out in the parent's run plays out the same with any count down to its
+// peak, so a fleet that only differs from the parent there has the same run
+bool FleetOptimizer::sameRun(const vector<int>& fleet, const vector<int>& parent, const FleetRun& run) const {
+    for (size_t m = 0; m < fleet.size(); m++) {
+        if (fleet[m] == parent[m]) continue;
+        if (parent[m] == run.peakBusy[m] || fleet[m] < run.peakBusy[m]) return false;
+    }
+    return true;
+}
+
+// Fleets the cache has, or that sameRun finds identical to the parent's run,
+// are not simulated. The parent may be empty
+void FleetOptimizer::evaluateAll(const vector<vector<int>>& fleets, const vector<int>& parent,
+                                 vector<FleetEvaluation>& results) {
+    map<vector<int>, FleetRun>::iterator parentRun = cache.find(parent);
+    results.assign(fleets.size(), FleetEvaluation());
+    vector<size_t> pending;
+    for (size_t i = 0; i < fleets.size(); i++) {
+        map<vector<int>, FleetRun>::iterator cached = cache.find(fleets[i]);
+        if (cached != cache.end()) {
+            results[i] = cached->second.result;
+            cacheHits++;
+        } else if (parentRun != cache.end() && sameRun(fleets[i], parent, parentRun->second)) {
+            results[i] = parentRun->second.result;
+            cache[fleets[i]] = parentRun->second;
+            reusedRuns++;
+        } else {
+            pending.push_back(i);
+        }
+    }
+
+    vector<vector<int>> peaks(pending.size());
+    atomic<size_t> nextJob(0);
+    auto worker = [&]() {
+        size_t job;
+        while ((job = nextJob++) < pending.size()) {
+            results[pending[job]] = simulate(fleets[pending[job]], peaks[job]);
+        }
+    };
+
+    vector<thread> workers;
+    int extra = min((int)pending.size(), threadCount) - 1;
+    for (int t = 0; t < extra; t++) {
+        workers.push_back(thread(worker));
+    }
+    worker();
+    for (thread& t : workers) {
+        t.join();
+    }
+
+    for (size_t job = 0; job < pending.size(); job++) {
+        FleetRun& run = cache[fleets[pending[job]]];
+        run.result = results[pending[job]];
+        run.peakBusy.swap(peaks[job]);
+        evaluations++;
+        if (run.result.aborted) abortedRuns++;
+    }
+}
+
+FleetEvaluation FleetOptimizer::evaluate(const vector<int>& fleet) {
+    vector<FleetEvaluation> results;
+    evaluateAll(vector<vector<int>>(1, fleet), vector<int>(), results);
+    return results[0];
+}
+
+bool FleetOptimizer::optimize(vector<int>& scCars, vector<int>& ncCars, FleetEvaluation& result) {
+    int H = scenario.hospitalCount();
+    vector<int> fleet(scCars);
+    fleet.insert(fleet.end(), ncCars.begin(), ncCars.end());
+
+    result = evaluate(fleet);
+    for (int step = 0; !result.feasible && step < MAX_SCALE_STEPS; step++) {
+        for (int& count : fleet) {
+            count = max(1, count * 2);
+        }
+        result = evaluate(fleet);
+    }
+    if (!result.feasible) return false;
+
+    pruned.assign(2 * H, false);
+    vector<int> stepSize(2 * H);
+    for (int move = 0; move < 2 * H; move++) {
+        stepSize[move] = max(1, fleet[move] / 2);
+    }
+
+    while (true) {
+        vector<int> moves;
+        vector<vector<int>> candidates;
+        for (int move = 0; move < 2 * H; move++) {
+            if (pruned[move] || fleet[move] == 0) continue;
+            stepSize[move] = min(stepSize[move], fleet[move]);
+            moves.push_back(move);
+            candidates.push_back(fleet);
+            candidates.back()[move] -= stepSize[move];
+        }
+        if (moves.empty()) break;
+
+        vector<FleetEvaluation> results;
+        evaluateAll(candidates, fleet, results);
+
+        vector<int> feasibleMoves;
+        vector<int> slack(2 * H, 0);
+        for (size_t i = 0; i < moves.size(); i++) {
+            int move = moves[i];
+            if (results[i].feasible) {
+                feasibleMoves.push_back(move);
+                slack[move] = target.maxWait - results[i].percentileWait;
+            } else if (stepSize[move] > 1) {
+                stepSize[move] /= 2;
+            } else {
+                pruned[move] = true;
+                prunedMoves++;
+            }
+        }
+        rounds++;
+        if (feasibleMoves.empty()) continue;
+
+        sort(feasibleMoves.begin(), feasibleMoves.end(), [&](int a, int b) {
+            int savingA = stepSize[a] * ((a < H) ? scCost : ncCost);
+            int savingB = stepSize[b] * ((b < H) ? scCost : ncCost);
+            if (savingA != savingB) return savingA > savingB;
+            if (slack[a] != slack[b]) return slack[a] > slack[b];
+            return a < b;
+        });
+
+        vector<size_t> batchSizes;
+        candidates.clear();
+        for (size_t k = feasibleMoves.size(); k > 1; k /= 2) {
+            batchSizes.push_back(k);
+            candidates.push_back(fleet);
+            for (size_t i = 0; i < k; i++) {
+                candidates.back()[feasibleMoves[i]] -= stepSize[feasibleMoves[i]];
+            }
+        }
+        evaluateAll(candidates, fleet, results);
+
+        size_t applied = 1;
+        for (size_t i = 0; i < batchSizes.size(); i++) {
+            if (results[i].feasible) {
+                applied = batchSizes[i];
+                break;
+            }
+        }
+        for (size_t i = 0; i < applied; i++) {
+            fleet[feasibleMoves[i]] -= stepSize[feasibleMoves[i]];
+        }
+    }
+
+    result = evaluate(fleet);
+    scCars.assign(fleet.begin(), fleet.begin() + H);
+    ncCars.assign(fleet.begin() + H, fleet.end());
+    return true;
+}
@@ -0,0 +1,156 @@
+#include "GeoIndex.h"
+#include <algorithm>
+#include <cmath>
+#include <climits>
+#include <thread>
+
+static const double METRES_PER_DEGREE = 6371000.0 * M_PI / 180.0;
+static const double PADDING = 1e30;
+
+GeoIndex::GeoIndex(const vector<GeoPoint>& hospitals) {
+    int H = hospitals.size();
+    originLat = originLon = 0;
+    for (const GeoPoint& hospital : hospitals) {
+        originLat += hospital.lat;
+        originLon += hospital.lon;
+    }
+    if (H > 0) {
+        originLat /= H;
+        originLon /= H;
+    }
+    metresPerLon = METRES_PER_DEGREE * cos(originLat * M_PI / 180.0);
+
+    vector<double> x(H), y(H);
+    vector<int> order(H);
+    for (int h = 0; h < H; h++) {
+        project(hospitals[h], x[h], y[h]);
+        order[h] = h;
+    }
+    if (H > 0) build(order, x, y, 0, H);
+}
+
+void GeoIndex::project(const GeoPoint& point, double& x, double& y) const {
+    x = (point.lon - originLon) * metresPerLon;
+    y = (point.lat - originLat) * METRES_PER_DEGREE;
+}
+
+int GeoIndex::distance(const GeoPoint& a, const GeoPoint& b) const {
+    double ax, ay, bx, by;
+    project(a, ax, ay);
+    project(b, bx, by);
+    return (int)lround(sqrt((ax - bx) * (ax - bx) + (ay - by) * (ay - by)));
+}
+
+int GeoIndex::build(vector<int>& order, const vector<double>& x, const vector<double>& y, int begin, int end) {
+    int index = nodes.size();
+    nodes.push_back(Node());
+
+    if (end - begin <= LEAF_SIZE) {
+        nodes[index].axis = -1;
+        nodes[index].leaf = leafIds.size() / LEAF_SIZE;
+        for (int i = 0; i < LEAF_SIZE; i++) {
+            bool used = begin + i < end;
+            leafX.push_back(used ? x[order[begin + i]] : PADDING);
+            leafY.push_back(used ? y[order[begin + i]] : PADDING);
+            leafIds.push_back(used ? order[begin + i] : INT_MAX);
+        }
+        return index;
+    }
+
+    double minX = x[order[begin]], maxX = minX, minY = y[order[begin]], maxY = minY;
+    for (int i = begin + 1; i < end; i++) {
+        minX = min(minX, x[order[i]]);
+        maxX = max(maxX, x[order[i]]);
+        minY = min(minY, y[order[i]]);
+        maxY = max(maxY, y[order[i]]);
+    }
+    int axis = (maxY - minY > maxX - minX) ? 1 : 0;
+    const vector<double>& coord = axis ? y : x;
+
+    int mid = (begin + end) / 2;
+    nth_element(order.begin() + begin, order.begin() + mid, order.begin() + end,
+                [&](int a, int b) { return coord[a] < coord[b] || (coord[a] == coord[b] && a < b); });
+
+    double split = coord[order[mid]];
+    int left = build(order, x, y, begin, mid);
+    int right = build(order, x, y, mid, end);
+    nodes[index].axis = axis;
+    nodes[index].split = split;
+    nodes[index].left = left;
+    nodes[index].right = right;
+    return index;
+}
+
+int GeoIndex::nearest(double x, double y, int& distance) const {
+    struct Pending {
+        int node;
+        double bound;
+    };
+    Pending stack[64];
+    int top = 0;
+
+    double best = INFINITY;
+    int bestId = -1;
+    if (!nodes.empty()) stack[top++] = {0, 0.0};
+
+    while (top > 0) {
+        Pending pending = stack[--top];
+        if (pending.bound > best) continue;
+
+        const Node* node = &nodes[pending.node];
+        while (node->axis >= 0) {
+            double diff = (node->axis ? y : x) - node->split;
+            int near = (diff < 0) ? node->left : node->right;
+            int far = (diff < 0) ? node->right : node->left;
+            if (diff * diff <= best) stack[top++] = {far, diff * diff};
+            node = &nodes[near];
+        }
+
+        const double* lx = &leafX[node->leaf * LEAF_SIZE];
+        const double* ly = &leafY[node->leaf * LEAF_SIZE];
+        const int* ids = &leafIds[node->leaf * LEAF_SIZE];
+        double d2[LEAF_SIZE];
+        for (int i = 0; i < LEAF_SIZE; i++) {
+            double dx = lx[i] - x, dy = ly[i] - y;
+            d2[i] = dx * dx + dy * dy;
+        }
+        for (int i = 0; i < LEAF_SIZE; i++) {
+            if (d2[i] < best || (d2[i] == best && ids[i] < bestId)) {
+                best = d2[i];
+                bestId = ids[i];
+            }
+        }
+    }
+
+    distance = (bestId < 0) ? 0 : (int)lround(sqrt(best));
+    return bestId;
+}
+
+void GeoIndex::assignRange(const vector<GeoPoint>& points, vector<int>& nearestIds, vector<int>& distances,
+                           size_t begin, size_t end) const {
+    for (size_t i = begin; i < end; i++) {
+        double x, y;
+        project(points[i], x, y);
+        nearestIds[i] = nearest(x, y, distances[i]);
+    }
+}
+
+void GeoIndex::assign(const vector<GeoPoint>& points, vector<int>& nearestIds, vector<int>& distances,
+                      int threads) const {
+    size_t N = points.size();
+    nearestIds.resize(N);
+    distances.resize(N);
+
+    size_t workers = min((size_t)max(1, threads), max((size_t)1, N / MIN_POINTS_PER_THREAD));
+    size_t chunk = (N + workers - 1) / workers;
+    vector<thread> pool;
+    for (size_t w = 1; w < workers; w++) {
+        size_t begin = w * chunk, end = min(N, begin + chunk);
+        pool.push_back(thread(&GeoIndex::assignRange, this, cref(points), ref(nearestIds), ref(distances),
+                              begin, end));
+    }
+    assignRange(points, nearestIds, distances, 0, min(N, chunk));
+    for (thread& t : pool) {
+        t.join();
+    }
+}
@@ -1,10 +1,26 @@
 #include "Hospital.h"
+#include "EventJournal.h"
+#include "TravelProfiles.h"
+#include "StochasticTimes.h"
+#include "SimulationSnapshot.h"
 #include <iostream>
 #include <algorithm>
+#include <climits>
 
 Hospital::Hospital(int id) {
     hospitalId = id;
     epNotServed = 0;
+    offlinePending[NC] = offlinePending[SC] = 0;
+    readyCars[NC] = readyCars[SC] = 0;
+    fewestReady[NC] = fewestReady[SC] = INT_MAX;
+    busyCars = 0;
+    worklist = nullptr;
+    listed = false;
+    changeList = nullptr;
+    changed = false;
+    journal = nullptr;
+    travel = nullptr;
+    stochastic = nullptr;
 }
 
 Hospital::~Hospital() {
@@ -15,9 +31,24 @@ Hospital::~Hospital() {
 
 void Hospital::addCar(Car* car) {
     cars.push_back(car);
+    if (car->status == READY) readyCars[car->type]++;
+    else if (car->status != OFFLINE) busyCars++;
+}
+
+void Hospital::recountCars() {
+    markChanged();
+    readyCars[NC] = readyCars[SC] = 0;
+    busyCars = 0;
+    for (Car* car : cars) {
+        if (car->status == READY) readyCars[car->type]++;
+        else if (car->status != OFFLINE) busyCars++;
+    }
 }
 
 void Hospital::addPatientRequest(Patient* patient) {
+    if (journal) journal->recordQueueInsert(hospitalId, patient);
+    markActive();
+    markChanged();
     switch (patient->type) {
         case EP:
             epQueue.push(patient);
@@ -40,9 +71,38 @@ Car* Hospital::findAvailableCar(CarType requiredType) {
     return nullptr;
 }
 
-void Hospital::assignCarToPatient(Car* car, Patient* patient, int currentTime) {
-    car->assignPatient(patient, currentTime, patient->distanceToHospital);
+void Hospital::assignCarToPatient(Car* car, Patient* patient, int currentTime,
+                                  int distance, int backDistance) {
+    if (distance < 0) distance = patient->distanceToHospital;
+    if (travel) distance = travel->scale(car->hospitalId, patient->nearestHospitalId, distance, currentTime);
+    if (stochastic) distance = stochastic->outboundDistance(patient, distance);
+    readyCars[car->type]--;
+    fewestReady[car->type] = min(fewestReady[car->type], readyCars[car->type]);
+    busyCars++;
+    markActive();
+    markChanged();
+    car->assignPatient(patient, currentTime, distance, backDistance);
+    if (journal) journal->recordAssign(hospitalId, car->carId, patient);
 }
+
+void Hospital::assignForeignCar(Hospital* carHospital, Car* car, Patient* patient, int currentTime,
+                                int toDistance, int fromDistance) {
+    if (carHospital == this) {
+        assignCarToPatient(car, patient, currentTime);
+        return;
+    }
+
+    markChanged();
+
+    if (patient->type == EP && patient->nearestHospitalId == hospitalId) {
+        epNotServed++;
+        if (journal) journal->recordForward(hospitalId, carHospital->hospitalId, patient);
+    }
+    carHospital->assignCarToPatient(car, patient, currentTime,
+                                    toDistance + patient->distanceToHospital,
+                                    patient->distanceToHospital + fromDistance);
+}
+
 void Hospital::processRequests(int currentTime) {
     while (!epQueue.empty()) {
         Patient* patient = epQueue.top();
@@ -92,8 +152,26 @@ void Hospital::updateCars(int currentTime) {
             if (car->hasReachedDestination()) {
                 if (car->status == ASSIGNED) {
                     car->pickupPatient(currentTime);
+                    if (travel) {
+                        car->remainingDistance = travel->scale(car->currentPatient->nearestHospitalId, car->hospitalId,
+                                                               car->remainingDistance, currentTime);
+                    }
+                    if (stochastic) {
+                        car->remainingDistance = stochastic->returnDistance(car->currentPatient, car->remainingDistance,
+                                                                            car->speed);
+                    }
+                    if (journal) journal->recordPickup(hospitalId, car->carId);
                 } else if (car->status == LOADED) {
                     car->returnToHospital(currentTime);
+                    busyCars--;
+                    markChanged();
+                    if (journal) journal->recordReturn(hospitalId, car->carId);
+                    if (offlinePending[car->type] > 0) {
+                        car->status = OFFLINE;
+                        offlinePending[car->type]--;
+                    } else {
+                        readyCars[car->type]++;
+                    }
                 }
             }
         }
@@ -105,11 +183,48 @@ void Hospital::handleCancellation(int patientId, int currentTime) {
         if (car->currentPatient && car->currentPatient->pid == patientId) {
             car->currentPatient->cancelled = true;
             car->reset();
+            busyCars--;
+            markChanged();
+            if (journal) journal->recordCancel(hospitalId, car->carId);
+            if (offlinePending[car->type] > 0) {
+                car->status = OFFLINE;
+                offlinePending[car->type]--;
+            } else {
+                readyCars[car->type]++;
+            }
             break;
         }
     }
 }
 
+void Hospital::takeCarsOffline(CarType type, int count) {
+    markChanged();
+    for (int i = (int)cars.size() - 1; i >= 0 && count > 0; i--) {
+        if (cars[i]->status == READY && cars[i]->type == type) {
+            cars[i]->status = OFFLINE;
+            readyCars[type]--;
+            count--;
+        }
+    }
+    fewestReady[type] = min(fewestReady[type], readyCars[type]);
+    offlinePending[type] += count;
+}
+
+void Hospital::bringCarsOnline(CarType type, int count) {
+    markChanged();
+    int pending = min(count, offlinePending[type]);
+    offlinePending[type] -= pending;
+    count -= pending;
+    for (Car* car : cars) {
+        if (count == 0) break;
+        if (car->status == OFFLINE && car->type == type) {
+            car->status = READY;
+            readyCars[type]++;
+            count--;
+        }
+    }
+}
+
 int Hospital::getReadyCarsCount(CarType type) const {
     int count = 0;
     for (Car* car : cars) {
@@ -162,21 +277,19 @@ void Hospital::displayStatus(int currentTime) const {
     }
     cout << endl;
 
-    queue<Patient*> tempSP = spQueue;
-    cout << tempSP.size() << " SP requests: ";
-    while (!tempSP.empty()) {
-        cout << tempSP.front()->pid;
-        tempSP.pop();
-        if (!tempSP.empty()) cout << ", ";
+    const deque<Patient*>& waitingSP = queueContainer(spQueue);
+    cout << waitingSP.size() << " SP requests: ";
+    for (size_t i = 0; i < waitingSP.size(); i++) {
+        if (i > 0) cout << ", ";
+        cout << waitingSP[i]->pid;
     }
     cout << endl;
 
-    queue<Patient*> tempNP = npQueue;
-    cout << tempNP.size() << " NP requests: ";
-    while (!tempNP.empty()) {
-        cout << tempNP.front()->pid;
-        tempNP.pop();
-        if (!tempNP.empty()) cout << ", ";
+    const deque<Patient*>& waitingNP = queueContainer(npQueue);
+    cout << waitingNP.size() << " NP requests: ";
+    for (size_t i = 0; i < waitingNP.size(); i++) {
+        if (i > 0) cout << ", ";
+        cout << waitingNP[i]->pid;
     }
     cout << endl;
 
@@ -0,0 +1,462 @@
+#include "JournalReplay.h"
+#include "AmbulanceSystem.h"
+#include "BinaryIO.h"
+#include <fstream>
+#include <algorithm>
+
+JournalReplay::JournalReplay() {
+    eventsOffset = eventsEnd = position = 0;
+    scSpeed = ncSpeed = 0;
+    currentTime = decodedTime = 0;
+    endTime = -1;
+    eventsApplied = 0;
+    corrupt = false;
+}
+
+// Reads a varint that must end before 'end' and be below 'limit'.
+static bool readBounded(const unsigned char*& p, const unsigned char* end, uint64_t limit, uint64_t& value) {
+    return getVarint(p, end, value) && value < limit;
+}
+
+// Unchecked read for the replay loop. load() leaves zero bytes after the
+// trailer, so a varint that starts before the index always ends inside the
+// buffer; applyEvents checks once per event that it did not pass the index.
+static inline bool readBelow(const unsigned char*& p, uint64_t limit, uint64_t& value) {
+    value = getVarint(p);
+    return value < limit;
+}
+
+static bool readSigned(const unsigned char*& p, const unsigned char* end, int& value) {
+    uint64_t raw;
+    if (!getVarint(p, end, raw)) return false;
+    int64_t decoded = zigzagDecode(raw);
+    if (decoded < INT32_MIN || decoded > INT32_MAX) return false;
+    value = (int)decoded;
+    return true;
+}
+
+bool JournalReplay::load(const string& filename) {
+    ifstream file(filename, ios::binary | ios::ate);
+    if (!file.is_open()) {
+        cerr << "Error opening journal: " << filename << endl;
+        return false;
+    }
+    size_t size = file.tellg();
+    file.seekg(0);
+    data.assign(size + 16, 0);
+    file.read((char*)data.data(), size);
+    file.close();
+
+    if (size < 20 || getFixed32(data.data()) != JOURNAL_MAGIC ||
+        getFixed32(data.data() + size - 4) != JOURNAL_INDEX_MAGIC) {
+        cerr << "Not a complete journal file: " << filename << endl;
+        return false;
+    }
+
+    const unsigned char* p = data.data() + 4;
+    const unsigned char* trailer = data.data() + size - 16;
+    uint64_t value;
+    if (!getVarint(p, trailer, value) || value != JOURNAL_VERSION) {
+        cerr << "Unsupported journal version: " << filename << endl;
+        return false;
+    }
+    if (!parseHeader(p, trailer) || !parseIndex(size)) {
+        cerr << "Invalid journal: " << filename << endl;
+        return false;
+    }
+
+    corrupt = false;
+    resetState();
+    return true;
+}
+
+// Every count is checked against the bytes left before it sizes anything:
+// a car takes at least one byte and a patient at least six.
+bool JournalReplay::parseHeader(const unsigned char* p, const unsigned char* end) {
+    uint64_t value;
+    if (!readBounded(p, end, INT32_MAX, value)) return false;
+    scSpeed = value;
+    if (!readBounded(p, end, INT32_MAX, value)) return false;
+    ncSpeed = value;
+
+    uint64_t hospitalCount;
+    if (!getVarint(p, end, hospitalCount) || hospitalCount > (uint64_t)(end - p)) return false;
+    carBase.assign(1, 0);
+    carTypes.clear();
+    for (uint64_t i = 0; i < hospitalCount; i++) {
+        uint64_t carCount;
+        if (!getVarint(p, end, carCount) || carCount > (uint64_t)(end - p)) return false;
+        for (uint64_t j = 0; j < carCount; j++) {
+            if (*p > SC) return false;
+            carTypes.push_back(*p++);
+        }
+        carBase.push_back(carTypes.size());
+    }
+
+    uint64_t patientCount;
+    if (!getVarint(p, end, patientCount) || patientCount > (uint64_t)(end - p) / 6) return false;
+    patientPid.clear();
+    patientType.clear();
+    patientRequestTime.clear();
+    patientHospital.clear();
+    patientDistance.clear();
+    patientSeverity.clear();
+    for (uint64_t i = 0; i < patientCount; i++) {
+        int pid, requestTime, distance, severity;
+        if (!readSigned(p, end, pid) || p >= end || *p > EP) return false;
+        patientPid.push_back(pid);
+        patientType.push_back(*p++);
+        if (!readSigned(p, end, requestTime) || !readBounded(p, end, hospitalCount + 1, value) ||
+            value == 0 || !readSigned(p, end, distance) || !readSigned(p, end, severity)) {
+            return false;
+        }
+        patientRequestTime.push_back(requestTime);
+        patientHospital.push_back(value);
+        patientDistance.push_back(distance);
+        patientSeverity.push_back(severity);
+    }
+    eventsOffset = p - data.data();
+    return true;
+}
+
+// The index must sit between the events and the trailer, and every entry must
+// point into the event stream.
+bool JournalReplay::parseIndex(size_t size) {
+    uint64_t indexOffset = getFixed64(data.data() + size - 16);
+    uint32_t indexCount = getFixed32(data.data() + size - 8);
+    if (indexOffset < eventsOffset || indexOffset > size - 16 ||
+        indexCount > (size - 16 - indexOffset) / 4) {
+        return false;
+    }
+    eventsEnd = indexOffset;
+
+    const unsigned char* p = data.data() + indexOffset;
+    const unsigned char* end = data.data() + size - 16;
+    index.clear();
+    for (uint32_t i = 0; i < indexCount; i++) {
+        uint64_t time, previousTime, offset, eventCount;
+        if (!readBounded(p, end, INT32_MAX, time) || !readBounded(p, end, time + 1, previousTime) ||
+            !getVarint(p, end, offset) || offset < eventsOffset || offset > eventsEnd ||
+            !getVarint(p, end, eventCount)) {
+            return false;
+        }
+        JournalIndexEntry entry = {(int)time, (int)previousTime, offset, eventCount};
+        index.push_back(entry);
+    }
+    return true;
+}
+
+void JournalReplay::resetState() {
+    size_t patients = patientPid.size();
+    size_t cars = carTypes.size();
+    size_t hospitals = carBase.size() - 1;
+
+    pickupTime.assign(patients, -1);
+    finishTime.assign(patients, -1);
+    cancelled.assign(patients, 0);
+    queuedAt.assign(patients, 0);
+    carStatus.assign(cars, READY);
+    carPatient.assign(cars, -1);
+    carBusyStart.assign(cars, -1);
+    carBusyTotal.assign(cars, 0);
+    queueLength.assign(hospitals * 3, 0);
+    epForwarded.assign(hospitals, 0);
+
+    position = eventsOffset;
+    currentTime = decodedTime = 0;
+    endTime = -1;
+    eventsApplied = 0;
+}
+
+uint64_t JournalReplay::applyEvents(int untilTime) {
+    const unsigned char* base = data.data();
+    const unsigned char* p = base + position;
+    const unsigned char* end = base + eventsEnd;
+    uint64_t patients = patientPid.size();
+    uint64_t cars = carTypes.size();
+    uint64_t hospitals = carBase.size() - 1;
+    int time = decodedTime;
+    uint64_t applied = 0;
+    uint64_t a, b, c;
+    const unsigned char* eventStart = p;
+
+    while (p < end) {
+        eventStart = p;
+        int type = *p++;
+        switch (type) {
+            case JE_TICK: {
+                if (!readBelow(p, (uint64_t)INT32_MAX - time + 1, a) || p > end) goto invalid;
+                int next = time + (int)a;
+                if (next > untilTime) {
+                    p = eventStart;
+                    goto done;
+                }
+                time = next;
+                continue;
+            }
+            case JE_ARRIVAL:
+                if (!readBelow(p, patients, a)) goto invalid;
+                break;
+            case JE_QUEUE_INSERT: {
+                if (!readBelow(p, hospitals + 1, a) || a == 0 ||
+                    !readBelow(p, patients, b)) {
+                    goto invalid;
+                }
+                int hospital = a, patient = b;
+                queuedAt[patient] = hospital;
+                queueLength[(hospital - 1) * 3 + patientType[patient]]++;
+                break;
+            }
+            case JE_ASSIGN: {
+                if (!readBelow(p, cars, a) || !readBelow(p, patients, b) || queuedAt[b] == 0) {
+                    goto invalid;
+                }
+                int car = a, patient = b;
+                queueLength[(queuedAt[patient] - 1) * 3 + patientType[patient]]--;
+                queuedAt[patient] = 0;
+                carStatus[car] = ASSIGNED;
+                carPatient[car] = patient;
+                carBusyStart[car] = time;
+                break;
+            }
+            case JE_PICKUP: {
+                if (!readBelow(p, cars, a) || carPatient[a] < 0) goto invalid;
+                int car = a;
+                pickupTime[carPatient[car]] = time;
+                carStatus[car] = LOADED;
+                break;
+            }
+            case JE_RETURN: {
+                if (!readBelow(p, cars, a) || carPatient[a] < 0) goto invalid;
+                int car = a;
+                finishTime[carPatient[car]] = time;
+                carStatus[car] = READY;
+                carPatient[car] = -1;
+                carBusyTotal[car] += time - carBusyStart[car];
+                carBusyStart[car] = -1;
+                break;
+            }
+            case JE_CANCEL: {
+                if (!readBelow(p, cars, a) || carPatient[a] < 0) goto invalid;
+                int car = a;
+                cancelled[carPatient[car]] = 1;
+                carStatus[car] = READY;
+                carPatient[car] = -1;
+                carBusyStart[car] = -1;
+                break;
+            }
+            case JE_EP_FORWARD:
+                if (!readBelow(p, hospitals + 1, a) || a == 0 ||
+                    !readBelow(p, hospitals + 1, b) || b == 0 || !readBelow(p, patients, c)) {
+                    goto invalid;
+                }
+                epForwarded[a - 1]++;
+                break;
+            case JE_END:
+                if (!readBelow(p, (uint64_t)INT32_MAX + 1, a)) goto invalid;
+                endTime = a;
+                break;
+            default:
+                goto invalid;
+        }
+        if (p > end) goto invalid;
+        applied++;
+    }
+    goto done;
+
+invalid:
+    cerr << "Invalid journal: bad event at offset " << (eventStart - base) << endl;
+    corrupt = true;
+    p = end;
+
+done:
+    position = p - base;
+    decodedTime = time;
+    eventsApplied += applied;
+    return applied;
+}
+
+uint64_t JournalReplay::replayTo(int time) {
+    if (time < currentTime) {
+        resetState();
+    }
+    uint64_t applied = applyEvents(time);
+    currentTime = (endTime >= 0) ? endTime : max(currentTime, time);
+    return applied;
+}
+
+uint64_t JournalReplay::replayAll() {
+    return replayTo(INT32_MAX);
+}
+
+void JournalReplay::printState(ostream& out) const {
+    out << "State at timestep " << currentTime << endl;
+    size_t hospitals = carBase.size() - 1;
+    for (size_t h = 0; h < hospitals; h++) {
+        int readySC = 0, readyNC = 0, outCars = 0, backCars = 0;
+        for (int c = carBase[h]; c < carBase[h + 1]; c++) {
+            if (carStatus[c] == READY) {
+                if (carTypes[c] == SC) readySC++;
+                else readyNC++;
+            } else if (carStatus[c] == ASSIGNED) {
+                outCars++;
+            } else {
+                backCars++;
+            }
+        }
+        out << "HOSPITAL #" << h + 1
+            << " EP: " << queueLength[h * 3 + EP]
+            << " SP: " << queueLength[h * 3 + SP]
+            << " NP: " << queueLength[h * 3 + NP]
+            << " Free: " << readySC << " SCars, " << readyNC << " NCars"
+            << " Out: " << outCars << " Back: " << backCars << endl;
+    }
+
+    int finished = 0;
+    for (size_t i = 0; i < finishTime.size(); i++) {
+        if (finishTime[i] != -1 && !cancelled[i]) finished++;
+    }
+    out << "Finished patients: " << finished << " of " << finishTime.size() << endl;
+}
+
+void JournalReplay::printCar(ostream& out, int car) const {
+    int hospital = upper_bound(carBase.begin(), carBase.end(), car) - carBase.begin();
+    out << " H" << hospital << " C" << car - carBase[hospital - 1] + 1;
+}
+
+bool JournalReplay::printEvents(ostream& out, int fromTime, int toTime) const {
+    size_t start = eventsOffset;
+    int time = 0;
+    for (const JournalIndexEntry& entry : index) {
+        if (entry.time > fromTime) break;
+        start = entry.offset;
+        time = entry.previousTime;
+    }
+
+    static const char* names[] = {"TICK", "ARRIVAL", "QUEUE", "ASSIGN", "PICKUP",
+                                  "RETURN", "CANCEL", "FORWARD", "END"};
+    uint64_t patients = patientPid.size();
+    uint64_t cars = carTypes.size();
+    const unsigned char* base = data.data();
+    const unsigned char* p = base + start;
+    const unsigned char* end = base + eventsEnd;
+    while (p < end) {
+        const unsigned char* eventStart = p;
+        int type = *p++;
+        uint64_t values[3];
+        bool valid = type <= JE_END;
+        if (type == JE_TICK) {
+            if (readBounded(p, end, (uint64_t)INT32_MAX - time + 1, values[0])) {
+                time += values[0];
+                if (time > toTime) break;
+                continue;
+            }
+            valid = false;
+        }
+        int fields = (type == JE_ASSIGN) ? 2 : (type == JE_QUEUE_INSERT) ? 2 :
+                     (type == JE_EP_FORWARD) ? 3 : 1;
+        for (int i = 0; valid && i < fields; i++) {
+            valid = getVarint(p, end, values[i]);
+        }
+        if (valid) {
+            switch (type) {
+                case JE_ARRIVAL: valid = values[0] < patients; break;
+                case JE_QUEUE_INSERT: valid = values[1] < patients; break;
+                case JE_ASSIGN: valid = values[0] < cars && values[1] < patients; break;
+                case JE_EP_FORWARD: valid = values[2] < patients; break;
+                case JE_END: break;
+                default: valid = values[0] < cars; break;
+            }
+        }
+        if (!valid) {
+            cerr << "Invalid journal: bad event at offset " << (eventStart - base) << endl;
+            return false;
+        }
+        if (time < fromTime) continue;
+
+        out << time << " " << names[type];
+        switch (type) {
+            case JE_ARRIVAL:
+                out << " P" << patientPid[values[0]];
+                break;
+            case JE_QUEUE_INSERT:
+                out << " H" << values[0] << " P" << patientPid[values[1]];
+                break;
+            case JE_ASSIGN:
+                printCar(out, values[0]);
+                out << " P" << patientPid[values[1]];
+                break;
+            case JE_EP_FORWARD:
+                out << " H" << values[0] << " -> H" << values[1] << " P" << patientPid[values[2]];
+                break;
+            case JE_END:
+                out << " " << values[0];
+                break;
+            default:
+                printCar(out, values[0]);
+                break;
+        }
+        out << endl;
+    }
+    return true;
+}
+
+bool JournalReplay::writeOutputFile(const string& filename) const {
+    if (endTime < 0) {
+        cerr << "Journal has not been replayed to the end" << endl;
+        return false;
+    }
+
+    ofstream file(filename);
+    if (!file.is_open()) {
+        cerr << "Error creating output file: " << filename << endl;
+        return false;
+    }
+
+    SimulationSummary summary;
+    summary.hospitalCount = carBase.size() - 1;
+    summary.npCount = summary.spCount = summary.epCount = 0;
+    summary.scCount = summary.ncCount = 0;
+    summary.epNotServedByHomeHospital = 0;
+    summary.totalWaitTime = summary.totalBusyTime = 0.0;
+    summary.endTime = endTime;
+
+    vector<Patient> patients;
+    patients.reserve(patientPid.size());
+    for (size_t i = 0; i < patientPid.size(); i++) {
+        patients.push_back(Patient(patientPid[i], (PatientType)patientType[i], patientRequestTime[i],
+                                   patientHospital[i], patientDistance[i], patientSeverity[i]));
+        Patient& patient = patients.back();
+        patient.index = i;
+        patient.pickupTime = pickupTime[i];
+        patient.finishTime = finishTime[i];
+        patient.served = finishTime[i] != -1;
+        patient.cancelled = cancelled[i] != 0;
+
+        if (patient.type == NP) summary.npCount++;
+        else if (patient.type == SP) summary.spCount++;
+        else summary.epCount++;
+        if (patient.served && !patient.cancelled) {
+            summary.totalWaitTime += patient.getWaitingTime();
+        }
+    }
+
+    vector<Patient*> patientPointers;
+    for (Patient& patient : patients) {
+        patientPointers.push_back(&patient);
+    }
+
+    for (size_t c = 0; c < carTypes.size(); c++) {
+        if (carTypes[c] == SC) summary.scCount++;
+        else summary.ncCount++;
+        summary.totalBusyTime += carBusyTotal[c];
+    }
+    summary.totalCars = summary.scCount + summary.ncCount;
+    for (int forwarded : epForwarded) {
+        summary.epNotServedByHomeHospital += forwarded;
+    }
+
+    AmbulanceSystem::writeOutput(file, patientPointers, summary);
+    file.close();
+    return true;
+}
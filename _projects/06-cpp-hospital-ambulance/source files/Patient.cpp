@@ -2,12 +2,14 @@
 
 Patient::Patient(int id, PatientType t, int rt, int hid, int dist, int sev) {
     pid = id;
+    index = -1;
     type = t;
     requestTime = rt;
     pickupTime = -1;
     finishTime = -1;
     nearestHospitalId = hid;
     distanceToHospital = dist;
+    carHospitalId = -1;
     severity = sev;
     cancelled = false;
     served = false;
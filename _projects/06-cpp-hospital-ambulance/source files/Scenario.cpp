@@ -0,0 +1,209 @@
+#include "Scenario.h"
+#include "GeoIndex.h"
+#include <thread>
+#include <cstdlib>
+#include <cerrno>
+#include <climits>
+
+Scenario::Scenario() {
+    scSpeed = ncSpeed = 0;
+}
+
+PatientType Scenario::patientTypeFromString(const string& typeStr) {
+    if (typeStr == "NP") return NP;
+    if (typeStr == "SP") return SP;
+    if (typeStr == "EP") return EP;
+    return NP;
+}
+
+// Counts in the header are not trusted to size anything: lists grow as
+// records are read, so a short file fails instead of allocating its header
+bool Scenario::readCars(istream& in, int H) {
+    scCars.clear();
+    ncCars.clear();
+    for (int i = 0; i < H; i++) {
+        int sc, nc;
+        if (!(in >> sc >> nc)) return false;
+        scCars.push_back(sc);
+        ncCars.push_back(nc);
+    }
+    return true;
+}
+
+static bool parseInt(const char*& p, int& value) {
+    char* end;
+    errno = 0;
+    long parsed = strtol(p, &end, 10);
+    if (end == p || errno == ERANGE || parsed < INT_MIN || parsed > INT_MAX) return false;
+    value = parsed;
+    p = end;
+    return true;
+}
+
+static bool parseDouble(const char*& p, double& value) {
+    char* end;
+    value = strtod(p, &end);
+    if (end == p) return false;
+    p = end;
+    return true;
+}
+
+static bool validLocation(const GeoPoint& point) {
+    return point.lat >= -90 && point.lat <= 90 && point.lon >= -180 && point.lon <= 180;
+}
+
+// A file may end before the cancellation count, which means none
+bool Scenario::readCancellations(istream& in) {
+    int C = 0;
+    cancellations.clear();
+    if (!(in >> C)) return in.eof();
+    if (C < 0) return false;
+    for (int i = 0; i < C; i++) {
+        RequestCancellation cancellation;
+        in >> cancellation.cancellationTime >> cancellation.patientId;
+        if (!in) return false;
+        cancellations.push_back(cancellation);
+    }
+    return true;
+}
+
+bool Scenario::read(istream& in) {
+    in >> ws;
+    if (in.peek() == 'G') {
+        string header;
+        in >> header;
+        if (header != GEO_HEADER) return false;
+        return readGeo(in);
+    }
+
+    int H = 0;
+    in >> H;
+    in >> scSpeed >> ncSpeed;
+    if (!in || H < 1) return false;
+
+    distances.clear();
+    for (int i = 0; i < H; i++) {
+        vector<int> row;
+        for (int j = 0; j < H; j++) {
+            int distance;
+            if (!(in >> distance)) return false;
+            row.push_back(distance);
+        }
+        distances.push_back(row);
+    }
+    if (!readCars(in, H)) return false;
+
+    int R = 0;
+    in >> R;
+    if (!in || R < 0) return false;
+    requests.clear();
+    for (int i = 0; i < R; i++) {
+        string typeStr;
+        ScenarioRequest request;
+        in >> typeStr >> request.requestTime >> request.patientId >> request.hospitalId >> request.distance;
+
+        request.type = patientTypeFromString(typeStr);
+        request.severity = 0;
+        if (request.type == EP) {
+            in >> request.severity;
+        }
+        if (!in || request.hospitalId < 1 || request.hospitalId > H) return false;
+        requests.push_back(request);
+    }
+
+    return readCancellations(in);
+}
+
+bool Scenario::readGeo(istream& in) {
+    int H = 0;
+    in >> H;
+    in >> scSpeed >> ncSpeed;
+    if (!in || H < 1) return false;
+
+    vector<GeoPoint> locations;
+    for (int i = 0; i < H; i++) {
+        GeoPoint location;
+        if (!(in >> location.lat >> location.lon) || !validLocation(location)) return false;
+        locations.push_back(location);
+    }
+    if (!readCars(in, H)) return false;
+
+    int R = 0;
+    in >> R;
+    if (!in || R < 0) return false;
+    requests.clear();
+    vector<GeoPoint> callers;
+    string line;
+    while ((int)requests.size() < R && getline(in, line)) {
+        const char* p = line.c_str();
+        while (*p == ' ' || *p == '\t') p++;
+        if (*p == '\0' || *p == '\r') continue;
+
+        const char* typeEnd = p;
+        while (*typeEnd && *typeEnd != ' ' && *typeEnd != '\t') typeEnd++;
+        ScenarioRequest request;
+        request.type = patientTypeFromString(string(p, typeEnd));
+        p = typeEnd;
+
+        GeoPoint caller;
+        request.severity = 0;
+        if (!parseInt(p, request.requestTime) || !parseInt(p, request.patientId) ||
+            !parseDouble(p, caller.lat) || !parseDouble(p, caller.lon) || !validLocation(caller) ||
+            (request.type == EP && !parseInt(p, request.severity))) {
+            return false;
+        }
+        while (*p == ' ' || *p == '\t' || *p == '\r') p++;
+        if (*p != '\0') return false;
+
+        requests.push_back(request);
+        callers.push_back(caller);
+    }
+    if ((int)requests.size() != R || !readCancellations(in)) return false;
+
+    GeoIndex index(locations);
+    distances.assign(H, vector<int>(H));
+    for (int i = 0; i < H; i++) {
+        for (int j = 0; j < H; j++) {
+            distances[i][j] = index.distance(locations[i], locations[j]);
+        }
+    }
+
+    vector<int> nearest, callerDistances;
+    index.assign(callers, nearest, callerDistances, max(1u, thread::hardware_concurrency()));
+    for (int i = 0; i < R; i++) {
+        requests[i].hospitalId = nearest[i] + 1;
+        requests[i].distance = callerDistances[i];
+    }
+
+    return true;
+}
+
+void Scenario::write(ostream& out) const {
+    static const char* typeNames[] = {"NP", "SP", "EP"};
+    int H = hospitalCount();
+
+    out << H << "\n" << scSpeed << " " << ncSpeed << "\n";
+    for (int i = 0; i < H; i++) {
+        for (int j = 0; j < H; j++) {
+            out << distances[i][j] << (j + 1 < H ? " " : "\n");
+        }
+    }
+    for (int i = 0; i < H; i++) {
+        out << scCars[i] << " " << ncCars[i] << "\n";
+    }
+
+    out << requests.size() << "\n";
+    for (const ScenarioRequest& request : requests) {
+        out << typeNames[request.type] << " " << request.requestTime << " " << request.patientId << " "
+            << request.hospitalId << " " << request.distance;
+        if (request.type == EP) {
+            out << " " << request.severity;
+        }
+        out << "\n";
+    }
+
+    out << cancellations.size() << "\n";
+    for (const RequestCancellation& cancellation : cancellations) {
+        out << cancellation.cancellationTime << " " << cancellation.patientId << "\n";
+    }
+}
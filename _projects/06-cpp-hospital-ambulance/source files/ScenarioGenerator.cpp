@@ -0,0 +1,131 @@
+#include "ScenarioGenerator.h"
+#include "Scenario.h"
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <iomanip>
+
+static const double CENTRE_LAT = 30.0444;
+static const double CENTRE_LON = 31.2357;
+static const double METRES_PER_DEGREE = 6371000.0 * M_PI / 180.0;
+
+ScenarioParams::ScenarioParams() {
+    hospitals = 10;
+    scCars = 20;
+    ncCars = 40;
+    requests = 1000;
+    cancellations = 50;
+    horizon = 500;
+    mapSize = 1000;
+    scSpeed = 100;
+    ncSpeed = 80;
+    seed = 1;
+}
+
+ScenarioGenerator::ScenarioGenerator(uint32_t seed) {
+    state = seed * 0x9e3779b97f4a7c15ULL + 1;
+}
+
+uint32_t ScenarioGenerator::next() {
+    state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+    uint32_t xorshifted = (uint32_t)(((state >> 18) ^ state) >> 27);
+    uint32_t rot = (uint32_t)(state >> 59);
+    return (xorshifted >> rot) | (xorshifted << ((32 - rot) & 31));
+}
+
+int ScenarioGenerator::uniform(int low, int high) {
+    return low + (int)(next() % (uint32_t)(high - low + 1));
+}
+
+GeoPoint ScenarioGenerator::randomLocation(const ScenarioParams& params) {
+    double latSpan = params.mapSize / METRES_PER_DEGREE;
+    double lonSpan = latSpan / cos(CENTRE_LAT * M_PI / 180.0);
+    GeoPoint point;
+    point.lat = CENTRE_LAT + latSpan * (next() / 4294967296.0 - 0.5);
+    point.lon = CENTRE_LON + lonSpan * (next() / 4294967296.0 - 0.5);
+    return point;
+}
+
+void ScenarioGenerator::writeCars(const ScenarioParams& params, ostream& out) {
+    int H = params.hospitals;
+    vector<int> sc(H, params.scCars / H), nc(H, params.ncCars / H);
+    for (int i = 0; i < params.scCars % H; i++) sc[uniform(0, H - 1)]++;
+    for (int i = 0; i < params.ncCars % H; i++) nc[uniform(0, H - 1)]++;
+    for (int i = 0; i < H; i++) {
+        out << sc[i] << " " << nc[i] << "\n";
+    }
+}
+
+void ScenarioGenerator::writeCancellations(const ScenarioParams& params, const vector<int>& requestTime,
+                                           ostream& out) {
+    int cancellations = (params.requests > 0) ? params.cancellations : 0;
+    out << cancellations << "\n";
+    for (int i = 0; i < cancellations; i++) {
+        int patient = uniform(0, params.requests - 1);
+        out << requestTime[patient] + uniform(1, 20) << " " << patient + 1 << "\n";
+    }
+}
+
+void ScenarioGenerator::generate(const ScenarioParams& params, ostream& out) {
+    int H = params.hospitals;
+    vector<int> x(H), y(H);
+    for (int i = 0; i < H; i++) {
+        x[i] = uniform(0, params.mapSize);
+        y[i] = uniform(0, params.mapSize);
+    }
+
+    out << H << "\n" << params.scSpeed << " " << params.ncSpeed << "\n";
+    for (int i = 0; i < H; i++) {
+        for (int j = 0; j < H; j++) {
+            double dx = x[i] - x[j], dy = y[i] - y[j];
+            out << (int)sqrt(dx * dx + dy * dy) << (j + 1 < H ? " " : "\n");
+        }
+    }
+
+    writeCars(params, out);
+
+    static const char* types[] = {"NP", "NP", "SP", "EP"};
+    int maxDistance = max(10, params.mapSize / 10);
+    vector<int> requestTime(params.requests);
+    out << params.requests << "\n";
+    for (int i = 0; i < params.requests; i++) {
+        int type = uniform(0, 3);
+        requestTime[i] = uniform(1, params.horizon);
+        out << types[type] << " " << requestTime[i] << " " << i + 1 << " "
+            << uniform(1, H) << " " << uniform(10, maxDistance);
+        if (type == 3) {
+            out << " " << uniform(1, 10);
+        }
+        out << "\n";
+    }
+
+    writeCancellations(params, requestTime, out);
+}
+
+void ScenarioGenerator::generateGeo(const ScenarioParams& params, ostream& out) {
+    int H = params.hospitals;
+    out << Scenario::GEO_HEADER << "\n" << H << "\n" << params.scSpeed << " " << params.ncSpeed << "\n";
+    out << fixed << setprecision(6);
+    for (int i = 0; i < H; i++) {
+        GeoPoint location = randomLocation(params);
+        out << location.lat << " " << location.lon << "\n";
+    }
+
+    writeCars(params, out);
+
+    static const char* types[] = {"NP", "NP", "SP", "EP"};
+    vector<int> requestTime(params.requests);
+    out << params.requests << "\n";
+    for (int i = 0; i < params.requests; i++) {
+        int type = uniform(0, 3);
+        requestTime[i] = uniform(1, params.horizon);
+        GeoPoint caller = randomLocation(params);
+        out << types[type] << " " << requestTime[i] << " " << i + 1 << " " << caller.lat << " " << caller.lon;
+        if (type == 3) {
+            out << " " << uniform(1, 10);
+        }
+        out << "\n";
+    }
+
+    writeCancellations(params, requestTime, out);
+}
@@ -0,0 +1,477 @@
+#include "ShardedSimulation.h"
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <ctime>
+
+ShardedSimulation::ShardedSimulation(const Scenario& scenario, int shards, DispatchPolicyType dispatchPolicy,
+                                     ForwardPolicyType forwardPolicy, const string& travelProfileFile)
+    : scenario(scenario), dispatchPolicy(dispatchPolicy), forwardPolicy(forwardPolicy),
+      travelProfileFile(travelProfileFile) {
+    shardCount = max(1, min(shards, scenario.hospitalCount()));
+    stochastic = false;
+    wallSeconds = 0;
+    shared = nullptr;
+    sharedBytes = 0;
+    barrier = nullptr;
+    ready = nullptr;
+    stats = nullptr;
+    results = nullptr;
+
+    partition();
+    planSynchronization();
+}
+
+ShardedSimulation::~ShardedSimulation() {
+    unmapSharedMemory();
+}
+
+bool ShardedSimulation::supports(DispatchMode mode, DispatchPolicyType dispatchPolicy,
+                                 ForwardPolicyType forwardPolicy) {
+    return mode == GREEDY_DISPATCH && dispatchPolicy != NEAREST_CAR_POLICY &&
+           forwardPolicy != SHORTEST_QUEUE_FORWARD_POLICY;
+}
+
+void ShardedSimulation::partition() {
+    int H = scenario.hospitalCount();
+    const vector<vector<int>>& distances = scenario.distances;
+
+    vector<int> seeds(1, 0);
+    vector<int> nearestSeed(H);
+    for (int h = 0; h < H; h++) nearestSeed[h] = distances[0][h];
+    while ((int)seeds.size() < shardCount) {
+        int farthest = max_element(nearestSeed.begin(), nearestSeed.end()) - nearestSeed.begin();
+        seeds.push_back(farthest);
+        for (int h = 0; h < H; h++) nearestSeed[h] = min(nearestSeed[h], distances[farthest][h]);
+    }
+
+    vector<pair<int, int>> candidates;
+    for (int r = 0; r < shardCount; r++) {
+        for (int h = 0; h < H; h++) {
+            candidates.push_back(make_pair(distances[seeds[r]][h], h * shardCount + r));
+        }
+    }
+    sort(candidates.begin(), candidates.end());
+
+    int capacity = (H + shardCount - 1) / shardCount;
+    vector<int> size(shardCount, 0);
+    regionOf.assign(H, -1);
+    for (const pair<int, int>& candidate : candidates) {
+        int h = candidate.second / shardCount, r = candidate.second % shardCount;
+        if (regionOf[h] < 0 && size[r] < capacity) {
+            regionOf[h] = r;
+            size[r]++;
+        }
+    }
+}
+
+void ShardedSimulation::planSynchronization() {
+    int H = scenario.hospitalCount();
+    lastRequestTime = 0;
+    endLimit = 0;
+    for (const ScenarioRequest& request : scenario.requests) {
+        lastRequestTime = max(lastRequestTime, request.requestTime);
+    }
+    endLimit = lastRequestTime;
+    for (const RequestCancellation& cancellation : scenario.cancellations) {
+        endLimit = max(endLimit, cancellation.cancellationTime);
+    }
+    endLimit += 1000;
+
+    exported.assign(shardCount, vector<int>());
+    outboxCapacity.assign(shardCount, 0);
+    syncTicks.clear();
+    if (forwardPolicy != NEAREST_HOSPITAL_FORWARD_POLICY) return;
+
+    neighbours = nearestHospitals(scenario.distances, NearestHospitalForwarding::NEIGHBOUR_COUNT + 1);
+    vector<bool> boundary(H, false), isExported(H, false);
+    for (int h = 0; h < H; h++) {
+        for (int n : neighbours[h]) {
+            if (regionOf[n] != regionOf[h]) {
+                boundary[h] = true;
+                isExported[n] = true;
+            }
+        }
+    }
+    for (int h = 0; h < H; h++) {
+        if (isExported[h]) exported[regionOf[h]].push_back(h);
+    }
+
+    map<int, vector<int>> boundaryArrivals;
+    for (const ScenarioRequest& request : scenario.requests) {
+        int home = request.hospitalId - 1;
+        if (request.type == EP && boundary[home]) {
+            vector<int>& perShard = boundaryArrivals[request.requestTime];
+            if (perShard.empty()) perShard.assign(shardCount, 0);
+            perShard[regionOf[home]]++;
+        }
+    }
+    for (const pair<const int, vector<int>>& tick : boundaryArrivals) {
+        syncTicks.push_back(tick.first);
+        for (int r = 0; r < shardCount; r++) {
+            outboxCapacity[r] = max(outboxCapacity[r], tick.second[r]);
+        }
+    }
+}
+
+bool ShardedSimulation::mapSharedMemory() {
+    unmapSharedMemory();
+    int H = scenario.hospitalCount();
+    size_t R = scenario.requests.size();
+
+    size_t offset = 0;
+    auto reserve = [&](size_t bytes) {
+        size_t at = (offset + 63) & ~(size_t)63;
+        offset = at + bytes;
+        return at;
+    };
+    size_t barrierAt = reserve(sizeof(pthread_barrier_t));
+    size_t readyAt = reserve(H);
+    size_t statsAt = reserve(shardCount * sizeof(ShardStats));
+    size_t resultsAt = reserve(R * sizeof(PatientResult));
+    vector<size_t> countAt(shardCount), outboxAt(shardCount);
+    for (int r = 0; r < shardCount; r++) {
+        countAt[r] = reserve(sizeof(int));
+        outboxAt[r] = reserve(outboxCapacity[r] * sizeof(Forward));
+    }
+
+    sharedBytes = offset;
+    shared = mmap(nullptr, sharedBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (shared == MAP_FAILED) {
+        shared = nullptr;
+        cerr << "Cannot map " << sharedBytes << " bytes of shared memory" << endl;
+        return false;
+    }
+
+    char* base = (char*)shared;
+    barrier = (pthread_barrier_t*)(base + barrierAt);
+    ready = (uint8_t*)(base + readyAt);
+    stats = (ShardStats*)(base + statsAt);
+    results = (PatientResult*)(base + resultsAt);
+    outboxCount.assign(shardCount, nullptr);
+    outbox.assign(shardCount, nullptr);
+    for (int r = 0; r < shardCount; r++) {
+        outboxCount[r] = (int*)(base + countAt[r]);
+        outbox[r] = (Forward*)(base + outboxAt[r]);
+    }
+
+    pthread_barrierattr_t attributes;
+    pthread_barrierattr_init(&attributes);
+    pthread_barrierattr_setpshared(&attributes, PTHREAD_PROCESS_SHARED);
+    pthread_barrier_init(barrier, &attributes, shardCount);
+    pthread_barrierattr_destroy(&attributes);
+    return true;
+}
+
+void ShardedSimulation::unmapSharedMemory() {
+    if (!shared) return;
+    pthread_barrier_destroy(barrier);
+    munmap(shared, sharedBytes);
+    shared = nullptr;
+}
+
+bool ShardedSimulation::hasReadyCar(AmbulanceSystem& system, int shard, int hospital) const {
+    if (regionOf[hospital] != shard) return ready[hospital] != 0;
+    for (Car* car : system.getHospital(hospital + 1)->cars) {
+        if (car->status == READY) return true;
+    }
+    return false;
+}
+
+int ShardedSimulation::forwardDestination(AmbulanceSystem& system, int shard, Patient* patient) const {
+    int home = patient->nearestHospitalId - 1;
+    if (forwardPolicy != NEAREST_HOSPITAL_FORWARD_POLICY || patient->type != EP ||
+        hasReadyCar(system, shard, home)) {
+        return home;
+    }
+    for (int n : neighbours[home]) {
+        if (n != home && hasReadyCar(system, shard, n)) return n;
+    }
+    return home;
+}
+
+template <class Dispatch>
+void ShardedSimulation::runShard(int shard, Dispatch& dispatch) {
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    int H = scenario.hospitalCount();
+
+    Scenario local;
+    local.scSpeed = scenario.scSpeed;
+    local.ncSpeed = scenario.ncSpeed;
+    local.distances = scenario.distances;
+    local.scCars.assign(H, 0);
+    local.ncCars.assign(H, 0);
+    vector<Hospital*> own;
+    for (int h = 0; h < H; h++) {
+        if (regionOf[h] != shard) continue;
+        local.scCars[h] = scenario.scCars[h];
+        local.ncCars[h] = scenario.ncCars[h];
+    }
+    vector<int> globalIndex;
+    for (size_t i = 0; i < scenario.requests.size(); i++) {
+        if (regionOf[scenario.requests[i].hospitalId - 1] == shard) {
+            local.requests.push_back(scenario.requests[i]);
+            globalIndex.push_back(i);
+        }
+    }
+    local.cancellations = scenario.cancellations;
+
+    AmbulanceSystem system;
+    system.loadScenario(local);
+    if (!travelProfileFile.empty() && !system.loadTravelProfiles(travelProfileFile)) return;
+    if (stochastic) system.enableStochasticTimes(stochasticParams);
+    for (int h = 0; h < H; h++) {
+        if (regionOf[h] == shard) own.push_back(system.getHospital(h + 1));
+    }
+
+    const vector<Patient*>& patients = system.getPatients();
+    vector<int> arrivalOrder(patients.size());
+    for (size_t i = 0; i < patients.size(); i++) arrivalOrder[i] = i;
+    stable_sort(arrivalOrder.begin(), arrivalOrder.end(),
+                [&](int a, int b) { return patients[a]->requestTime < patients[b]->requestTime; });
+
+    vector<bool> forwardedOut(patients.size(), false);
+    vector<Patient*> adopted;
+    vector<Arrival> arrivals;
+    size_t next = 0, nextSync = 0;
+    int endTime = endLimit + 1;
+
+    for (int time = 1; time <= endLimit; time++) {
+        bool sync = nextSync < syncTicks.size() && syncTicks[nextSync] == time;
+        if (sync) {
+            for (int h : exported[shard]) {
+                ready[h] = hasReadyCar(system, shard, h) ? 1 : 0;
+            }
+            pthread_barrier_wait(barrier);
+            *outboxCount[shard] = 0;
+        }
+
+        arrivals.clear();
+        while (next < arrivalOrder.size() && patients[arrivalOrder[next]]->requestTime == time) {
+            int index = arrivalOrder[next++];
+            Patient* patient = patients[index];
+            int destination = forwardDestination(system, shard, patient);
+            if (destination != patient->nearestHospitalId - 1) {
+                system.getHospital(patient->nearestHospitalId)->epNotServed++;
+            }
+            if (regionOf[destination] == shard) {
+                Arrival arrival = {globalIndex[index], destination, patient};
+                arrivals.push_back(arrival);
+            } else {
+                forwardedOut[index] = true;
+                Forward forward = {globalIndex[index], destination};
+                outbox[shard][(*outboxCount[shard])++] = forward;
+                stats[shard].forwardsSent++;
+            }
+        }
+
+        if (sync) {
+            pthread_barrier_wait(barrier);
+            for (int r = 0; r < shardCount; r++) {
+                if (r == shard) continue;
+                for (int i = 0; i < *outboxCount[r]; i++) {
+                    const Forward& forward = outbox[r][i];
+                    if (regionOf[forward.destination] != shard) continue;
+                    const ScenarioRequest& request = scenario.requests[forward.patient];
+                    Patient* patient = new Patient(request.patientId, request.type, request.requestTime,
+                                                   request.hospitalId, request.distance, request.severity);
+                    patient->index = forward.patient;
+                    adopted.push_back(patient);
+                    Arrival arrival = {forward.patient, forward.destination, patient};
+                    arrivals.push_back(arrival);
+                }
+            }
+            stable_sort(arrivals.begin(), arrivals.end(),
+                        [](const Arrival& a, const Arrival& b) { return a.patient < b.patient; });
+            nextSync++;
+        }
+
+        for (const Arrival& arrival : arrivals) {
+            system.getHospital(arrival.destination + 1)->addPatientRequest(arrival.local);
+        }
+        system.handleActiveCancellations(time);
+        system.updateAllHospitals(time, dispatch);
+
+        if (time > 100 && time > lastRequestTime && nextSync == syncTicks.size()) {
+            bool busy = false;
+            for (Hospital* hospital : own) {
+                for (Car* car : hospital->cars) {
+                    if (car->status == ASSIGNED || car->status == LOADED) busy = true;
+                }
+                if (busy) break;
+            }
+            if (!busy) {
+                endTime = time;
+                break;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < patients.size(); i++) {
+        if (forwardedOut[i]) continue;
+        PatientResult& result = results[globalIndex[i]];
+        result.pickupTime = patients[i]->pickupTime;
+        result.finishTime = patients[i]->finishTime;
+        result.served = patients[i]->served;
+        result.cancelled = patients[i]->cancelled;
+    }
+    for (Patient* patient : adopted) {
+        PatientResult& result = results[patient->index];
+        result.pickupTime = patient->pickupTime;
+        result.finishTime = patient->finishTime;
+        result.served = patient->served;
+        result.cancelled = patient->cancelled;
+    }
+
+    ShardStats& shardStats = stats[shard];
+    shardStats.endTime = endTime;
+    for (Hospital* hospital : own) {
+        shardStats.epNotServed += hospital->epNotServed;
+        for (Car* car : hospital->cars) {
+            shardStats.busyTime += car->totalBusyTime;
+        }
+    }
+    shardStats.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    timespec cpu;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &cpu);
+    shardStats.cpuSeconds = cpu.tv_sec + cpu.tv_nsec / 1e9;
+    shardStats.finished = 1;
+
+    for (Patient* patient : adopted) {
+        delete patient;
+    }
+}
+
+void ShardedSimulation::runShard(int shard) {
+    switch (dispatchPolicy) {
+        case RESERVE_SC_POLICY: {
+            ReserveScForEP dispatch;
+            runShard(shard, dispatch);
+            break;
+        }
+        case SEVERITY_SP_POLICY: {
+            SeverityWeightedSP dispatch;
+            runShard(shard, dispatch);
+            break;
+        }
+        default: {
+            FixedTypeDispatch dispatch;
+            runShard(shard, dispatch);
+            break;
+        }
+    }
+}
+
+bool ShardedSimulation::run() {
+    if (!mapSharedMemory()) return false;
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    cout.flush();
+    cerr.flush();
+
+    vector<pid_t> children;
+    bool ok = true;
+    for (int r = 0; r < shardCount; r++) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            runShard(r);
+            _exit(stats[r].finished ? 0 : 1);
+        }
+        if (pid < 0) {
+            cerr << "Cannot start shard process " << r << endl;
+            ok = false;
+            break;
+        }
+        children.push_back(pid);
+    }
+
+    size_t running = children.size();
+    while (running > 0) {
+        int status;
+        pid_t pid = waitpid(-1, &status, 0);
+        if (pid < 0) break;
+        if (find(children.begin(), children.end(), pid) == children.end()) continue;
+        running--;
+        if (!ok || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            if (ok) cerr << "Shard process " << pid << " failed" << endl;
+            ok = false;
+            for (pid_t child : children) kill(child, SIGKILL);
+        }
+    }
+
+    wallSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    return ok;
+}
+
+void ShardedSimulation::writeResults(ostream& file) const {
+    SimulationSummary summary;
+    summary.hospitalCount = scenario.hospitalCount();
+    summary.npCount = summary.spCount = summary.epCount = 0;
+    summary.scCount = summary.ncCount = 0;
+    for (int h = 0; h < summary.hospitalCount; h++) {
+        summary.scCount += scenario.scCars[h];
+        summary.ncCount += scenario.ncCars[h];
+    }
+    summary.totalCars = summary.scCount + summary.ncCount;
+
+    vector<Patient*> patients;
+    patients.reserve(scenario.requests.size());
+    summary.totalWaitTime = 0.0;
+    for (size_t i = 0; i < scenario.requests.size(); i++) {
+        const ScenarioRequest& request = scenario.requests[i];
+        Patient* patient = new Patient(request.patientId, request.type, request.requestTime,
+                                       request.hospitalId, request.distance, request.severity);
+        patient->index = i;
+        patient->pickupTime = results[i].pickupTime;
+        patient->finishTime = results[i].finishTime;
+        patient->served = results[i].served;
+        patient->cancelled = results[i].cancelled;
+        patients.push_back(patient);
+
+        if (request.type == NP) summary.npCount++;
+        else if (request.type == SP) summary.spCount++;
+        else if (request.type == EP) summary.epCount++;
+        if (patient->served && !patient->cancelled) summary.totalWaitTime += patient->getWaitingTime();
+    }
+
+    summary.epNotServedByHomeHospital = 0;
+    summary.totalBusyTime = 0.0;
+    summary.endTime = 0;
+    for (int r = 0; r < shardCount; r++) {
+        summary.epNotServedByHomeHospital += stats[r].epNotServed;
+        summary.totalBusyTime += stats[r].busyTime;
+        summary.endTime = max(summary.endTime, stats[r].endTime);
+    }
+
+    AmbulanceSystem::writeOutput(file, patients, summary);
+    for (Patient* patient : patients) {
+        delete patient;
+    }
+}
+
+int ShardedSimulation::getForwardsSent() const {
+    int total = 0;
+    for (int r = 0; r < shardCount; r++) total += stats[r].forwardsSent;
+    return total;
+}
+
+double ShardedSimulation::getMaxShardSeconds() const {
+    double longest = 0;
+    for (int r = 0; r < shardCount; r++) longest = max(longest, stats[r].seconds);
+    return longest;
+}
+
+double ShardedSimulation::getMeanShardSeconds() const {
+    double total = 0;
+    for (int r = 0; r < shardCount; r++) total += stats[r].seconds;
+    return total / shardCount;
+}
+
+double ShardedSimulation::getMaxShardCpuSeconds() const {
+    double longest = 0;
+    for (int r = 0; r < shardCount; r++) longest = max(longest, stats[r].cpuSeconds);
+    return longest;
+}
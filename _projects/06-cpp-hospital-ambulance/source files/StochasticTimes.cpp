@@ -0,0 +1,63 @@
+#include "StochasticTimes.h"
+#include "Philox.h"
+#include <algorithm>
+
+bool StochasticParams::valid() const {
+    return travelSpread >= 0 && travelSpread < 1 && serviceMin >= 0 && serviceMin <= serviceMax;
+}
+
+StochasticTimes::StochasticTimes(const StochasticParams& params) : params(params) {
+    factorLow = (uint32_t)((1.0 - params.travelSpread) * (1 << FACTOR_BITS));
+    factorRange = (uint32_t)(2.0 * params.travelSpread * (1 << FACTOR_BITS)) + 1;
+}
+
+void StochasticTimes::precompute(const vector<Patient*>& patients) {
+    size_t count = patients.size();
+    pids.assign(count, -1);
+    for (const Patient* patient : patients) {
+        if ((size_t)patient->index < count) pids[patient->index] = patient->pid;
+    }
+
+    draws.resize(count);
+    uint32_t out0[BATCH_SIZE], out1[BATCH_SIZE], out2[BATCH_SIZE], out3[BATCH_SIZE];
+    for (size_t first = 0; first < count; first += BATCH_SIZE) {
+        size_t size = min(count - first, (size_t)BATCH_SIZE);
+        philox4x32Batch((const uint32_t*)&pids[first], 0, size, params.seed, out0, out1, out2, out3);
+        for (size_t i = 0; i < size; i++) {
+            draws[first + i].outbound = out0[i];
+            draws[first + i].onScene = out1[i];
+            draws[first + i].inbound = out2[i];
+        }
+    }
+}
+
+StochasticTimes::Draw StochasticTimes::draw(const Patient* patient) const {
+    uint32_t block[4] = {(uint32_t)patient->pid, 0, 0, 0};
+    philox4x32(block, params.seed);
+    Draw result = {block[0], block[1], block[2]};
+    return result;
+}
+
+StochasticTimes::Draw StochasticTimes::lookup(const Patient* patient) const {
+    size_t index = patient->index;
+    if (index < pids.size() && pids[index] == patient->pid) return draws[index];
+    return draw(patient);
+}
+
+int StochasticTimes::scaleDistance(int distance, uint32_t word) const {
+    uint64_t factor = factorLow + (((uint64_t)word * factorRange) >> 32);
+    return (int)(((uint64_t)distance * factor + (1 << FACTOR_BITS) - 1) >> FACTOR_BITS);
+}
+
+int StochasticTimes::outboundDistance(const Patient* patient, int distance) const {
+    return scaleDistance(distance, lookup(patient).outbound);
+}
+
+int StochasticTimes::serviceTicks(const Patient* patient) const {
+    uint64_t span = (uint64_t)(params.serviceMax - params.serviceMin) + 1;
+    return params.serviceMin + (int)(((uint64_t)lookup(patient).onScene * span) >> 32);
+}
+
+int StochasticTimes::returnDistance(const Patient* patient, int distance, int speed) const {
+    return scaleDistance(distance, lookup(patient).inbound) + serviceTicks(patient) * speed;
+}
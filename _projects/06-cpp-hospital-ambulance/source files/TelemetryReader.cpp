@@ -0,0 +1,74 @@
+#include "TelemetryReader.h"
+#include "BinaryIO.h"
+#include <fstream>
+#include <iterator>
+#include <algorithm>
+
+TelemetryReader::TelemetryReader() {
+    hospitalCount = metricCount = 0;
+    firstTime = 0;
+    stride = 1;
+    rows = lastRowTicks = 0;
+}
+
+bool TelemetryReader::load(const string& filename) {
+    ifstream file(filename, ios::binary);
+    if (!file.is_open()) return false;
+    vector<unsigned char> data((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+    if (data.size() < 4 || getFixed32(data.data()) != TELEMETRY_MAGIC) return false;
+
+    data.resize(data.size() + 10, 0);
+    const unsigned char* p = data.data() + 4;
+    const unsigned char* end = data.data() + data.size() - 10;
+    if ((int)getVarint(p) != TELEMETRY_VERSION) return false;
+    hospitalCount = getVarint(p);
+    metricCount = getVarint(p);
+    firstTime = zigzagDecode(getVarint(p));
+    stride = getVarint(p);
+    rows = getVarint(p);
+    lastRowTicks = getVarint(p);
+    if (metricCount < TM_COUNT || stride < 1 || p > end) return false;
+
+    size_t width = (size_t)hospitalCount * metricCount;
+    vector<int32_t> carried(width);
+    for (size_t column = 0; column < width; column++) {
+        if (p >= end) return false;
+        carried[column] = (int32_t)zigzagDecode(getVarint(p));
+    }
+
+    // Each row starts from the values carried out of the row before it
+    values.resize(width * rows);
+    for (int row = 0; row < rows; row++) {
+        int32_t* rowValues = &values[row * width];
+        copy(carried.begin(), carried.end(), rowValues);
+        if (p >= end) return false;
+        uint64_t count = getVarint(p);
+        for (uint64_t i = 0; i < count; i++) {
+            if (p >= end) return false;
+            uint64_t column = getVarint(p);
+            if (column >= width) return false;
+            int32_t merged = carried[column] + (int32_t)zigzagDecode(getVarint(p));
+            rowValues[column] = merged;
+            carried[column] = merged + (int32_t)zigzagDecode(getVarint(p));
+        }
+    }
+    return p <= end;
+}
+
+void TelemetryReader::exportCsv(ostream& out, int fromTime, int toTime, int hospitalId) const {
+    out << "time,ticks,hospital,ep_queue,sp_queue,np_queue,ready_sc,ready_nc,in_flight\n";
+    for (int r = 0; r < rows; r++) {
+        int time = rowTime(r);
+        int ticks = (r + 1 == rows) ? lastRowTicks : stride;
+        if (time + ticks - 1 < fromTime || time > toTime) continue;
+
+        for (int h = 1; h <= hospitalCount; h++) {
+            if (hospitalId > 0 && h != hospitalId) continue;
+            out << time << "," << ticks << "," << h;
+            for (int m = 0; m < TM_COUNT; m++) {
+                out << "," << value(r, h, (TelemetryMetric)m);
+            }
+            out << "\n";
+        }
+    }
+}
@@ -0,0 +1,153 @@
+#include "TelemetryRecorder.h"
+#include "Hospital.h"
+#include "BinaryIO.h"
+#include <fstream>
+#include <algorithm>
+
+static void readCounters(const Hospital* hospital, int32_t* counters) {
+    counters[TM_EP_QUEUE] = hospital->epQueue.size();
+    counters[TM_SP_QUEUE] = hospital->spQueue.size();
+    counters[TM_NP_QUEUE] = hospital->npQueue.size();
+    counters[TM_READY_SC] = hospital->readyCars[SC];
+    counters[TM_READY_NC] = hospital->readyCars[NC];
+    counters[TM_IN_FLIGHT] = hospital->busyCars;
+}
+
+// minTicks is how long the run is already known to last. Starting at the
+// stride it would be downsampled to anyway gives the same rows, and saves
+// logging every tick at full resolution first.
+TelemetryRecorder::TelemetryRecorder(const string& filename, const vector<Hospital*>& hospitals, int maxRows,
+                                     int minTicks)
+    : filename(filename), hospitalCount(hospitals.size()), maxRows(max(2, maxRows + (maxRows & 1))) {
+    firstTime = 0;
+    stride = 1;
+    while ((int64_t)stride * this->maxRows < minTicks) {
+        stride *= 2;
+    }
+    rows = 0;
+    ticksInRow = 0;
+    initial.resize((size_t)hospitalCount * TM_COUNT);
+    for (int h = 0; h < hospitalCount; h++) {
+        readCounters(hospitals[h], &initial[(size_t)h * TM_COUNT]);
+    }
+    current = initial;
+    latest.assign(initial.size(), -1);
+    encodedSize = 0;
+}
+
+int32_t TelemetryRecorder::fold(int metric, int32_t a, int32_t b) {
+    if (metric == TM_READY_SC || metric == TM_READY_NC) return min(a, b);
+    return max(a, b);
+}
+
+// A row is written as the number of counters that moved in it, then for each
+// the column, the merged value as a delta from the carried one, and the last
+// value as a delta from that
+void TelemetryRecorder::closeRow(vector<unsigned char>& out, size_t& size) {
+    size_t needed = size + MAX_VARINT_BYTES * (1 + 3 * open.size());
+    if (out.size() < needed) out.resize(max(needed, out.size() * 2));
+    unsigned char* p = putVarint(out.data() + size, open.size());
+    for (const Change& change : open) {
+        p = putVarint(p, change.column);
+        p = putVarint(p, zigzagEncode((int64_t)change.merged - change.carried));
+        p = putVarint(p, zigzagEncode((int64_t)change.last - change.merged));
+        latest[change.column] = -1;
+    }
+    size = p - out.data();
+    open.clear();
+}
+
+// Rows 2k and 2k+1 become row k. A counter with no change in a row held the
+// value carried from before it, so a change in an odd row merges with that.
+void TelemetryRecorder::downsample() {
+    vector<unsigned char> merged;
+    size_t mergedSize = 0;
+    vector<int32_t> carried = initial;
+    const unsigned char* p = encoded.data();
+    for (int row = 0; row < rows; row++) {
+        uint64_t count = getVarint(p);
+        for (uint64_t i = 0; i < count; i++) {
+            int column = getVarint(p);
+            int metric = column % TM_COUNT;
+            int32_t value = carried[column] + (int32_t)zigzagDecode(getVarint(p));
+            int32_t last = value + (int32_t)zigzagDecode(getVarint(p));
+            if (latest[column] >= 0) {
+                Change& change = open[latest[column]];
+                change.merged = fold(metric, change.merged, value);
+                change.last = last;
+            } else {
+                Change change;
+                change.column = column;
+                change.carried = carried[column];
+                change.merged = (row & 1) ? fold(metric, value, carried[column]) : value;
+                change.last = last;
+                latest[column] = open.size();
+                open.push_back(change);
+            }
+            carried[column] = last;
+        }
+        if (row & 1) closeRow(merged, mergedSize);
+    }
+    encoded.swap(merged);
+    encodedSize = mergedSize;
+    rows /= 2;
+    stride *= 2;
+}
+
+// Only the hospitals passed in are read, and only the counters that moved
+// are logged. Every other counter still holds the value it last had.
+void TelemetryRecorder::sample(int time, const vector<Hospital*>& changed) {
+    if (rows == 0 || ticksInRow == stride) {
+        if (rows == 0) firstTime = time;
+        if (rows > 0) closeRow(encoded, encodedSize);
+        if (rows == maxRows) downsample();
+        rows++;
+        ticksInRow = 0;
+    }
+
+    for (const Hospital* hospital : changed) {
+        int32_t sample[TM_COUNT];
+        readCounters(hospital, sample);
+        int base = (hospital->hospitalId - 1) * TM_COUNT;
+        for (int m = 0; m < TM_COUNT; m++) {
+            int column = base + m;
+            if (sample[m] == current[column]) continue;
+            if (latest[column] < 0) {
+                Change change;
+                change.column = column;
+                change.carried = current[column];
+                change.merged = (ticksInRow == 0) ? sample[m] : current[column];
+                latest[column] = open.size();
+                open.push_back(change);
+            }
+            Change& change = open[latest[column]];
+            change.merged = fold(m, change.merged, sample[m]);
+            change.last = sample[m];
+            current[column] = sample[m];
+        }
+    }
+    ticksInRow++;
+}
+
+bool TelemetryRecorder::close() {
+    ofstream file(filename, ios::binary | ios::trunc);
+    if (!file.is_open()) return false;
+    if (rows > 0) closeRow(encoded, encodedSize);
+
+    vector<unsigned char> header;
+    putFixed32(header, TELEMETRY_MAGIC);
+    putVarint(header, TELEMETRY_VERSION);
+    putVarint(header, hospitalCount);
+    putVarint(header, TM_COUNT);
+    putVarint(header, zigzagEncode(firstTime));
+    putVarint(header, stride);
+    putVarint(header, rows);
+    putVarint(header, ticksInRow);
+    for (int32_t value : initial) {
+        putVarint(header, zigzagEncode(value));
+    }
+
+    file.write((const char*)header.data(), header.size());
+    file.write((const char*)encoded.data(), encodedSize);
+    return (bool)file;
+}
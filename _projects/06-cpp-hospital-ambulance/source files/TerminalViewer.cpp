@@ -0,0 +1,250 @@
+#include "TerminalViewer.h"
+#include "Hospital.h"
+#include <iostream>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cctype>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+static termios savedTerminal;
+
+static void writeAll(const string& text) {
+    size_t written = 0;
+    while (written < text.size()) {
+        ssize_t n = write(STDOUT_FILENO, text.data() + written, text.size() - written);
+        if (n <= 0) return;
+        written += n;
+    }
+}
+
+TerminalViewer::TerminalViewer(int fps, int ticksPerFrame)
+    : fps(max(1, min(fps, 1000))), ticksPerFrame(max(1, min(ticksPerFrame, VIEWER_MAX_TICKS_PER_FRAME))) {
+    latest.time = shown.time = 0;
+    latest.finished = shown.finished = false;
+    fresh = false;
+    allowedTime = 1;
+    paused = false;
+    detached = false;
+    jumping = false;
+    rawTerminal = false;
+    inputOpen = false;
+}
+
+TerminalViewer::~TerminalViewer() {
+    {
+        lock_guard<mutex> guard(lock);
+        detached = true;
+    }
+    advance.notify_all();
+    if (!worker.joinable()) return;
+    worker.join();
+    if (rawTerminal) tcsetattr(STDIN_FILENO, TCSANOW, &savedTerminal);
+    writeAll("\033[" + to_string(screen.size() + 1) + ";1H\033[?25h");
+}
+
+void TerminalViewer::start() {
+    if (isatty(STDIN_FILENO) && tcgetattr(STDIN_FILENO, &savedTerminal) == 0) {
+        termios raw = savedTerminal;
+        raw.c_lflag &= ~(ICANON | ECHO);
+        raw.c_cc[VMIN] = 1;
+        raw.c_cc[VTIME] = 0;
+        rawTerminal = tcsetattr(STDIN_FILENO, TCSANOW, &raw) == 0;
+    }
+    inputOpen = true;
+
+    cout.flush();
+    writeAll("\033[2J\033[?25l");
+    worker = thread(&TerminalViewer::run, this);
+}
+
+void TerminalViewer::capture(ViewerFrame& frame, int time, const vector<Hospital*>& hospitals) {
+    frame.time = time;
+    frame.hospitals.resize(hospitals.size());
+    for (size_t h = 0; h < hospitals.size(); h++) {
+        const Hospital* hospital = hospitals[h];
+        HospitalView& view = frame.hospitals[h];
+        view.epQueue = hospital->epQueue.size();
+        view.spQueue = hospital->spQueue.size();
+        view.npQueue = hospital->npQueue.size();
+        view.readySC = hospital->readyCars[SC];
+        view.readyNC = hospital->readyCars[NC];
+        view.busy = hospital->busyCars;
+        view.epNotServed = hospital->epNotServed;
+    }
+}
+
+void TerminalViewer::tickDone(int time, const vector<Hospital*>& hospitals) {
+    unique_lock<mutex> guard(lock);
+    if (detached || time < allowedTime) return;
+
+    capture(latest, time, hospitals);
+    fresh = true;
+    advance.wait(guard, [&] { return detached || time < allowedTime; });
+}
+
+void TerminalViewer::finish(int time, const vector<Hospital*>& hospitals) {
+    lock_guard<mutex> guard(lock);
+    if (detached) return;
+    capture(latest, time, hospitals);
+    latest.finished = true;
+    fresh = true;
+}
+
+void TerminalViewer::run() {
+    chrono::milliseconds frameTime(1000 / fps);
+    chrono::steady_clock::time_point nextFrame = chrono::steady_clock::now();
+
+    while (true) {
+        nextFrame += frameTime;
+        while (true) {
+            chrono::steady_clock::time_point now = chrono::steady_clock::now();
+            int wait = (nextFrame > now) ? chrono::duration_cast<chrono::milliseconds>(nextFrame - now).count() : 0;
+            if (!inputOpen) {
+                this_thread::sleep_for(chrono::milliseconds(wait));
+                break;
+            }
+
+            pollfd input = {STDIN_FILENO, POLLIN, 0};
+            if (poll(&input, 1, wait) <= 0) break;
+            char keys[64];
+            ssize_t n = read(STDIN_FILENO, keys, sizeof(keys));
+            if (n <= 0) {
+                inputOpen = false;
+                continue;
+            }
+            for (ssize_t i = 0; i < n; i++) {
+                handleKey(keys[i]);
+            }
+        }
+
+        bool done;
+        {
+            lock_guard<mutex> guard(lock);
+            if (fresh) {
+                shown.time = latest.time;
+                shown.finished = latest.finished;
+                shown.hospitals.swap(latest.hospitals);
+                fresh = false;
+            }
+            if (!paused && shown.time >= allowedTime) {
+                allowedTime = shown.time + ticksPerFrame;
+                advance.notify_all();
+            }
+            done = shown.finished || detached;
+        }
+        if (nextFrame < chrono::steady_clock::now()) nextFrame = chrono::steady_clock::now();
+
+        render();
+        if (done) return;
+    }
+}
+
+void TerminalViewer::handleKey(char key) {
+    if (jumping) {
+        if (isdigit((unsigned char)key)) {
+            jumpInput += key;
+        } else if ((key == 127 || key == '\b') && !jumpInput.empty()) {
+            jumpInput.erase(jumpInput.size() - 1);
+        } else if (key == 27) {
+            jumping = false;
+        } else if (key == '\n' || key == '\r') {
+            jumping = false;
+            if (jumpInput.empty()) return;
+            int target = atoi(jumpInput.c_str());
+            lock_guard<mutex> guard(lock);
+            if (target <= shown.time) {
+                message = "Tick " + jumpInput + " has already been simulated";
+                return;
+            }
+            allowedTime = target;
+            paused = true;
+            advance.notify_all();
+        }
+        return;
+    }
+
+    message.clear();
+    lock_guard<mutex> guard(lock);
+    switch (key) {
+        case ' ':
+        case 'p':
+            paused = !paused;
+            break;
+        case 's':
+            paused = true;
+            if (shown.time >= allowedTime) allowedTime = shown.time + 1;
+            advance.notify_all();
+            break;
+        case '+':
+        case 'f':
+            ticksPerFrame = min(ticksPerFrame * 2, VIEWER_MAX_TICKS_PER_FRAME);
+            break;
+        case '-':
+        case 'b':
+            ticksPerFrame = max(ticksPerFrame / 2, 1);
+            break;
+        case 'g':
+            jumping = true;
+            jumpInput.clear();
+            break;
+        case 'q':
+            detached = true;
+            advance.notify_all();
+            break;
+    }
+}
+
+vector<string> TerminalViewer::layout() const {
+    vector<string> lines;
+    char line[160];
+
+    const char* state = shown.finished ? "finished" : (paused ? "paused" : "running");
+    snprintf(line, sizeof(line), "Tick %-8d %-9s %d tick%s/frame at %d fps", shown.time, state, ticksPerFrame,
+             ticksPerFrame == 1 ? "" : "s", fps);
+    lines.push_back(line);
+
+    int queued[3] = {0, 0, 0}, ready[2] = {0, 0}, busy = 0;
+    for (const HospitalView& view : shown.hospitals) {
+        queued[0] += view.epQueue;
+        queued[1] += view.spQueue;
+        queued[2] += view.npQueue;
+        ready[SC] += view.readySC;
+        ready[NC] += view.readyNC;
+        busy += view.busy;
+    }
+    snprintf(line, sizeof(line), "Waiting EP %d, SP %d, NP %d   Ready SC %d, NC %d   Out %d", queued[0], queued[1],
+             queued[2], ready[SC], ready[NC], busy);
+    lines.push_back(line);
+    lines.push_back("");
+
+    lines.push_back("Hospital      EP      SP      NP  SC ready  NC ready     Out  EP sent");
+    for (size_t h = 0; h < shown.hospitals.size(); h++) {
+        const HospitalView& view = shown.hospitals[h];
+        snprintf(line, sizeof(line), "%8d %7d %7d %7d %9d %9d %7d %8d", (int)h + 1, view.epQueue, view.spQueue,
+                 view.npQueue, view.readySC, view.readyNC, view.busy, view.epNotServed);
+        lines.push_back(line);
+    }
+    lines.push_back("");
+
+    if (jumping) lines.push_back("Jump to tick: " + jumpInput);
+    else if (!message.empty()) lines.push_back(message);
+    else lines.push_back("space pause/resume   s step   +/- speed   g jump to tick   q stop viewing");
+    return lines;
+}
+
+void TerminalViewer::render() {
+    vector<string> lines = layout();
+
+    string out;
+    for (size_t i = 0; i < max(lines.size(), screen.size()); i++) {
+        if (i < lines.size() && i < screen.size() && lines[i] == screen[i]) continue;
+        out += "\033[" + to_string(i + 1) + ";1H";
+        if (i < lines.size()) out += lines[i];
+        out += "\033[K";
+    }
+    screen.swap(lines);
+    writeAll(out);
+}
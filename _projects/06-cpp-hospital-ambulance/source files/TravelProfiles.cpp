@@ -0,0 +1,145 @@
+#include "TravelProfiles.h"
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <string>
+
+TravelProfiles::TravelProfiles() {
+    dayLength = 1;
+    hospitalCount = zoneCount = 0;
+    inputProfiles = 0;
+    profileStart.assign(1, 0);
+}
+
+bool TravelProfiles::read(istream& in, int hospitals) {
+    string header;
+    in >> header >> dayLength;
+    if (!in || header != HEADER || dayLength < 1 || dayLength > MAX_DAY_LENGTH) return false;
+    hospitalCount = hospitals;
+
+    in >> inputProfiles;
+    if (!in || inputProfiles < 1) return false;
+
+    // Counts from the header only bound loops; lists grow as values are read,
+    // so a short file fails instead of allocating what its header claims
+    map<vector<uint32_t>, int> unique;
+    vector<int> remap;
+    breakpoints.clear();
+    profileStart.assign(1, 0);
+    for (int p = 0; p < inputProfiles; p++) {
+        int count;
+        in >> count;
+        if (!in || count < 1 || count > dayLength) return false;
+
+        vector<uint32_t> packed(count);
+        int previous = -1;
+        bool constant = true;
+        for (int i = 0; i < count; i++) {
+            int time;
+            double multiplier;
+            in >> time >> multiplier;
+            if (!in || time <= previous || time >= dayLength || multiplier <= 0) return false;
+            previous = time;
+
+            long factor = min(65535L, max(1L, lround(multiplier * FACTOR_ONE)));
+            packed[i] = ((uint32_t)time << 16) | (uint32_t)factor;
+            if ((packed[i] & 0xffff) != (packed[0] & 0xffff)) constant = false;
+        }
+        if (constant) packed.assign(1, packed[0] & 0xffff);
+
+        map<vector<uint32_t>, int>::iterator found = unique.find(packed);
+        if (found != unique.end()) {
+            remap.push_back(found->second);
+            continue;
+        }
+        remap.push_back(unique[packed] = profileStart.size() - 1);
+        for (uint32_t value : packed) {
+            Breakpoint breakpoint = {(uint16_t)(value >> 16), (uint16_t)(value & 0xffff)};
+            breakpoints.push_back(breakpoint);
+        }
+        profileStart.push_back(breakpoints.size());
+    }
+
+    in >> zoneCount;
+    if (!in || zoneCount < 1 || zoneCount > 65535) return false;
+    zoneOf.assign(hospitals, 0);
+    for (int h = 0; h < hospitals; h++) {
+        int zone;
+        in >> zone;
+        if (!in || zone < 1 || zone > zoneCount) return false;
+        zoneOf[h] = zone - 1;
+    }
+
+    size_t zonePairs = (size_t)zoneCount * zoneCount;
+    zoneProfile.clear();
+    for (size_t i = 0; i < zonePairs; i++) {
+        int profile;
+        in >> profile;
+        if (!in || profile < 1 || profile > inputProfiles) return false;
+        zoneProfile.push_back(remap[profile - 1]);
+    }
+
+    int overrides;
+    in >> overrides;
+    if (!in) overrides = 0;
+    vector<pair<uint32_t, uint16_t>> pairs;
+    for (int i = 0; i < overrides; i++) {
+        int from, to, profile;
+        in >> from >> to >> profile;
+        if (!in || from < 1 || from > hospitals || to < 1 || to > hospitals ||
+            profile < 1 || profile > inputProfiles) return false;
+        pairs.push_back(make_pair((uint32_t)((from - 1) * hospitals + (to - 1)), (uint16_t)remap[profile - 1]));
+    }
+    stable_sort(pairs.begin(), pairs.end(),
+                [](const pair<uint32_t, uint16_t>& a, const pair<uint32_t, uint16_t>& b) { return a.first < b.first; });
+
+    pairKeys.clear();
+    pairProfiles.clear();
+    for (size_t i = 0; i < pairs.size(); i++) {
+        if (i + 1 < pairs.size() && pairs[i + 1].first == pairs[i].first) continue;
+        int from = pairs[i].first / hospitals, to = pairs[i].first % hospitals;
+        if (pairs[i].second == zoneProfile[(size_t)zoneOf[from] * zoneCount + zoneOf[to]]) continue;
+        pairKeys.push_back(pairs[i].first);
+        pairProfiles.push_back(pairs[i].second);
+    }
+
+    return getProfileCount() <= 65535;
+}
+
+int TravelProfiles::profileFor(int fromHospital, int toHospital) const {
+    int from = fromHospital - 1, to = toHospital - 1;
+    if (!pairKeys.empty()) {
+        uint32_t key = from * hospitalCount + to;
+        vector<uint32_t>::const_iterator found = lower_bound(pairKeys.begin(), pairKeys.end(), key);
+        if (found != pairKeys.end() && *found == key) return pairProfiles[found - pairKeys.begin()];
+    }
+    return zoneProfile[(size_t)zoneOf[from] * zoneCount + zoneOf[to]];
+}
+
+int TravelProfiles::factorAt(int profile, int time) const {
+    const Breakpoint* first = &breakpoints[profileStart[profile]];
+    const Breakpoint* last = first + (profileStart[profile + 1] - profileStart[profile]);
+    if (last - first == 1) return first->factor;
+
+    int t = ((time % dayLength) + dayLength) % dayLength;
+    const Breakpoint* next = upper_bound(first, last, t,
+                                         [](int value, const Breakpoint& b) { return value < b.time; });
+    const Breakpoint* previous = (next == first) ? last - 1 : next - 1;
+    int previousTime = (next == first) ? previous->time - dayLength : previous->time;
+    if (next == last) next = first;
+    int nextTime = (next->time <= previousTime) ? next->time + dayLength : next->time;
+
+    return previous->factor + (int)((int64_t)(next->factor - previous->factor) * (t - previousTime) /
+                                    (nextTime - previousTime));
+}
+
+int TravelProfiles::scale(int fromHospital, int toHospital, int distance, int departTime) const {
+    int factor = factorAt(profileFor(fromHospital, toHospital), departTime);
+    return (int)(((int64_t)distance * factor + FACTOR_ONE - 1) / FACTOR_ONE);
+}
+
+size_t TravelProfiles::memoryBytes() const {
+    return breakpoints.size() * sizeof(Breakpoint) + profileStart.size() * sizeof(uint32_t) +
+           zoneOf.size() * sizeof(uint16_t) + zoneProfile.size() * sizeof(uint16_t) +
+           pairKeys.size() * sizeof(uint32_t) + pairProfiles.size() * sizeof(uint16_t);
+}
@@ -0,0 +1,203 @@
+#include "WhatIfEngine.h"
+#include <sstream>
+#include <fstream>
+#include <chrono>
+#include <climits>
+#include <algorithm>
+
+WhatIfEngine::WhatIfEngine(int interval) : interval(max(1, interval)) {
+    baselineSeconds = 0;
+    baselineEndTime = 0;
+    snapshotBytes = 0;
+    sharedChunks = totalChunks = 0;
+}
+
+bool WhatIfEngine::load(const string& filename) {
+    scenarioFile = filename;
+    return system.loadFromFile(filename);
+}
+
+size_t WhatIfEngine::ownedBytes(const SimulationSnapshot& snapshot) const {
+    size_t bytes = snapshot.cars.size() * sizeof(CarState) + snapshot.hospitals.size() * sizeof(HospitalState);
+    for (const HospitalState& hospital : snapshot.hospitals) {
+        bytes += (hospital.epQueue.size() + hospital.spQueue.size() + hospital.npQueue.size()) * sizeof(Patient*);
+    }
+    size_t ownChunks = snapshot.patientChunks.size() - snapshot.sharedChunks;
+    return bytes + ownChunks * SimulationSnapshot::CHUNK_SIZE * sizeof(PatientState);
+}
+
+void WhatIfEngine::runBaseline() {
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    FixedTypeDispatch dispatch;
+    NoForwarding forward;
+
+    bool running = true;
+    while (running) {
+        if ((system.getCurrentTime() - 1) % interval == 0) {
+            snapshots.push_back(SimulationSnapshot());
+            const SimulationSnapshot* previous = (snapshots.size() > 1) ? &snapshots[snapshots.size() - 2] : nullptr;
+            system.saveSnapshot(snapshots.back(), previous);
+            snapshotBytes += ownedBytes(snapshots.back());
+            sharedChunks += snapshots.back().sharedChunks;
+            totalChunks += snapshots.back().patientChunks.size();
+        }
+        running = system.step(dispatch, forward);
+    }
+    system.saveSnapshot(finalState, snapshots.empty() ? nullptr : &snapshots.back());
+    baselineEndTime = system.getEndTime();
+
+    stringstream output;
+    system.writeResults(output);
+    baselineOutput = output.str();
+    baselineSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+static void applyCarEdits(AmbulanceSystem& target, const vector<ScenarioEdit>& edits, int time) {
+    for (const ScenarioEdit& edit : edits) {
+        if (edit.type != CARS_OFFLINE) continue;
+        Hospital* hospital = target.getHospital(edit.hospitalId);
+        if (time == edit.fromTime) hospital->takeCarsOffline(edit.carType, edit.count);
+        if (time == edit.toTime) hospital->bringCarsOnline(edit.carType, edit.count);
+    }
+}
+
+const SimulationSnapshot& WhatIfEngine::snapshotBefore(int time) const {
+    size_t index = (time <= 1) ? 0 : min(snapshots.size() - 1, (size_t)((time - 1) / interval));
+    return snapshots[index];
+}
+
+const SimulationSnapshot* WhatIfEngine::snapshotAt(int time) const {
+    if (time < 1 || (time - 1) % interval != 0) return nullptr;
+    size_t index = (time - 1) / interval;
+    return (index < snapshots.size()) ? &snapshots[index] : nullptr;
+}
+
+bool WhatIfEngine::query(const vector<ScenarioEdit>& edits, WhatIfResult& result, bool incremental) {
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+    vector<RequestCancellation> removed, added;
+    int editStart = INT_MAX, quietAfter = 0;
+    bool valid = true;
+    for (const ScenarioEdit& edit : edits) {
+        if (edit.type == REMOVE_CANCELLATION) {
+            RequestCancellation cancellation;
+            if (!system.removeCancellation(edit.patientId, -1, cancellation)) {
+                valid = false;
+                break;
+            }
+            removed.push_back(cancellation);
+            editStart = min(editStart, cancellation.cancellationTime);
+            quietAfter = max(quietAfter, cancellation.cancellationTime);
+        } else if (edit.type == ADD_CANCELLATION) {
+            RequestCancellation cancellation = {edit.fromTime, edit.patientId};
+            system.addCancellation(cancellation);
+            added.push_back(cancellation);
+            editStart = min(editStart, edit.fromTime);
+            quietAfter = max(quietAfter, edit.fromTime);
+        } else {
+            if (edit.hospitalId < 1 || edit.hospitalId > system.getHospitalCount()) {
+                valid = false;
+                break;
+            }
+            editStart = min(editStart, edit.fromTime);
+            quietAfter = max(quietAfter, edit.toTime);
+        }
+    }
+
+    if (valid) {
+        // The baseline's final state is only valid to splice in when the
+        // edits leave the end time as it was
+        incremental = incremental && system.getEndTime() == baselineEndTime;
+        const SimulationSnapshot& restart = incremental ? snapshotBefore(editStart) : snapshots[0];
+        system.restoreSnapshot(restart);
+        result.restartTime = restart.time;
+        result.convergedTime = -1;
+        result.ticksSimulated = 0;
+
+        FixedTypeDispatch dispatch;
+        NoForwarding forward;
+        bool running = true;
+        while (running) {
+            int time = system.getCurrentTime();
+            if (incremental && time > quietAfter) {
+                const SimulationSnapshot* baseline = snapshotAt(time);
+                if (baseline && system.matchesSnapshot(*baseline)) {
+                    system.spliceSnapshot(*baseline, finalState);
+                    result.convergedTime = time;
+                    break;
+                }
+            }
+
+            applyCarEdits(system, edits, time);
+            running = system.step(dispatch, forward);
+            result.ticksSimulated++;
+        }
+
+        stringstream output;
+        system.writeResults(output);
+        result.output = output.str();
+    }
+
+    for (const RequestCancellation& cancellation : added) {
+        RequestCancellation undone;
+        system.removeCancellation(cancellation.patientId, cancellation.cancellationTime, undone);
+    }
+    for (const RequestCancellation& cancellation : removed) {
+        system.addCancellation(cancellation);
+    }
+
+    result.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    return valid;
+}
+
+// Load the input again, apply the cancellation edits to the scenario itself
+// and run it from the start, as a fresh run of the edited input would
+bool WhatIfEngine::runFresh(const vector<ScenarioEdit>& edits, WhatIfResult& result) const {
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+    ifstream file(scenarioFile);
+    Scenario scenario;
+    if (!file.is_open() || !scenario.read(file)) return false;
+
+    for (const ScenarioEdit& edit : edits) {
+        if (edit.type == REMOVE_CANCELLATION) {
+            // The earliest cancellation of the patient, as removeCancellation picks
+            int found = -1;
+            for (size_t i = 0; i < scenario.cancellations.size(); i++) {
+                const RequestCancellation& cancellation = scenario.cancellations[i];
+                if (cancellation.patientId != edit.patientId) continue;
+                if (found < 0 || cancellation.cancellationTime < scenario.cancellations[found].cancellationTime) {
+                    found = i;
+                }
+            }
+            if (found < 0) return false;
+            scenario.cancellations.erase(scenario.cancellations.begin() + found);
+        } else if (edit.type == ADD_CANCELLATION) {
+            RequestCancellation cancellation = {edit.fromTime, edit.patientId};
+            scenario.cancellations.push_back(cancellation);
+        } else if (edit.hospitalId < 1 || edit.hospitalId > scenario.hospitalCount()) {
+            return false;
+        }
+    }
+
+    AmbulanceSystem fresh;
+    fresh.loadScenario(scenario);
+    result.restartTime = fresh.getCurrentTime();
+    result.convergedTime = -1;
+    result.ticksSimulated = 0;
+
+    FixedTypeDispatch dispatch;
+    NoForwarding forward;
+    bool running = true;
+    while (running) {
+        applyCarEdits(fresh, edits, fresh.getCurrentTime());
+        running = fresh.step(dispatch, forward);
+        result.ticksSimulated++;
+    }
+
+    stringstream output;
+    fresh.writeResults(output);
+    result.output = output.str();
+    result.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    return true;
+}
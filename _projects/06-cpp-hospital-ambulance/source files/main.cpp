@@ -1,10 +1,734 @@
 #include "AmbulanceSystem.h"
+#include "JournalReplay.h"
+#include "Benchmarks.h"
+#include "FleetOptimizer.h"
+#include "WhatIfEngine.h"
+#include "ShardedSimulation.h"
+#include "DifferentialOracle.h"
+#include "BatchRunner.h"
+#include "TelemetryReader.h"
+#include "ColumnarReader.h"
 #include <iostream>
 #include <string>
+#include <vector>
+#include <cstdlib>
+#include <cstdio>
+#include <chrono>
+#include <fstream>
+#include <thread>
+#include <sstream>
+#include <climits>
+#include <sys/stat.h>
 
 using namespace std;
 
-int main() {
+void printUsage() {
+    cerr << "Usage:" << endl;
+    cerr << "  ambulance_system" << endl;
+    cerr << "  ambulance_system run <input> <output> [--interactive] [--journal <file>] [--dispatch greedy|optimal]" << endl;
+    cerr << "      [--policy fixed|reserve-sc|severity-sp|nearest-car] [--forward none|shortest-queue|nearest]" << endl;
+    cerr << "      [--travel-profiles <file>] [--shards N] [--telemetry <file>] [--telemetry-rows N]" << endl;
+    cerr << "      [--view] [--fps N] [--ticks-per-frame N] [--columnar <file>]" << endl;
+    cerr << "      [--stochastic <seed>] [--travel-spread X] [--service-time A-B]" << endl;
+    cerr << "  ambulance_system results <file> [--where <column> <min> <max>] [--output <file>]" << endl;
+    cerr << "  ambulance_system telemetry <file> [--from <time>] [--to <time>] [--hospital H] [--output <file>]" << endl;
+    cerr << "  ambulance_system replay <journal> [--at <time>] [--events <from> <to>] [--output <file>]" << endl;
+    cerr << "  ambulance_system optimize-fleet <input> [--target ep|sp|np] [--percentile P] [--max-wait W]" << endl;
+    cerr << "      [--sc-cost C] [--nc-cost C] [--threads N] [--output <file>]" << endl;
+    cerr << "  ambulance_system what-if <input> [--interval K] [--verify]" << endl;
+    cerr << "      then one query per line: uncancel <pid>; cancel <pid> <time>;" << endl;
+    cerr << "      offline <hospital> sc|nc <count> <from> [<to>]; ... [> <output>]" << endl;
+    cerr << "  ambulance_system batch <manifest|directory> [--output-dir <dir>] [--summary <file>] [--threads N]" << endl;
+    cerr << "      [--max-memory MB]" << endl;
+    cerr << "  ambulance_system oracle <input> | --random N [--seed S]" << endl;
+    cerr << "      [--engine policy|rewind|reserve-sc|severity-sp] [--interval K] [--max-runs N] [--save <file>]" << endl;
+    cerr << "  ambulance_system bench-dispatch [--hospitals N] [--cars N] [--requests N] [--horizon T] [--seed S]" << endl;
+    cerr << "  ambulance_system bench-policies [--hospitals N] [--cars N] [--requests N] [--horizon T] [--seed S]" << endl;
+    cerr << "  ambulance_system bench-geo [--hospitals N] [--requests N] [--threads N] [--seed S]" << endl;
+    cerr << "  ambulance_system bench-shards [--hospitals N] [--cars N] [--requests N] [--horizon T] [--seed S]" << endl;
+    cerr << "      [--max-shards N] [--forward none|nearest]" << endl;
+}
+
+bool parsePolicy(const string& name, DispatchPolicyType& policy) {
+    if (name == "fixed") policy = FIXED_TYPE_POLICY;
+    else if (name == "reserve-sc") policy = RESERVE_SC_POLICY;
+    else if (name == "severity-sp") policy = SEVERITY_SP_POLICY;
+    else if (name == "nearest-car") policy = NEAREST_CAR_POLICY;
+    else return false;
+    return true;
+}
+
+bool parseForward(const string& name, ForwardPolicyType& policy) {
+    if (name == "none") policy = NO_FORWARD_POLICY;
+    else if (name == "shortest-queue") policy = SHORTEST_QUEUE_FORWARD_POLICY;
+    else if (name == "nearest") policy = NEAREST_HOSPITAL_FORWARD_POLICY;
+    else return false;
+    return true;
+}
+
+int runShardedCommand(const string& inputFile, const string& outputFile, int shards,
+                      DispatchPolicyType dispatchPolicy, ForwardPolicyType forwardPolicy, const string& profileFile,
+                      const StochasticParams* stochastic) {
+    ifstream input(inputFile);
+    Scenario scenario;
+    if (!input.is_open() || !scenario.read(input)) {
+        cerr << "Failed to load input file: " << inputFile << endl;
+        return 1;
+    }
+
+    cout << "Silent Mode, Simulation Starts..." << endl;
+    ShardedSimulation simulation(scenario, shards, dispatchPolicy, forwardPolicy, profileFile);
+    if (stochastic) simulation.enableStochasticTimes(*stochastic);
+    if (!simulation.run()) {
+        return 1;
+    }
+
+    ofstream output(outputFile);
+    if (!output.is_open()) {
+        cerr << "Error creating output file: " << outputFile << endl;
+        return 1;
+    }
+    simulation.writeResults(output);
+    cout << "Simulation ends, Output file created" << endl;
+    cout << simulation.getShardCount() << " shards, " << simulation.getSyncTickCount() << " sync ticks, "
+         << simulation.getForwardsSent() << " cross-shard forwards, " << simulation.getWallSeconds() * 1000.0
+         << " ms" << endl;
+    return 0;
+}
+
+int runCommand(const vector<string>& args) {
+    if (args.size() < 2) {
+        printUsage();
+        return 1;
+    }
+
+    bool interactive = false;
+    string journalFile;
+    string profileFile;
+    string telemetryFile;
+    int telemetryRows = TELEMETRY_DEFAULT_ROWS;
+    bool view = false;
+    int fps = VIEWER_DEFAULT_FPS;
+    int ticksPerFrame = 1;
+    string columnarFile;
+    bool stochastic = false;
+    StochasticParams stochasticParams;
+    int shards = 0;
+    DispatchMode dispatchMode = GREEDY_DISPATCH;
+    DispatchPolicyType dispatchPolicy = FIXED_TYPE_POLICY;
+    ForwardPolicyType forwardPolicy = NO_FORWARD_POLICY;
+    for (size_t i = 2; i < args.size(); i++) {
+        if (args[i] == "--interactive") {
+            interactive = true;
+        } else if (args[i] == "--journal" && i + 1 < args.size()) {
+            journalFile = args[++i];
+        } else if (args[i] == "--travel-profiles" && i + 1 < args.size()) {
+            profileFile = args[++i];
+        } else if (args[i] == "--shards" && i + 1 < args.size()) {
+            shards = atoi(args[++i].c_str());
+        } else if (args[i] == "--telemetry" && i + 1 < args.size()) {
+            telemetryFile = args[++i];
+        } else if (args[i] == "--telemetry-rows" && i + 1 < args.size()) {
+            telemetryRows = atoi(args[++i].c_str());
+        } else if (args[i] == "--view") {
+            view = true;
+        } else if (args[i] == "--fps" && i + 1 < args.size()) {
+            fps = atoi(args[++i].c_str());
+        } else if (args[i] == "--ticks-per-frame" && i + 1 < args.size()) {
+            ticksPerFrame = atoi(args[++i].c_str());
+        } else if (args[i] == "--columnar" && i + 1 < args.size()) {
+            columnarFile = args[++i];
+        } else if (args[i] == "--stochastic" && i + 1 < args.size()) {
+            stochastic = true;
+            stochasticParams.seed = strtoull(args[++i].c_str(), nullptr, 10);
+        } else if (args[i] == "--travel-spread" && i + 1 < args.size()) {
+            stochasticParams.travelSpread = atof(args[++i].c_str());
+        } else if (args[i] == "--service-time" && i + 1 < args.size() &&
+                   sscanf(args[i + 1].c_str(), "%d-%d", &stochasticParams.serviceMin,
+                          &stochasticParams.serviceMax) == 2) {
+            i++;
+        } else if (args[i] == "--dispatch" && i + 1 < args.size() &&
+                   (args[i + 1] == "greedy" || args[i + 1] == "optimal")) {
+            dispatchMode = (args[++i] == "optimal") ? OPTIMAL_DISPATCH : GREEDY_DISPATCH;
+        } else if (args[i] == "--policy" && i + 1 < args.size() && parsePolicy(args[i + 1], dispatchPolicy)) {
+            i++;
+        } else if (args[i] == "--forward" && i + 1 < args.size() && parseForward(args[i + 1], forwardPolicy)) {
+            i++;
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    if (stochastic && !stochasticParams.valid()) {
+        cerr << "--travel-spread must be in [0, 1) and --service-time A-B needs 0 <= A <= B" << endl;
+        return 1;
+    }
+
+    if (shards > 0) {
+        if (interactive || view || !journalFile.empty() || !telemetryFile.empty() || !columnarFile.empty() ||
+            !ShardedSimulation::supports(dispatchMode, dispatchPolicy, forwardPolicy)) {
+            cerr << "--shards needs greedy dispatch, a local --policy, --forward none or nearest,"
+                 << " and no --interactive, --view, --journal, --telemetry or --columnar" << endl;
+            return 1;
+        }
+        return runShardedCommand(args[0], args[1], shards, dispatchPolicy, forwardPolicy, profileFile,
+                                 stochastic ? &stochasticParams : nullptr);
+    }
+
+    AmbulanceSystem system;
+    if (!system.loadFromFile(args[0])) {
+        cerr << "Failed to load input file: " << args[0] << endl;
+        return 1;
+    }
+    if (!journalFile.empty() && !system.enableJournal(journalFile)) {
+        return 1;
+    }
+    if (!profileFile.empty() && !system.loadTravelProfiles(profileFile)) {
+        return 1;
+    }
+    if (stochastic) {
+        system.enableStochasticTimes(stochasticParams);
+    }
+    if (!telemetryFile.empty() && !system.enableTelemetry(telemetryFile, telemetryRows)) {
+        return 1;
+    }
+    if (view) {
+        if (interactive) {
+            cerr << "--view and --interactive can't be used together" << endl;
+            return 1;
+        }
+        system.enableViewer(fps, ticksPerFrame);
+    }
+    system.setDispatchMode(dispatchMode);
+    system.setDispatchPolicy(dispatchPolicy);
+    system.setForwardPolicy(forwardPolicy);
+
+    system.runSimulation(interactive);
+    system.saveOutputFile(args[1]);
+    if (!columnarFile.empty() && !system.saveColumnarFile(columnarFile)) {
+        return 1;
+    }
+    return 0;
+}
+
+int replayCommand(const vector<string>& args) {
+    if (args.empty()) {
+        printUsage();
+        return 1;
+    }
+
+    int atTime = -1;
+    int fromTime = -1, toTime = -1;
+    string outputFile;
+    for (size_t i = 1; i < args.size(); i++) {
+        if (args[i] == "--at" && i + 1 < args.size()) {
+            atTime = atoi(args[++i].c_str());
+        } else if (args[i] == "--events" && i + 2 < args.size()) {
+            fromTime = atoi(args[++i].c_str());
+            toTime = atoi(args[++i].c_str());
+        } else if (args[i] == "--output" && i + 1 < args.size()) {
+            outputFile = args[++i];
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    JournalReplay replay;
+    if (!replay.load(args[0])) {
+        return 1;
+    }
+
+    if (fromTime >= 0 && !replay.printEvents(cout, fromTime, toTime)) {
+        return 1;
+    }
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    uint64_t events = (atTime >= 0) ? replay.replayTo(atTime) : replay.replayAll();
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    if (!replay.isValid()) {
+        return 1;
+    }
+
+    replay.printState(cout);
+    cout << "Replayed " << events << " events in " << seconds * 1000.0 << " ms";
+    if (seconds > 0) {
+        cout << " (" << (events / seconds / 1e6) << " M events/s)";
+    }
+    cout << endl;
+
+    if (!outputFile.empty()) {
+        if (atTime >= 0) {
+            replay.replayAll();
+        }
+        if (!replay.isValid() || !replay.writeOutputFile(outputFile)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int telemetryCommand(const vector<string>& args) {
+    if (args.empty()) {
+        printUsage();
+        return 1;
+    }
+
+    int fromTime = INT_MIN, toTime = INT_MAX, hospitalId = 0;
+    string outputFile;
+    for (size_t i = 1; i < args.size(); i++) {
+        if (args[i] == "--from" && i + 1 < args.size()) {
+            fromTime = atoi(args[++i].c_str());
+        } else if (args[i] == "--to" && i + 1 < args.size()) {
+            toTime = atoi(args[++i].c_str());
+        } else if (args[i] == "--hospital" && i + 1 < args.size()) {
+            hospitalId = atoi(args[++i].c_str());
+        } else if (args[i] == "--output" && i + 1 < args.size()) {
+            outputFile = args[++i];
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    TelemetryReader reader;
+    if (!reader.load(args[0])) {
+        cerr << "Failed to load telemetry file: " << args[0] << endl;
+        return 1;
+    }
+    if (hospitalId < 0 || hospitalId > reader.getHospitalCount()) {
+        cerr << "No such hospital: " << hospitalId << endl;
+        return 1;
+    }
+
+    if (outputFile.empty()) {
+        reader.exportCsv(cout, fromTime, toTime, hospitalId);
+        return 0;
+    }
+    ofstream output(outputFile);
+    if (!output.is_open()) {
+        cerr << "Error creating output file: " << outputFile << endl;
+        return 1;
+    }
+    reader.exportCsv(output, fromTime, toTime, hospitalId);
+    return 0;
+}
+
+int resultsCommand(const vector<string>& args) {
+    if (args.empty()) {
+        printUsage();
+        return 1;
+    }
+
+    string whereName;
+    long long from = 0, to = 0;
+    string outputFile;
+    for (size_t i = 1; i < args.size(); i++) {
+        if (args[i] == "--where" && i + 3 < args.size()) {
+            whereName = args[++i];
+            from = atoll(args[++i].c_str());
+            to = atoll(args[++i].c_str());
+        } else if (args[i] == "--output" && i + 1 < args.size()) {
+            outputFile = args[++i];
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    ColumnarReader reader;
+    if (!reader.open(args[0])) {
+        cerr << "Failed to load columnar file: " << args[0] << endl;
+        return 1;
+    }
+    int whereColumn = -1;
+    if (!whereName.empty()) {
+        whereColumn = reader.findColumn(whereName);
+        if (whereColumn < 0) {
+            cerr << "No such column: " << whereName << endl;
+            return 1;
+        }
+    }
+
+    int blocksRead = 0;
+    uint64_t rows;
+    if (outputFile.empty()) {
+        rows = reader.exportCsv(cout, whereColumn, from, to, blocksRead);
+    } else {
+        ofstream output(outputFile);
+        if (!output.is_open()) {
+            cerr << "Error creating output file: " << outputFile << endl;
+            return 1;
+        }
+        rows = reader.exportCsv(output, whereColumn, from, to, blocksRead);
+    }
+    cerr << rows << " of " << reader.getRowCount() << " rows, " << blocksRead << " of " << reader.getBlockCount()
+         << " blocks read" << endl;
+    return 0;
+}
+
+int optimizeFleetCommand(const vector<string>& args) {
+    if (args.empty()) {
+        printUsage();
+        return 1;
+    }
+
+    ServiceTarget target = {EP, 95.0, 8};
+    int scCost = 3, ncCost = 2;
+    int threads = max(1u, thread::hardware_concurrency());
+    string outputFile;
+    for (size_t i = 1; i < args.size(); i++) {
+        if (args[i] == "--target" && i + 1 < args.size()) {
+            string type = args[++i];
+            target.type = (type == "sp") ? SP : (type == "np") ? NP : EP;
+        } else if (args[i] == "--percentile" && i + 1 < args.size()) {
+            target.percentile = atof(args[++i].c_str());
+        } else if (args[i] == "--max-wait" && i + 1 < args.size()) {
+            target.maxWait = atoi(args[++i].c_str());
+        } else if (args[i] == "--sc-cost" && i + 1 < args.size()) {
+            scCost = atoi(args[++i].c_str());
+        } else if (args[i] == "--nc-cost" && i + 1 < args.size()) {
+            ncCost = atoi(args[++i].c_str());
+        } else if (args[i] == "--threads" && i + 1 < args.size()) {
+            threads = atoi(args[++i].c_str());
+        } else if (args[i] == "--output" && i + 1 < args.size()) {
+            outputFile = args[++i];
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    ifstream file(args[0]);
+    Scenario scenario;
+    if (!file.is_open() || !scenario.read(file)) {
+        cerr << "Failed to load input file: " << args[0] << endl;
+        return 1;
+    }
+
+    FleetOptimizer optimizer(scenario, target, scCost, ncCost, threads);
+    vector<int> scCars = scenario.scCars, ncCars = scenario.ncCars;
+    int initialCost = optimizer.cost(scCars, ncCars);
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    FleetEvaluation result;
+    bool found = optimizer.optimize(scCars, ncCars, result);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    cout << "Evaluations: " << optimizer.getEvaluations() << " (" << optimizer.getAbortedRuns()
+         << " aborted early), cache hits: " << optimizer.getCacheHits()
+         << ", reused runs: " << optimizer.getReusedRuns()
+         << ", pruned moves: " << optimizer.getPrunedMoves()
+         << ", rounds: " << optimizer.getRounds() << ", " << seconds << " s" << endl;
+    if (!found) {
+        cerr << "No allocation meets the target, even after scaling the fleet up" << endl;
+        return 1;
+    }
+
+    for (size_t i = 0; i < scCars.size(); i++) {
+        cout << "H" << i + 1 << ": " << scCars[i] << " SC, " << ncCars[i] << " NC" << endl;
+    }
+    cout << "Cost: " << optimizer.cost(scCars, ncCars) << " (input " << initialCost << "), p"
+         << target.percentile << " wait " << result.percentileWait << " <= " << target.maxWait << endl;
+
+    if (!outputFile.empty()) {
+        ofstream out(outputFile);
+        if (!out.is_open()) {
+            cerr << "Error creating output file: " << outputFile << endl;
+            return 1;
+        }
+        scenario.scCars = scCars;
+        scenario.ncCars = ncCars;
+        scenario.write(out);
+    }
+    return 0;
+}
+
+bool parseEdit(const string& text, ScenarioEdit& edit) {
+    stringstream in(text);
+    string verb;
+    in >> verb;
+    edit.patientId = edit.hospitalId = edit.count = 0;
+    edit.carType = NC;
+    edit.fromTime = 0;
+    edit.toTime = INT_MAX;
+
+    if (verb == "uncancel") {
+        edit.type = REMOVE_CANCELLATION;
+        return (bool)(in >> edit.patientId);
+    }
+    if (verb == "cancel") {
+        edit.type = ADD_CANCELLATION;
+        return (bool)(in >> edit.patientId >> edit.fromTime);
+    }
+    if (verb == "offline") {
+        string type;
+        edit.type = CARS_OFFLINE;
+        if (!(in >> edit.hospitalId >> type >> edit.count >> edit.fromTime)) return false;
+        if (type != "sc" && type != "nc") return false;
+        edit.carType = (type == "sc") ? SC : NC;
+        int toTime;
+        if (in >> toTime) edit.toTime = toTime;
+        return true;
+    }
+    return false;
+}
+
+string summaryLines(const string& output) {
+    size_t start = output.find("Patients: ");
+    return (start == string::npos) ? output : output.substr(start);
+}
+
+int whatIfCommand(const vector<string>& args) {
+    if (args.empty()) {
+        printUsage();
+        return 1;
+    }
+
+    int interval = 100;
+    bool verify = false;
+    for (size_t i = 1; i < args.size(); i++) {
+        if (args[i] == "--interval" && i + 1 < args.size()) {
+            interval = atoi(args[++i].c_str());
+        } else if (args[i] == "--verify") {
+            verify = true;
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    WhatIfEngine engine(interval);
+    if (!engine.load(args[0])) {
+        cerr << "Failed to load input file: " << args[0] << endl;
+        return 1;
+    }
+    engine.runBaseline();
+    cout << "Baseline: " << engine.getEndTime() << " ticks in " << engine.getBaselineSeconds() * 1000.0
+         << " ms, " << engine.getSnapshotCount() << " snapshots, "
+         << engine.getSnapshotBytes() / (1024.0 * 1024.0) << " MB ("
+         << engine.getSharedChunkRatio() * 100.0 << "% of patient chunks shared)" << endl;
+    cout << summaryLines(engine.getBaselineOutput());
+
+    string line;
+    while (getline(cin, line)) {
+        string outputFile;
+        size_t redirect = line.find('>');
+        if (redirect != string::npos) {
+            stringstream name(line.substr(redirect + 1));
+            name >> outputFile;
+            line = line.substr(0, redirect);
+        }
+
+        vector<ScenarioEdit> edits;
+        stringstream parts(line);
+        string part;
+        bool valid = true;
+        while (getline(parts, part, ';')) {
+            if (part.find_first_not_of(" \t") == string::npos) continue;
+            ScenarioEdit edit;
+            if (!parseEdit(part, edit)) {
+                cerr << "Invalid edit: " << part << endl;
+                valid = false;
+                break;
+            }
+            edits.push_back(edit);
+        }
+        if (!valid || edits.empty()) continue;
+
+        WhatIfResult result;
+        if (!engine.query(edits, result)) {
+            cerr << "Edit does not apply to this scenario" << endl;
+            continue;
+        }
+
+        cout << "Restarted at t=" << result.restartTime << ", ";
+        if (result.convergedTime >= 0) {
+            cout << "rejoined baseline at t=" << result.convergedTime;
+        } else {
+            cout << "ran to the end";
+        }
+        cout << ", " << result.ticksSimulated << " ticks simulated in " << result.seconds * 1000.0 << " ms" << endl;
+        cout << summaryLines(result.output);
+
+        if (verify) {
+            WhatIfResult fresh;
+            if (!engine.runFresh(edits, fresh)) {
+                cerr << "Failed to reload " << args[0] << " for --verify" << endl;
+            } else {
+                cout << "Fresh run of the edited input: " << fresh.seconds * 1000.0 << " ms, output "
+                     << (fresh.output == result.output ? "identical" : "DIFFERENT") << endl;
+            }
+        }
+
+        if (!outputFile.empty()) {
+            ofstream out(outputFile);
+            out << result.output;
+        }
+    }
+    return 0;
+}
+
+int batchCommand(const vector<string>& args) {
+    if (args.empty()) {
+        printUsage();
+        return 1;
+    }
+
+    string outputDirectory = ".", summaryFile;
+    int threads = max(1u, thread::hardware_concurrency());
+    int64_t memoryLimit = 0;
+    for (size_t i = 1; i < args.size(); i++) {
+        if (args[i] == "--output-dir" && i + 1 < args.size()) {
+            outputDirectory = args[++i];
+        } else if (args[i] == "--summary" && i + 1 < args.size()) {
+            summaryFile = args[++i];
+        } else if (args[i] == "--threads" && i + 1 < args.size()) {
+            threads = atoi(args[++i].c_str());
+        } else if (args[i] == "--max-memory" && i + 1 < args.size()) {
+            memoryLimit = atoll(args[++i].c_str()) << 20;
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+    if (summaryFile.empty()) summaryFile = outputDirectory + "/summary.csv";
+
+    BatchRunner runner(threads, memoryLimit);
+    struct stat info;
+    bool isDirectory = stat(args[0].c_str(), &info) == 0 && S_ISDIR(info.st_mode);
+    bool added = isDirectory ? runner.addDirectory(args[0], outputDirectory)
+                             : runner.addManifest(args[0], outputDirectory);
+    if (!added) {
+        cerr << "Failed to read " << (isDirectory ? "directory: " : "manifest: ") << args[0] << endl;
+        return 1;
+    }
+
+    runner.run();
+    for (const BatchJob& job : runner.getJobs()) {
+        if (!job.ok) cerr << job.inputFile << ": " << job.error << endl;
+    }
+    if (!runner.writeSummary(summaryFile)) {
+        cerr << "Error creating summary file: " << summaryFile << endl;
+        return 1;
+    }
+
+    cout << runner.getJobs().size() << " scenarios (" << runner.getFailedCount() << " failed) in "
+         << runner.getWallSeconds() * 1000.0 << " ms, " << runner.getSteals() << " stolen, "
+         << runner.getAdmissionWaits() << " admission waits, peak estimated memory "
+         << runner.getPeakMemory() / (1024.0 * 1024.0) << " MB" << endl;
+    cout << "Summary written to " << summaryFile << endl;
+    return runner.getFailedCount() == 0 ? 0 : 1;
+}
+
+void printDivergence(const Divergence& divergence) {
+    cout << "Divergence at t=" << divergence.time;
+    if (divergence.hospitalId > 0) cout << ", hospital " << divergence.hospitalId;
+    if (divergence.carId > 0) cout << ", car " << divergence.carId;
+    cout << endl << "  " << divergence.detail << endl;
+}
+
+int oracleCommand(const vector<string>& args) {
+    string inputFile, engineName = "policy", saveFile;
+    int randomCount = 0, interval = DifferentialOracle::REWIND_INTERVAL, maxRuns = 5000;
+    uint32_t seed = 1;
+    for (size_t i = 0; i < args.size(); i++) {
+        if (args[i] == "--random" && i + 1 < args.size()) {
+            randomCount = atoi(args[++i].c_str());
+        } else if (args[i] == "--seed" && i + 1 < args.size()) {
+            seed = strtoul(args[++i].c_str(), nullptr, 10);
+        } else if (args[i] == "--engine" && i + 1 < args.size()) {
+            engineName = args[++i];
+        } else if (args[i] == "--interval" && i + 1 < args.size()) {
+            interval = atoi(args[++i].c_str());
+        } else if (args[i] == "--max-runs" && i + 1 < args.size()) {
+            maxRuns = atoi(args[++i].c_str());
+        } else if (args[i] == "--save" && i + 1 < args.size()) {
+            saveFile = args[++i];
+        } else if (inputFile.empty() && args[i].compare(0, 2, "--") != 0) {
+            inputFile = args[i];
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    OracleEngine* probe = DifferentialOracle::createEngine(engineName, interval);
+    if (!probe || inputFile.empty() == (randomCount <= 0)) {
+        delete probe;
+        printUsage();
+        return 1;
+    }
+    delete probe;
+
+    vector<Scenario> scenarios;
+    if (!inputFile.empty()) {
+        ifstream file(inputFile);
+        scenarios.resize(1);
+        if (!file.is_open() || !scenarios[0].read(file)) {
+            cerr << "Failed to load input file: " << inputFile << endl;
+            return 1;
+        }
+    }
+
+    DifferentialOracle oracle(engineName, interval);
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    int count = inputFile.empty() ? randomCount : 1;
+    for (int i = 0; i < count; i++) {
+        Scenario scenario = inputFile.empty() ? DifferentialOracle::randomScenario(seed + i) : scenarios[0];
+        Divergence divergence;
+        if (!oracle.findDivergence(scenario, divergence)) continue;
+
+        if (inputFile.empty()) cout << "Random scenario with seed " << seed + i << ":" << endl;
+        printDivergence(divergence);
+
+        int runs = oracle.getRuns();
+        Scenario minimal = oracle.shrink(scenario, divergence, maxRuns);
+        int cars = 0;
+        for (int h = 0; h < minimal.hospitalCount(); h++) cars += minimal.scCars[h] + minimal.ncCars[h];
+        cout << "Shrunk in " << oracle.getRuns() - runs << " runs to " << minimal.hospitalCount() << " hospitals, "
+             << cars << " cars, " << minimal.requests.size() << " requests, " << minimal.cancellations.size()
+             << " cancellations:" << endl;
+        printDivergence(divergence);
+
+        if (saveFile.empty()) {
+            minimal.write(cout);
+        } else {
+            ofstream out(saveFile);
+            minimal.write(out);
+            cout << "Minimal scenario written to " << saveFile << endl;
+        }
+        return 1;
+    }
+
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cout << "No divergence between reference and " << engineName << " in " << count << " scenario"
+         << (count == 1 ? "" : "s") << ", " << oracle.getTicksCompared() << " ticks compared in "
+         << seconds * 1000.0 << " ms" << endl;
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1) {
+        string command = argv[1];
+        vector<string> args(argv + 2, argv + argc);
+        if (command == "run") return runCommand(args);
+        if (command == "replay") return replayCommand(args);
+        if (command == "telemetry") return telemetryCommand(args);
+        if (command == "results") return resultsCommand(args);
+        if (command == "optimize-fleet") return optimizeFleetCommand(args);
+        if (command == "what-if") return whatIfCommand(args);
+        if (command == "oracle") return oracleCommand(args);
+        if (command == "batch") return batchCommand(args);
+        if (command == "bench-dispatch") return benchDispatchCommand(args);
+        if (command == "bench-policies") return benchPoliciesCommand(args);
+        if (command == "bench-geo") return benchGeoCommand(args);
+        if (command == "bench-shards") return benchShardsCommand(args);
+        printUsage();
+        return 1;
+    }
+
     cout << "Ambulance Management System" << endl;
     cout << "Select mode:" << endl;
     cout << "1. Interactive Mode" << endl;
@@ -36,4 +760,4 @@ int main() {
     system.saveOutputFile(outputFile);
 
     return 0;
-}
\ No newline at end of file
+}